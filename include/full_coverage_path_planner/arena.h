@@ -0,0 +1,125 @@
+//
+// Copyright [2020] Nobleo Technology"  [legal/copyright]
+//
+#include <cstddef>
+#include <list>
+#include <vector>
+
+#ifndef FULL_COVERAGE_PATH_PLANNER_ARENA_H
+#define FULL_COVERAGE_PATH_PLANNER_ARENA_H
+
+/**
+ * Monotonic memory for the temporary data of a plan. Allocating bumps a pointer in a block, and nothing is freed on
+ * its own: release() makes all of it available again at once, keeping the blocks for the next allocations, and the
+ * blocks are freed when the arena is destroyed. Not thread-safe, every thread plans with its own arena.
+ */
+class Arena
+{
+public:
+  /**
+   * @param block_size bytes of the first block. Every next block is twice as big
+   */
+  explicit Arena(std::size_t block_size = 64 * 1024);
+  ~Arena();
+
+  Arena(Arena const&) = delete;
+  Arena& operator=(Arena const&) = delete;
+
+  void* allocate(std::size_t bytes, std::size_t alignment)
+  {
+    std::size_t offset = (offset_ + alignment - 1) & ~(alignment - 1);
+    if (block_ < blocks_.size() && offset + bytes <= blocks_[block_].size)
+    {
+      offset_ = offset + bytes;
+      return blocks_[block_].data + offset;
+    }
+    return allocateFromNextBlock(bytes, alignment);
+  }
+
+  /**
+   * Make all memory available again. Everything that was allocated must be destroyed before
+   */
+  void release()
+  {
+    block_ = 0;
+    offset_ = 0;
+  }
+
+  /**
+   * Number of blocks taken from the heap
+   */
+  std::size_t blocks() const
+  {
+    return blocks_.size();
+  }
+
+private:
+  typedef struct
+  {
+    char* data;
+    std::size_t size;
+  }
+  block_t;
+
+  void* allocateFromNextBlock(std::size_t bytes, std::size_t alignment);
+
+  std::vector<block_t> blocks_;
+  std::size_t block_size_;
+  std::size_t block_;   // Block that is allocated from
+  std::size_t offset_;  // First free byte in that block
+};
+
+/**
+ * Standard allocator on an Arena, for the containers of the temporary data of a plan. Deallocating does nothing
+ */
+template <class T>
+class ArenaAllocator
+{
+public:
+  typedef T value_type;
+
+  explicit ArenaAllocator(Arena& arena) : arena_(&arena)
+  {
+  }
+
+  template <class U>
+  ArenaAllocator(ArenaAllocator<U> const& other) : arena_(other.arena())  // NOLINT
+  {
+  }
+
+  T* allocate(std::size_t n)
+  {
+    return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T*, std::size_t)
+  {
+  }
+
+  Arena* arena() const
+  {
+    return arena_;
+  }
+
+private:
+  Arena* arena_;
+};
+
+template <class T, class U>
+inline bool operator==(ArenaAllocator<T> const& a, ArenaAllocator<U> const& b)
+{
+  return a.arena() == b.arena();
+}
+
+template <class T, class U>
+inline bool operator!=(ArenaAllocator<T> const& a, ArenaAllocator<U> const& b)
+{
+  return a.arena() != b.arena();
+}
+
+template <class T>
+using ArenaList = std::list<T, ArenaAllocator<T> >;
+
+template <class T>
+using ArenaVector = std::vector<T, ArenaAllocator<T> >;
+#endif  // FULL_COVERAGE_PATH_PLANNER_ARENA_H
@@ -0,0 +1,95 @@
+//
+// Copyright [2020] Nobleo Technology"  [legal/copyright]
+//
+#include <list>
+#include <string>
+#include <vector>
+
+#include <ros/ros.h>
+#include <pluginlib/class_list_macros.h>
+#include <costmap_2d/costmap_2d_ros.h>
+#include <costmap_2d/costmap_2d.h>
+#include <nav_core/base_global_planner.h>
+#include <nav_msgs/Path.h>
+#include <nav_msgs/GetMap.h>
+#include <geometry_msgs/PoseStamped.h>
+
+#ifndef FULL_COVERAGE_PATH_PLANNER_BOUSTROPHEDON_H
+#define FULL_COVERAGE_PATH_PLANNER_BOUSTROPHEDON_H
+
+#include "full_coverage_path_planner/full_coverage_path_planner.h"
+
+namespace full_coverage_path_planner
+{
+/**
+ * Boustrophedon (lawnmower) coverage: the free space is decomposed into cells and each cell is covered
+ * with straight back-and-forth lanes, which needs far fewer turns than a spiral.
+ */
+class Boustrophedon : public nav_core::BaseGlobalPlanner, private full_coverage_path_planner::FullCoveragePathPlanner
+{
+public:
+  /**
+   * Perform boustrophedon coverage path planning
+   * @param grid 2D grid of bools. true == occupied/blocked/obstacle
+   * @param init start position
+   * @param multiple_pass_counter
+   * @param visited_counter
+   * @param unreachable_counter number of free nodes that cannot be reached from init
+   * @return
+   */
+  static std::list<Point_t> boustrophedon(std::vector<std::vector<bool> > const &grid,
+                                          Point_t &init,
+                                          int &multiple_pass_counter,
+                                          int &visited_counter,
+                                          int &unreachable_counter);
+
+  /**
+   * Perform boustrophedon coverage path planning on view.
+   * The free space reachable from init is split by a boustrophedon cell decomposition along x:
+   * a cell ends where the free intervals of two neighboring columns do not continue one-to-one.
+   * Each cell is then swept along x or along y, whichever needs the fewest lanes and so the fewest turns.
+   * The cells are visited nearest first, with a shortest path between them.
+   * View is any type of the GridView concept in grid_view.h, instantiated for the same adapters as spiral_stc.
+   * Only its obstacles are used.
+   * @param view map
+   * @param init start position
+   * @param multiple_pass_counter
+   * @param visited_counter
+   * @param unreachable_counter number of free nodes that cannot be reached from init
+   * @return
+   */
+  template <class View>
+  static std::list<Point_t> boustrophedon(View const &view,
+                                          Point_t &init,
+                                          int &multiple_pass_counter,
+                                          int &visited_counter,
+                                          int &unreachable_counter);
+
+  /**
+   * @brief  Initialization without nav_core, for example in a nodelet
+   * @param  nh node handle for the map service
+   * @param  private_named_nh node handle for the parameters and the published plans
+   */
+  void initialize(ros::NodeHandle& nh, ros::NodeHandle& private_named_nh);
+
+private:
+  /**
+   * @brief Given a goal pose in the world, compute a plan
+   * @param start The start pose
+   * @param goal The goal pose
+   * @param plan The plan... filled by the planner
+   * @return True if a valid plan was found, false otherwise
+   */
+  bool makePlan(const geometry_msgs::PoseStamped &start, const geometry_msgs::PoseStamped &goal,
+                std::vector<geometry_msgs::PoseStamped> &plan);
+
+  /**
+   * @brief  Initialization function for the FullCoveragePathPlanner object
+   * @param  name The name of this planner
+   * @param  costmap A pointer to the ROS wrapper of the costmap to use for planning
+   */
+  void initialize(std::string name, costmap_2d::Costmap2DROS* costmap_ros);
+};
+
+}  // namespace full_coverage_path_planner
+#endif  // FULL_COVERAGE_PATH_PLANNER_BOUSTROPHEDON_H
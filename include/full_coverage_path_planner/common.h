@@ -3,6 +3,7 @@
 //
 // Created by nobleo on 6-9-18.
 //
+#include <stdint.h>
 #include <climits>
 #include <fstream>
 #include <list>
@@ -11,6 +12,9 @@
 #ifndef FULL_COVERAGE_PATH_PLANNER_COMMON_H
 #define FULL_COVERAGE_PATH_PLANNER_COMMON_H
 
+#include "full_coverage_path_planner/arena.h"
+#include "full_coverage_path_planner/grid_view.h"
+
 typedef struct
 {
   int x, y;
@@ -43,6 +47,39 @@ inline std::ostream &operator << (std::ostream &os, gridNode_t &g)
   return os << "gridNode_t(" << g.cost << ", " << g.he << ", " << g.pos  << ")";
 }
 
+/**
+ * Position with coordinates of type Coord, for the nodes of a search. A* uses int32_t: uint16_t coordinates were not
+ * measurably faster
+ */
+template <class Coord>
+struct PackedPoint
+{
+  Coord x, y;
+};
+
+template <class Coord>
+inline std::ostream &operator << (std::ostream &os, PackedPoint<Coord> const &p)
+{
+  return os << "(" << p.x << ", " << p.y << ")";
+}
+
+/**
+ * Node of a search with a packed position
+ */
+template <class Coord>
+struct PackedNode
+{
+  PackedPoint<Coord> pos;
+  int32_t cost;  // Path cost
+  int32_t he;    // Heuristic cost
+};
+
+template <class Coord>
+inline std::ostream &operator << (std::ostream &os, PackedNode<Coord> const &g)
+{
+  return os << "gridNode_t(" << g.cost << ", " << g.he << ", " << g.pos  << ")";
+}
+
 
 typedef struct
 {
@@ -61,6 +98,18 @@ enum
   eNodeVisited = true
 };
 
+/**
+ * Direction of a step: dx + dy*2 gives a unique number for each of the four possible directions
+ */
+enum
+{
+  eDirNone = 0,
+  eDirRight = 1,
+  eDirUp = 2,
+  eDirLeft = -1,
+  eDirDown = -2,
+};
+
 /**
  * Find the distance from poi to the closest point in goals
  * @param poi Starting point
@@ -74,6 +123,57 @@ int distanceToClosestPoint(Point_t poi, std::list<Point_t> const &goals);
  */
 int distanceSquared(const Point_t &p1, const Point_t &p2);
 
+/**
+ * Count the 90 degree turns along a path of 4-connected steps. Turning around counts as two turns
+ */
+int count_turns(std::list<Point_t> const &path);
+
+/**
+ * Count the nodes of a coverage path like spiral_stc does. A node that is repeated right away is not counted again
+ * @param nCols width of the grid
+ * @param nRows height of the grid
+ * @param visited_counter Output, number of steps onto a node
+ * @param multiple_pass_counter Output, number of steps onto a node that was visited before
+ */
+void count_path_visits(std::list<Point_t> const &path, int nCols, int nRows,
+                       int &visited_counter, int &multiple_pass_counter);
+
+/**
+ * Check whether a point lies inside a polygon, with the even-odd rule
+ * @param polygon vertices of the polygon, in order. The last vertex connects to the first
+ * @return true if point is inside polygon
+ */
+bool point_in_polygon(fPoint_t const &point, std::vector<fPoint_t> const &polygon);
+
+/**
+ * Exact Euclidean distance transform: the squared distance (in cells) from every cell to the closest occupied cell.
+ * The distance within each column is found first, and then each row takes the lower envelope of the parabolas rooted
+ * at those distances (Felzenszwalb and Huttenlocher), so it is O(cells) whatever the distances are.
+ * @param occupied row-major (occupied[y * width + x]), true == occupied
+ * @param width width of the grid
+ * @param height height of the grid
+ * @param d2 Output, row-major squared distances. INT_MAX everywhere if there is no occupied cell
+ */
+void squared_distance_transform(std::vector<bool> const &occupied, int width, int height, std::vector<int> &d2);
+
+/**
+ * Mark the free tiles that were covered before as visited, by resampling a coverage grid to the tiles.
+ * A tile is made up of the coverage cells whose centers lie within it, or if there are none because the coverage cells
+ * are larger than the tiles, of the cell under the center of the tile. Cells beyond the coverage grid are uncovered.
+ * @param grid 2D grid of bools. true == occupied/blocked/obstacle
+ * @param covered coverage grid, true == covered
+ * @param resolution size of a coverage cell, in meters
+ * @param origin corner of the coverage grid, in meters
+ * @param tile_size size of a tile, in meters
+ * @param grid_origin corner of the grid of tiles, in meters
+ * @param min_fraction a tile is covered if at least this fraction of its coverage cells is
+ * @param visited 2D grid of bools, covered tiles are set to eNodeVisited
+ * @return number of tiles that were marked
+ */
+int mark_covered_tiles(std::vector<std::vector<bool> > const &grid, RowMajorGrid const &covered, float resolution,
+                       fPoint_t origin, float tile_size, fPoint_t grid_origin, float min_fraction,
+                       std::vector<std::vector<bool> > &visited);
+
 /**
  * Perform A* shorted path finding from init to one of the points in heuristic_goals
  * @param grid 2D grid of bools. true == occupied/blocked/obstacle
@@ -88,6 +188,66 @@ bool a_star_to_open_space(std::vector<std::vector<bool> > const &grid, gridNode_
                           std::vector<std::vector<bool> > &visited, std::list<Point_t> const &open_space,
                           std::list<gridNode_t> &pathNodes);
 
+/**
+ * Label the 4-connected components of free space in a grid, using a single scanline pass with union-find
+ * @param grid 2D grid of bools. true == occupied/blocked/obstacle
+ * @param labels Output, row-major (labels[iy * nCols + ix]). Component index for free nodes, -1 for obstacles
+ * @return number of connected components of free space
+ */
+int label_connected_components(std::vector<std::vector<bool> > const& grid, std::vector<int> &labels);
+
+/**
+ * Jump Point Search from init to the closest open node, as a faster alternative for a_star_to_open_space.
+ * Because every step has the same cost, only the nodes where a shortest path may have to turn (jump points)
+ * are put on the open list; the straight runs in between are scanned without any bookkeeping.
+ * Uses the canonical ordering for 4-connected grids: vertical runs scan rows on both sides,
+ * horizontal runs stop where a vertical move becomes forced by an obstacle.
+ * @param grid 2D grid of bools. true == occupied/blocked/obstacle
+ * @param init start position
+ * @param cost cost of traversing a free node
+ * @param visited grid 2D grid of bools. true == visited. Any open node is a goal
+ * @param pathNodes nodes that form the path from init to the closest open node
+ * @return whether we resign from finding a path or not. true is we resign and false if we found a path
+ */
+bool jps_to_open_space(std::vector<std::vector<bool> > const &grid, gridNode_t init, int cost,
+                       std::vector<std::vector<bool> > const &visited, std::list<gridNode_t> &pathNodes);
+
+/**
+ * Search from init for the open node that is cheapest to reach in travel time, instead of in the number of steps.
+ * The search state includes the heading, and every 90 degree turn costs turn_cost on top of the steps.
+ * The heuristic is the step cost of the Manhattan distance to the closest point in open_space,
+ * which never overestimates.
+ * @param grid 2D grid of bools. true == occupied/blocked/obstacle
+ * @param init start position
+ * @param heading heading at init: 0 for +x, 1 for +y, 2 for -x, 3 for -y, or -1 if any heading is fine
+ * @param cost cost of traversing a free node
+ * @param turn_cost cost of a 90 degree turn. Turning around costs twice as much
+ * @param visited grid 2D grid of bools. true == visited. Any open node is a goal
+ * @param open_space Open space to find a path towards, including every open node that can be reached.
+ * Only used for the heuristic
+ * @param pathNodes nodes that form the path from init to the open node
+ * @return whether we resign from finding a path or not. true is we resign and false if we found a path
+ */
+bool turn_aware_to_open_space(std::vector<std::vector<bool> > const &grid, gridNode_t init, int heading, int cost,
+                              int turn_cost, std::vector<std::vector<bool> > const &visited,
+                              std::list<Point_t> const &open_space, std::list<gridNode_t> &pathNodes);
+
+/**
+ * Search from init for the open node that is cheapest to reach, when every node has its own traversal cost.
+ * Stepping onto a node costs cost plus the cost of that node in costs. Because the step costs are small integers,
+ * this is Dijkstra's algorithm with a bucket queue (Dial's algorithm): every node is put in and taken out
+ * in constant time, so the search is about as fast as one with a uniform cost.
+ * @param grid 2D grid of bools. true == occupied/blocked/obstacle
+ * @param costs traversal cost of each node
+ * @param init start position
+ * @param cost cost of traversing a free node, on top of its cost in costs
+ * @param visited grid 2D grid of bools. true == visited. Any open node is a goal
+ * @param pathNodes nodes that form the path from init to the open node
+ * @return whether we resign from finding a path or not. true is we resign and false if we found a path
+ */
+bool dial_to_open_space(std::vector<std::vector<bool> > const &grid, CostGrid const &costs, gridNode_t init,
+                        int cost, std::vector<std::vector<bool> > const &visited, std::list<gridNode_t> &pathNodes);
+
 /**
  * Print a grid according to the internal representation
  * @param grid
@@ -115,7 +275,8 @@ void printGrid(std::vector<std::vector<bool> > const& grid,
 /**
  * Print a 2D array of bools to stdout
  */
-void printGrid(std::vector<std::vector<bool> > const& grid);
+template <class Grid>
+void printGrid(Grid const& grid);
 
 /**
  * Convert 2D grid of bools to a list of Point_t
@@ -123,5 +284,149 @@ void printGrid(std::vector<std::vector<bool> > const& grid);
  * @param value_to_search points matching this value will be returned
  * @return a list of points that have the given value_to_search
  */
-std::list<Point_t> map_2_goals(std::vector<std::vector<bool> > const& grid, bool value_to_search);
+template <class Grid>
+std::list<Point_t> map_2_goals(Grid const& grid, bool value_to_search);
+
+/**
+ * Convert 2D grid of bools to a list of Point_t, restricted to a single connected component
+ * @param grid 2D grid representing a map
+ * @param value_to_search points matching this value will be returned
+ * @param labels component labels as computed by label_connected_components
+ * @param component only points labelled with this component will be returned
+ * @return a list of points in component that have the given value_to_search
+ */
+template <class Grid>
+std::list<Point_t> map_2_goals(Grid const& grid, bool value_to_search,
+                               std::vector<int> const& labels, int component);
+
+/*
+ * The functions below take a View, which is any type of the GridView concept in grid_view.h.
+ * The functions above on the legacy nested vectors are thin wrappers around these, through a NestedVectorView.
+ * They are explicitly instantiated in common.cpp for each adapter listed in grid_view.h,
+ * the functions that take a Grid for std::vector<std::vector<bool> > and the storages in grid_storage.h.
+ */
+
+/**
+ * Perform A* shorted path finding from init to the closest open node
+ * @param view map and visited state. Open nodes are the goals
+ * @param init start position
+ * @param cost cost of traversing a free node
+ * @param open_space Open space that A* need to find a path towards. Only used for the heuristic and directing search
+ * @param pathNodes nodes that form the path from init to the closest open node
+ * @return whether we resign from finding a path or not. true is we resign and false if we found a path
+ */
+template <class View>
+bool a_star_to_open_space(View const &view, gridNode_t init, int cost,
+                          std::list<Point_t> const &open_space, std::list<gridNode_t> &pathNodes);
+
+/**
+ * Perform A* shortest path finding from init to the closest open node, appending the path to a caller-owned path
+ * instead of a list of gridNode_t, so no node is allocated on its own
+ * @param path Output, the nodes from init to the closest open node are appended. Left as it is if we resign
+ * @return whether we resign from finding a path or not. true is we resign and false if we found a path
+ */
+template <class View>
+bool a_star_to_open_space(View const &view, gridNode_t init, int cost,
+                          std::list<Point_t> const &open_space, std::vector<Point_t> &path);
+
+/**
+ * a_star_to_open_space with the goals and the nodes of the search in arena, for the searches that are repeated for
+ * every step to open space of a plan. The arena is not released here
+ */
+template <class View>
+bool a_star_to_open_space(View const &view, gridNode_t init, int cost,
+                          ArenaList<Point_t> const &open_space, std::vector<Point_t> &path, Arena &arena);
+
+
+/**
+ * Label the 4-connected components of the nodes of view that are not blocked
+ * @param labels Output, row-major (labels[iy * nCols + ix]). Component index for free nodes, -1 for obstacles
+ * @return number of connected components of free space
+ */
+template <class View>
+int label_connected_components(View const& view, std::vector<int> &labels);
+
+/**
+ * Label the 4-connected component of free space that contains init, with a flood fill from init. Unlike
+ * label_connected_components, only the nodes of that component and the ones around it are read
+ * @param labels Output, row-major (labels[iy * nCols + ix]). 0 for the nodes of the component, -1 for all others
+ * @return number of nodes in the component, 0 if init is blocked
+ */
+template <class View>
+int label_component(View const& view, Point_t init, std::vector<int> &labels);
+
+/**
+ * Decompose the free space of view into regions: the 4-connected components within each square block.
+ * Every region is connected, and no region is larger than a block.
+ * @param block_size side of a block, in nodes
+ * @param labels Output, row-major (labels[iy * nCols + ix]). Region index for free nodes, -1 for obstacles
+ * @return number of regions
+ */
+template <class View>
+int label_block_regions(View const& view, int block_size, std::vector<int> &labels);
+
+/**
+ * Jump Point Search from init to the closest open node of view, see the legacy overload above
+ */
+template <class View>
+bool jps_to_open_space(View const &view, gridNode_t init, int cost, std::list<gridNode_t> &pathNodes);
+
+/**
+ * Turn-aware search from init to the closest open node of view, see the legacy overload above.
+ * open_space can be a list with any allocator
+ */
+template <class View, class Allocator>
+bool turn_aware_to_open_space(View const &view, gridNode_t init, int heading, int cost, int turn_cost,
+                              std::list<Point_t, Allocator> const &open_space, std::list<gridNode_t> &pathNodes);
+
+/**
+ * Search with per-node traversal costs from init to the cheapest open node of view, see the legacy overload above
+ */
+template <class View>
+bool dial_to_open_space(View const &view, CostGrid const &costs, gridNode_t init, int cost,
+                        std::list<gridNode_t> &pathNodes);
+
+/**
+ * Print a view according to the internal representation
+ */
+template <class View>
+void printGrid(View const& view, std::list<Point_t> const& path);
+
+/**
+ * Print a view according to the internal representation
+ */
+template <class View>
+void printGrid(View const& view, std::list<gridNode_t> const& path, gridNode_t start, gridNode_t end);
+
+/**
+ * List the open nodes of view: neither blocked nor visited
+ */
+template <class View>
+std::list<Point_t> map_2_goals(View const& view);
+
+/**
+ * List the open nodes of view that are labelled with component
+ * @param labels component labels as computed by label_connected_components
+ */
+template <class View>
+std::list<Point_t> map_2_goals(View const& view, std::vector<int> const& labels, int component);
+
+/**
+ * Append the open nodes of view to goals, a list with any allocator
+ */
+template <class View, class Allocator>
+void map_2_goals(View const& view, std::list<Point_t, Allocator>& goals);
+
+/**
+ * Append the open nodes of view that are labelled with component to goals, a list with any allocator
+ */
+template <class View, class Allocator>
+void map_2_goals(View const& view, std::vector<int> const& labels, int component, std::list<Point_t, Allocator>& goals);
+
+/**
+ * Mark the free tiles of view that were covered before, see mark_covered_tiles above
+ */
+template <class View>
+int mark_covered_tiles(View const& view, RowMajorGrid const& covered, float resolution, fPoint_t origin,
+                       float tile_size, fPoint_t grid_origin, float min_fraction);
 #endif  // FULL_COVERAGE_PATH_PLANNER_COMMON_H
@@ -0,0 +1,235 @@
+//
+// Copyright [2020] Nobleo Technology"  [legal/copyright]
+//
+#include <stdint.h>
+#include <cstddef>
+#include <iterator>
+#include <list>
+#include <vector>
+
+#ifndef FULL_COVERAGE_PATH_PLANNER_COMPACT_PATH_H
+#define FULL_COVERAGE_PATH_PLANNER_COMPACT_PATH_H
+
+#include "full_coverage_path_planner/common.h"
+
+namespace full_coverage_path_planner
+{
+/**
+ * Path of grid points stored as its first point followed by straight runs.
+ * A run is one 16 bit code: the direction in the lowest 2 bits (0 = +x, 1 = +y, 2 = -x, 3 = -y) and the number of
+ * steps in the others. Runs longer than CompactPath::MAX_RUN are split. A step that is not to a 4-neighbor (a jump, or
+ * a point repeated) is stored as an escape code 0 followed by the point in four codes.
+ * A coverage path mostly drives straight, so this takes a fraction of a byte per point, against 24 bytes or more for
+ * a std::list<Point_t>; in the worst case, a turn at every point, it takes 2 bytes per point.
+ */
+class CompactPath
+{
+public:
+  static const int MAX_RUN = (1 << 14) - 1;
+
+  /**
+   * A straight piece of the path: length steps of (dx, dy) from `from` to `to`.
+   * A jump is a run of one step, with (dx, dy) the whole displacement.
+   */
+  typedef struct
+  {
+    Point_t from, to;
+    int dx, dy;
+    int length;
+  }
+  run_t;
+
+  /**
+   * Decodes the points one by one
+   */
+  class const_iterator
+  {
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Point_t value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Point_t const* pointer;
+    typedef Point_t const& reference;
+
+    const_iterator() : path_(NULL), index_(0), code_(0), remaining_(0), dir_(0)
+    {
+    }
+
+    reference operator*() const
+    {
+      return point_;
+    }
+
+    pointer operator->() const
+    {
+      return &point_;
+    }
+
+    const_iterator& operator++();
+
+    const_iterator operator++(int)
+    {
+      const_iterator copy(*this);
+      ++(*this);
+      return copy;
+    }
+
+    bool operator==(const_iterator const& other) const
+    {
+      return index_ == other.index_;
+    }
+
+    bool operator!=(const_iterator const& other) const
+    {
+      return index_ != other.index_;
+    }
+
+  private:
+    friend class CompactPath;
+    const_iterator(CompactPath const* path, std::size_t index);
+
+    CompactPath const* path_;
+    std::size_t index_, code_;
+    int remaining_, dir_;
+    Point_t point_;
+  };
+
+  /**
+   * Decodes the runs one by one, for consumers that only care about the turns
+   */
+  class RunReader
+  {
+  public:
+    explicit RunReader(CompactPath const& path);
+
+    /**
+     * @param run Output, the next run
+     * @return false if there are no runs left
+     */
+    bool next(run_t& run);
+
+  private:
+    CompactPath const& path_;
+    std::size_t code_;
+    Point_t point_;
+  };
+
+  CompactPath();
+
+  explicit CompactPath(std::list<Point_t> const& points);
+
+  /**
+   * Take over the codes of another path, for example from a message
+   * @param front first point
+   * @param size number of points, including the first
+   * @param codes as returned by codes()
+   * @throw std::invalid_argument if the codes do not give size points, or a run has no steps
+   */
+  CompactPath(Point_t const& front, std::size_t size, std::vector<uint16_t> const& codes);
+
+  template <class InputIterator>
+  CompactPath(InputIterator first, InputIterator last)
+    : CompactPath()
+  {
+    assign(first, last);
+  }
+
+  template <class InputIterator>
+  void assign(InputIterator first, InputIterator last)
+  {
+    clear();
+    append(first, last);
+  }
+
+  template <class InputIterator>
+  void append(InputIterator first, InputIterator last)
+  {
+    for (; first != last; ++first)
+    {
+      push_back(*first);
+    }
+  }
+
+  void push_back(Point_t const& point);
+
+  void clear();
+
+  /**
+   * Release the memory reserved for growth
+   */
+  void shrink_to_fit();
+
+  /**
+   * Number of points
+   */
+  std::size_t size() const
+  {
+    return size_;
+  }
+
+  bool empty() const
+  {
+    return size_ == 0;
+  }
+
+  Point_t const& front() const
+  {
+    return front_;
+  }
+
+  Point_t const& back() const
+  {
+    return back_;
+  }
+
+  const_iterator begin() const
+  {
+    return const_iterator(this, 0);
+  }
+
+  const_iterator end() const
+  {
+    return const_iterator(this, size_);
+  }
+
+  /**
+   * Number of 16 bit codes after the first point
+   */
+  std::size_t codeCount() const
+  {
+    return codes_.size();
+  }
+
+  std::vector<uint16_t> const& codes() const
+  {
+    return codes_;
+  }
+
+  /**
+   * Bytes taken by the path, including the memory reserved for growth
+   */
+  std::size_t memoryUsage() const
+  {
+    return sizeof(*this) + codes_.capacity() * sizeof(uint16_t);
+  }
+
+  std::list<Point_t> toList() const;
+
+private:
+  void pushJump(Point_t const& point);
+
+  static Point_t readJump(std::vector<uint16_t> const& codes, std::size_t& code);
+
+  std::vector<uint16_t> codes_;
+  std::size_t size_;
+  Point_t front_, back_;
+  // Code of the run that ends at back_, so it can be extended; codes_.size() if back_ ends in a jump
+  std::size_t last_run_;
+};
+
+/**
+ * Count the 90 degree turns along a path, like count_turns for a std::list<Point_t>, but by its runs
+ */
+int count_turns(CompactPath const &path);
+}  // namespace full_coverage_path_planner
+#endif  // FULL_COVERAGE_PATH_PLANNER_COMPACT_PATH_H
@@ -0,0 +1,74 @@
+//
+// Copyright [2020] Nobleo Technology"  [legal/copyright]
+//
+#include <string>
+
+#include <geometry_msgs/Point.h>
+#include <geometry_msgs/PoseStamped.h>
+#include <full_coverage_path_planner/CompactPlan.h>
+
+#ifndef FULL_COVERAGE_PATH_PLANNER_COMPACT_PLAN_H
+#define FULL_COVERAGE_PATH_PLANNER_COMPACT_PLAN_H
+
+#include "full_coverage_path_planner/common.h"
+#include "full_coverage_path_planner/compact_path.h"
+#include "full_coverage_path_planner/waypoint_generator.h"
+
+namespace full_coverage_path_planner
+{
+/**
+ * Fill a compact plan message
+ * @param start Start pose of robot
+ * @param path coverage path on the grid
+ * @param grid_origin position of the corner of grid point (0, 0)
+ * @param tile_size size of a grid point, in meters
+ * @param msg Output, header.stamp is left as it is
+ */
+void toCompactPlanMsg(geometry_msgs::PoseStamped const& start, CompactPath const& path, fPoint_t grid_origin,
+                      float tile_size, CompactPlan& msg);
+
+/**
+ * Expands a compact plan message for a controller. Only the runs are copied, the poses are made when they are
+ * asked for. Links against full_coverage_path_planner_compact_plan only, not the planners.
+ */
+class CompactPlanDecoder
+{
+public:
+  /**
+   * @throw std::invalid_argument if the codes are not a valid path: they do not match the length of the path, have a
+   * run without steps or end in the middle of a jump
+   */
+  explicit CompactPlanDecoder(CompactPlan const& msg);
+
+  /**
+   * The tiles of the path, decoded one by one by its iterators
+   */
+  CompactPath const& path() const
+  {
+    return path_;
+  }
+
+  /**
+   * Position of the center of a tile, in the frame of the message
+   */
+  geometry_msgs::Point position(Point_t const& tile) const;
+
+  /**
+   * The poses of the plan, the same as the planner publishes on nav_msgs/Path. The decoder must outlive the generator
+   */
+  WaypointGenerator waypoints() const;
+
+  std::string const& frame() const
+  {
+    return frame_;
+  }
+
+private:
+  CompactPath path_;
+  geometry_msgs::PoseStamped start_;
+  fPoint_t origin_;
+  float tile_size_;
+  std::string frame_;
+};
+}  // namespace full_coverage_path_planner
+#endif  // FULL_COVERAGE_PATH_PLANNER_COMPACT_PLAN_H
@@ -0,0 +1,33 @@
+//
+// Copyright [2020] Nobleo Technology"  [legal/copyright]
+//
+#include <boost/shared_ptr.hpp>
+
+#include <geometry_msgs/PoseStamped.h>
+#include <nav_core/base_global_planner.h>
+#include <nodelet/nodelet.h>
+#include <ros/ros.h>
+
+#ifndef FULL_COVERAGE_PATH_PLANNER_COVERAGE_PLANNER_NODELET_H
+#define FULL_COVERAGE_PATH_PLANNER_COVERAGE_PLANNER_NODELET_H
+
+namespace full_coverage_path_planner
+{
+/**
+ * Runs SpiralSTC or Boustrophedon as a nodelet instead of a move_base(_flex) plugin.
+ * A plan is made for each pose received on ~start, and published on ~plan and ~compact_plan as shared pointers,
+ * so consumers that are loaded in the same nodelet manager get it without serialization.
+ */
+class CoveragePlannerNodelet : public nodelet::Nodelet
+{
+public:
+  virtual void onInit();
+
+private:
+  void startCallback(const geometry_msgs::PoseStamped::ConstPtr& start);
+
+  boost::shared_ptr<nav_core::BaseGlobalPlanner> planner_;
+  ros::Subscriber start_sub_;
+};
+}  // namespace full_coverage_path_planner
+#endif  // FULL_COVERAGE_PATH_PLANNER_COVERAGE_PLANNER_NODELET_H
@@ -5,6 +5,8 @@
 /** for global path planner interface */
 #include <fstream>
 #include <list>
+#include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -16,6 +18,8 @@
 #include <nav_msgs/Path.h>
 #include <nav_msgs/GetMap.h>
 #include <geometry_msgs/PoseStamped.h>
+#include <geometry_msgs/PolygonStamped.h>
+#include <std_msgs/String.h>
 #include <angles/angles.h>
 #include <base_local_planner/world_model.h>
 #include <base_local_planner/costmap_model.h>
@@ -27,6 +31,10 @@ using std::string;
 #define FULL_COVERAGE_PATH_PLANNER_FULL_COVERAGE_PATH_PLANNER_H
 
 #include "full_coverage_path_planner/common.h"
+#include "full_coverage_path_planner/compact_path.h"
+#include "full_coverage_path_planner/compact_plan.h"
+#include "full_coverage_path_planner/lazy_occupancy_grid.h"
+#include "full_coverage_path_planner/waypoint_generator.h"
 
 // #define DEBUG_PLOT
 
@@ -43,15 +51,6 @@ using std::string;
 #define clamp(a, lower, upper)    dmax(dmin(a, upper), lower)
 #endif
 
-enum
-{
-  eDirNone = 0,
-  eDirRight = 1,
-  eDirUp = 2,
-  eDirLeft = -1,
-  eDirDown = -2,
-};
-
 namespace full_coverage_path_planner
 {
 class FullCoveragePathPlanner
@@ -64,10 +63,18 @@ public:
   FullCoveragePathPlanner(std::string name, costmap_2d::Costmap2DROS* costmap_ros);
 
   /**
-   * @brief  Publish a path for visualization purposes
+   * @brief  Publish a path for visualization purposes, if anyone listens.
+   * The message is published as a shared pointer, so subscribers in the same process get it without a copy
    */
   void publishPlan(const std::vector<geometry_msgs::PoseStamped>& path);
 
+  /**
+   * @brief  Publish the plan as a CompactPlan message, if anyone listens, also as a shared pointer
+   * @param start Start pose of robot
+   * @param path coverage path on the grid
+   */
+  void publishCompactPlan(const geometry_msgs::PoseStamped& start, CompactPath const& path);
+
   ~FullCoveragePathPlanner()
   {
   }
@@ -86,37 +93,145 @@ protected:
                            std::vector<geometry_msgs::PoseStamped>& plan);
 
   /**
-   * Convert ROS Occupancy grid to internal grid representation, given the size of a single tile
+   * Convert a compact path to a ROS path, appended to plan with a single allocation
+   * @param start Start pose of robot
+   * @param goalpoints Goal points from Spiral Algorithm
+   * @param plan  Output plan variable
+   */
+  void parsePointlist2Plan(const geometry_msgs::PoseStamped& start, CompactPath const& goalpoints,
+                           std::vector<geometry_msgs::PoseStamped>& plan);
+
+  /**
+   * The poses that parsePointlist2Plan puts in the plan, for consumers that handle them one at a time
+   * @param start Start pose of robot
+   * @param goalpoints Goal points from Spiral Algorithm, must outlive the generator
+   */
+  WaypointGenerator waypoints(const geometry_msgs::PoseStamped& start, CompactPath const& goalpoints) const;
+
+  /**
+   * Convert ROS Occupancy grid to internal grid representation, given the size of a single tile.
+   * If a coverage zone is set, only the tiles within its bounding box are parsed, and the tiles outside the zone
+   * are occupied. grid_origin_ is then the corner of the bounding box, and a start outside the zone is moved to
+   * the closest tile inside it.
+   * With circular_footprint_ a tile is occupied if the disk of the robot around its center overlaps an occupied cell,
+   * which is found with a distance transform in time linear in the number of cells, whatever the radius. Otherwise it
+   * is occupied if an occupied cell lies in the square around the tile that fits the robot.
    * @param cpp_grid_ ROS occupancy grid representation. Cells higher that 65 are considered occupied
-   * @param grid internal map representation
+   * @param grid internal map representation, any storage of the grid accessor interface. Instantiated for the nested
+   * vectors and RowMajorGrid
    * @param tileSize size (in meters) of a cell. This can be the robot's size
    * @param realStart Start position of the robot (in meters)
    * @param scaledStart Start position of the robot on the grid
+   * @param costs Output if not NULL, cost of each tile: the highest occupancy value (0-100) under the robot, or
+   * within the tile itself with a circular footprint
    * @return success
    */
+  template <class Grid>
   bool parseGrid(nav_msgs::OccupancyGrid const& cpp_grid_,
-                 std::vector<std::vector<bool> >& grid,
+                 Grid& grid,
                  float robotRadius,
                  float toolRadius,
                  geometry_msgs::PoseStamped const& realStart,
-                 Point_t& scaledStart);
+                 Point_t& scaledStart,
+                 CostGrid* costs = NULL);
+
+  /**
+   * Like parseGrid, but without evaluating the tiles: grid finds whether a tile is occupied the first time the
+   * planner reads it, from the cells of cpp_grid_, so the time to get started does not depend on the size of the map.
+   * Gives the same grid as parseGrid, but no costs
+   * @param cpp_grid_ ROS occupancy grid representation, must outlive grid
+   * @param grid Output
+   * @return success
+   */
+  bool parseGridLazily(nav_msgs::OccupancyGrid const& cpp_grid_,
+                       LazyOccupancyGrid& grid,
+                       float robotRadius,
+                       float toolRadius,
+                       geometry_msgs::PoseStamped const& realStart,
+                       Point_t& scaledStart);
+
+  /**
+   * The part of the map that parseGrid parses, and the scaling of the grid: sets tile_size_ and grid_origin_
+   * @param nodeSize size of a tile in cells
+   * @param zone Output, the coverage zone, empty for the whole map
+   * @param firstColl Output, the first cell of the parsed part of the map
+   * @param firstRow
+   * @param endColl Output, the cell after the parsed part of the map
+   * @param endRow
+   * @param scaledStart Output, the tile of realStart, clamped to the grid
+   * @return false if there is nothing to parse
+   */
+  bool parseGridBounds(nav_msgs::OccupancyGrid const& cpp_grid_,
+                       uint32_t nodeSize,
+                       geometry_msgs::PoseStamped const& realStart,
+                       std::vector<fPoint_t>& zone,
+                       int& firstColl,
+                       int& firstRow,
+                       int& endColl,
+                       int& endRow,
+                       Point_t& scaledStart);
+
+  /**
+   * If scaledStart is occupied, which happens when the robot is outside of the coverage zone, start from the
+   * closest free tile instead
+   * @return false if there is no free tile at all
+   */
+  template <class Grid>
+  bool moveStartIntoZone(Grid const& grid, geometry_msgs::PoseStamped const& realStart, Point_t& scaledStart);
+
+  /**
+   * Fill in the turn count and the estimated execution time of a coverage path in spiral_cpp_metrics_
+   * @param path coverage path on the grid, in 4-connected steps of tile_size_
+   */
+  void updateExecutionMetrics(CompactPath const& path);
+
+  /**
+   * Read the registry of coverage zones and subscribe to the topics that select the zone to cover
+   * @param nh node handle of the planner, in the private namespace
+   */
+  void initializeZones(ros::NodeHandle& nh);
+
+  /**
+   * Select a zone from the registry by its ID. An empty ID selects the whole map
+   */
+  void zoneCallback(const std_msgs::String& zone);
+
+  /**
+   * Cover the given polygon, in the map frame. A polygon with less than 3 points selects the whole map
+   */
+  void coveragePolygonCallback(const geometry_msgs::PolygonStamped& polygon);
+
   ros::Publisher plan_pub_;
+  ros::Publisher compact_plan_pub_;
   ros::ServiceClient cpp_grid_client_;
   nav_msgs::OccupancyGrid cpp_grid_;
   float robot_radius_;
   float tool_radius_;
   float plan_resolution_;
   float tile_size_;
+  float linear_velocity_;
+  float turn_duration_;
+  bool circular_footprint_;
   fPoint_t grid_origin_;
   bool initialized_;
-  geometry_msgs::PoseStamped previous_goal_;
+
+  ros::Subscriber zone_sub_;
+  ros::Subscriber coverage_polygon_sub_;
+  std::map<std::string, std::vector<fPoint_t> > zones_;
+  std::vector<fPoint_t> coverage_zone_;  // Empty to cover the whole map
+  std::mutex coverage_zone_mutex_;
 
   struct spiral_cpp_metrics_type
   {
     int visited_counter;
     int multiple_pass_counter;
     int accessible_counter;
+    int unreachable_counter;
+    int saved_transit_counter;
+    int turn_counter;
+    double estimated_execution_time;
     double total_area_covered;
+    double total_area_unreachable;
   };
   spiral_cpp_metrics_type spiral_cpp_metrics_;
 };
@@ -0,0 +1,450 @@
+//
+// Copyright [2020] Nobleo Technology"  [legal/copyright]
+//
+#include <stdint.h>
+#include <vector>
+
+#ifndef FULL_COVERAGE_PATH_PLANNER_GRID_STORAGE_H
+#define FULL_COVERAGE_PATH_PLANNER_GRID_STORAGE_H
+
+/*  *** Grid accessor interface ***
+ *  The planning algorithms access 2D grids of bools only through the free functions
+ *  gridWidth, gridHeight, gridGet, gridSet and gridAssign, so they work on any of the storages below
+ *  as well as on the plain std::vector<std::vector<bool> > (grid[y][x]).
+ *  x is the column index, y is the row index, like everywhere else in this package.
+ */
+
+/**
+ * Packed bit grid, rows stored one after the other in a single contiguous buffer
+ */
+class RowMajorGrid
+{
+public:
+  RowMajorGrid() : width_(0), height_(0)
+  {
+  }
+
+  RowMajorGrid(int width, int height, bool value = false)
+  {
+    assign(width, height, value);
+  }
+
+  explicit RowMajorGrid(std::vector<std::vector<bool> > const& grid)
+  {
+    assign(grid[0].size(), grid.size(), false);
+    for (int y = 0; y < height_; ++y)
+    {
+      for (int x = 0; x < width_; ++x)
+      {
+        set(x, y, grid[y][x]);
+      }
+    }
+  }
+
+  void assign(int width, int height, bool value)
+  {
+    width_ = width;
+    height_ = height;
+    words_.assign((static_cast<uint64_t>(width) * height + 63) / 64, value ? ~0ULL : 0ULL);
+  }
+
+  int width() const
+  {
+    return width_;
+  }
+
+  int height() const
+  {
+    return height_;
+  }
+
+  bool get(int x, int y) const
+  {
+    uint64_t bit = static_cast<uint64_t>(y) * width_ + x;
+    return (words_[bit >> 6] >> (bit & 63)) & 1ULL;
+  }
+
+  void set(int x, int y, bool value)
+  {
+    uint64_t bit = static_cast<uint64_t>(y) * width_ + x;
+    if (value)
+    {
+      words_[bit >> 6] |= (1ULL << (bit & 63));
+    }
+    else
+    {
+      words_[bit >> 6] &= ~(1ULL << (bit & 63));
+    }
+  }
+
+private:
+  int width_, height_;
+  std::vector<uint64_t> words_;
+};
+
+/**
+ * Spread the lower 16 bits of v over the even bits of the result, for Morton (Z-order) encoding
+ */
+inline uint32_t mortonSpreadBits(uint32_t v)
+{
+  v &= 0x0000ffff;
+  v = (v | (v << 8)) & 0x00ff00ff;
+  v = (v | (v << 4)) & 0x0f0f0f0f;
+  v = (v | (v << 2)) & 0x33333333;
+  v = (v | (v << 1)) & 0x55555555;
+  return v;
+}
+
+/**
+ * Morton (Z-order) index of (x, y): the bits of x and y interleaved
+ */
+inline uint32_t mortonEncode(uint32_t x, uint32_t y)
+{
+  return mortonSpreadBits(x) | (mortonSpreadBits(y) << 1);
+}
+
+/**
+ * Packed bit grid stored in square tiles of (1 << TileShift) nodes per side.
+ * Tiles are stored row-major, the nodes within a tile in Morton order, so nodes that are close in 2D
+ * (also vertically) are close in memory. With TileShift 3, a tile of 8x8 nodes is exactly one 64-bit word.
+ */
+template <int TileShift>
+class TiledGrid
+{
+public:
+  TiledGrid() : width_(0), height_(0), tilesX_(0)
+  {
+  }
+
+  TiledGrid(int width, int height, bool value = false)
+  {
+    assign(width, height, value);
+  }
+
+  explicit TiledGrid(std::vector<std::vector<bool> > const& grid)
+  {
+    assign(grid[0].size(), grid.size(), false);
+    for (int y = 0; y < height_; ++y)
+    {
+      for (int x = 0; x < width_; ++x)
+      {
+        set(x, y, grid[y][x]);
+      }
+    }
+  }
+
+  void assign(int width, int height, bool value)
+  {
+    width_ = width;
+    height_ = height;
+    tilesX_ = (width + kTileSide - 1) >> TileShift;
+    uint64_t tilesY = (height + kTileSide - 1) >> TileShift;
+    words_.assign((tilesX_ * tilesY * kTileBits + 63) / 64, value ? ~0ULL : 0ULL);
+  }
+
+  int width() const
+  {
+    return width_;
+  }
+
+  int height() const
+  {
+    return height_;
+  }
+
+  bool get(int x, int y) const
+  {
+    uint64_t bit = bitIndex(x, y);
+    return (words_[bit >> 6] >> (bit & 63)) & 1ULL;
+  }
+
+  void set(int x, int y, bool value)
+  {
+    uint64_t bit = bitIndex(x, y);
+    if (value)
+    {
+      words_[bit >> 6] |= (1ULL << (bit & 63));
+    }
+    else
+    {
+      words_[bit >> 6] &= ~(1ULL << (bit & 63));
+    }
+  }
+
+private:
+  static const int kTileSide = 1 << TileShift;
+  static const uint64_t kTileBits = static_cast<uint64_t>(kTileSide) * kTileSide;
+
+  uint64_t bitIndex(int x, int y) const
+  {
+    uint64_t tile = static_cast<uint64_t>(y >> TileShift) * tilesX_ + (x >> TileShift);
+    return tile * kTileBits + mortonEncode(x & (kTileSide - 1), y & (kTileSide - 1));
+  }
+
+  int width_, height_;
+  uint64_t tilesX_;
+  std::vector<uint64_t> words_;
+};
+
+typedef TiledGrid<3> TiledGrid8;
+typedef TiledGrid<6> TiledGrid64;
+
+/**
+ * Sparse packed bit grid in pages of 64x64 nodes, a row of a page per 64-bit word. Only the pages that are written
+ * to are allocated; a page that never was reads as the value the grid was assigned with.
+ * It can also overlay a RowMajorGrid copy-on-write: the pages that were not written read from the base grid, and
+ * the first write to a page copies that page of the base. The base is never modified, so any number of overlays
+ * can share it, as long as it outlives them and does not change while they use it.
+ */
+class PagedGrid
+{
+public:
+  PagedGrid() : width_(0), height_(0), pagesX_(0), value_(false), base_(NULL)
+  {
+  }
+
+  PagedGrid(int width, int height, bool value = false)
+  {
+    assign(width, height, value);
+  }
+
+  explicit PagedGrid(RowMajorGrid const& base)
+  {
+    assign(base.width(), base.height(), false);
+    base_ = &base;
+  }
+
+  void assign(int width, int height, bool value)
+  {
+    width_ = width;
+    height_ = height;
+    pagesX_ = (width + kPageSide - 1) >> kPageShift;
+    value_ = value;
+    base_ = NULL;
+    pages_.assign(static_cast<uint64_t>(pagesX_) * ((height + kPageSide - 1) >> kPageShift), kNoPage);
+    words_.clear();
+  }
+
+  int width() const
+  {
+    return width_;
+  }
+
+  int height() const
+  {
+    return height_;
+  }
+
+  bool get(int x, int y) const
+  {
+    uint32_t page = pages_[pageIndex(x, y)];
+    if (page == kNoPage)
+    {
+      return base_ ? base_->get(x, y) : value_;
+    }
+    return (words_[static_cast<uint64_t>(page) * kPageSide + (y & (kPageSide - 1))] >> (x & (kPageSide - 1))) & 1ULL;
+  }
+
+  void set(int x, int y, bool value)
+  {
+    uint32_t& page = pages_[pageIndex(x, y)];
+    if (page == kNoPage)
+    {
+      if (!base_ && value == value_)
+      {
+        return;  // Nothing changes, so there is no need for the page
+      }
+      page = allocatePage(x & ~(kPageSide - 1), y & ~(kPageSide - 1));
+    }
+    uint64_t& word = words_[static_cast<uint64_t>(page) * kPageSide + (y & (kPageSide - 1))];
+    if (value)
+    {
+      word |= (1ULL << (x & (kPageSide - 1)));
+    }
+    else
+    {
+      word &= ~(1ULL << (x & (kPageSide - 1)));
+    }
+  }
+
+  /**
+   * Number of pages that are allocated, each of which takes 512 bytes
+   */
+  std::size_t allocatedPages() const
+  {
+    return words_.size() / kPageSide;
+  }
+
+private:
+  static const int kPageShift = 6;
+  static const int kPageSide = 1 << kPageShift;
+  enum
+  {
+    kNoPage = 0xffffffff  // Index of a page that is not allocated
+  };
+
+  uint64_t pageIndex(int x, int y) const
+  {
+    return static_cast<uint64_t>(y >> kPageShift) * pagesX_ + (x >> kPageShift);
+  }
+
+  /**
+   * Add a page with the corner (x0, y0), filled with what the grid reads there now
+   * @return index of the page
+   */
+  uint32_t allocatePage(int x0, int y0)
+  {
+    uint32_t page = words_.size() / kPageSide;
+    words_.resize(words_.size() + kPageSide, value_ ? ~0ULL : 0ULL);
+    for (int y = y0; base_ && y < y0 + kPageSide && y < height_; ++y)
+    {
+      uint64_t& word = words_[static_cast<uint64_t>(page) * kPageSide + (y - y0)];
+      for (int x = x0; x < x0 + kPageSide && x < width_; ++x)
+      {
+        word |= static_cast<uint64_t>(base_->get(x, y)) << (x - x0);
+      }
+    }
+    return page;
+  }
+
+  int width_, height_, pagesX_;
+  bool value_;
+  RowMajorGrid const* base_;
+  std::vector<uint32_t> pages_;  // Index of the page of each 64x64 block
+  std::vector<uint64_t> words_;
+};
+
+/**
+ * Read-only storage on top of a raw costmap char map (e.g. costmap_2d::Costmap2D::getCharMap()), without copying.
+ * A node is occupied if its cost is Threshold or higher, so unknown space (255) is always occupied.
+ */
+template <unsigned char Threshold>
+class CostmapGrid
+{
+public:
+  CostmapGrid(unsigned char const* data, int width, int height) : data_(data), width_(width), height_(height)
+  {
+  }
+
+  int width() const
+  {
+    return width_;
+  }
+
+  int height() const
+  {
+    return height_;
+  }
+
+  bool get(int x, int y) const
+  {
+    return data_[static_cast<uint64_t>(y) * width_ + x] >= Threshold;
+  }
+
+private:
+  unsigned char const* data_;
+  int width_, height_;
+};
+
+/**
+ * Traversal cost of each node, one byte per node, row-major. 0 is the cheapest.
+ * Not a grid of bools, so it is used next to a view instead of through the grid accessor interface.
+ */
+class CostGrid
+{
+public:
+  CostGrid() : width_(0), height_(0)
+  {
+  }
+
+  CostGrid(int width, int height, unsigned char value = 0)
+    : width_(width), height_(height), costs_(static_cast<uint64_t>(width) * height, value)
+  {
+  }
+
+  int width() const
+  {
+    return width_;
+  }
+
+  int height() const
+  {
+    return height_;
+  }
+
+  unsigned char get(int x, int y) const
+  {
+    return costs_[static_cast<uint64_t>(y) * width_ + x];
+  }
+
+  void set(int x, int y, unsigned char cost)
+  {
+    costs_[static_cast<uint64_t>(y) * width_ + x] = cost;
+  }
+
+private:
+  int width_, height_;
+  std::vector<unsigned char> costs_;
+};
+
+/*
+ * Accessors for the legacy nested vector representation
+ */
+inline int gridWidth(std::vector<std::vector<bool> > const& grid)
+{
+  return grid[0].size();
+}
+
+inline int gridHeight(std::vector<std::vector<bool> > const& grid)
+{
+  return grid.size();
+}
+
+inline bool gridGet(std::vector<std::vector<bool> > const& grid, int x, int y)
+{
+  return grid[y][x];
+}
+
+inline void gridSet(std::vector<std::vector<bool> >& grid, int x, int y, bool value)
+{
+  grid[y][x] = value;
+}
+
+inline void gridAssign(std::vector<std::vector<bool> >& grid, int width, int height, bool value)
+{
+  grid.assign(height, std::vector<bool>(width, value));
+}
+
+/*
+ * Accessors for the storage classes above
+ */
+template <class Grid>
+inline int gridWidth(Grid const& grid)
+{
+  return grid.width();
+}
+
+template <class Grid>
+inline int gridHeight(Grid const& grid)
+{
+  return grid.height();
+}
+
+template <class Grid>
+inline bool gridGet(Grid const& grid, int x, int y)
+{
+  return grid.get(x, y);
+}
+
+template <class Grid>
+inline void gridSet(Grid& grid, int x, int y, bool value)
+{
+  grid.set(x, y, value);
+}
+
+template <class Grid>
+inline void gridAssign(Grid& grid, int width, int height, bool value)
+{
+  grid.assign(width, height, value);
+}
+#endif  // FULL_COVERAGE_PATH_PLANNER_GRID_STORAGE_H
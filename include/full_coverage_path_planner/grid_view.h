@@ -0,0 +1,85 @@
+//
+// Copyright [2020] Nobleo Technology"  [legal/copyright]
+//
+#include <vector>
+
+#ifndef FULL_COVERAGE_PATH_PLANNER_GRID_VIEW_H
+#define FULL_COVERAGE_PATH_PLANNER_GRID_VIEW_H
+
+#include "full_coverage_path_planner/grid_storage.h"
+
+/*  *** GridView concept ***
+ *  The planning algorithms (spiral, spiral_stc, the searches to open space, map_2_goals) see the map through a view:
+ *    int width() const
+ *    int height() const
+ *    bool blocked(int x, int y) const  true == occupied/obstacle
+ *    bool visited(int x, int y) const  true == already covered by the plan
+ *    void mark(int x, int y) const     mark as visited
+ *  A view does not own any memory. It refers to an obstacle layer and a visited layer that live elsewhere,
+ *  so it is cheap to copy and mark() is const, like writing through a pointer.
+ *  Obstacles are never marked as visited: a node is open when it is neither blocked nor visited.
+ */
+
+/**
+ * View on an obstacle layer and a visited layer, each of which can be any storage of the grid accessor interface
+ * in grid_storage.h. The obstacle layer is only read, so it can be the memory the map already lives in.
+ */
+template <class Obstacles, class Visited = RowMajorGrid>
+class GridView
+{
+public:
+  GridView(Obstacles const& obstacles, Visited& visited) : obstacles_(&obstacles), visited_(&visited)
+  {
+  }
+
+  int width() const
+  {
+    return gridWidth(*obstacles_);
+  }
+
+  int height() const
+  {
+    return gridHeight(*obstacles_);
+  }
+
+  bool blocked(int x, int y) const
+  {
+    return gridGet(*obstacles_, x, y);
+  }
+
+  bool visited(int x, int y) const
+  {
+    return gridGet(*visited_, x, y);
+  }
+
+  void mark(int x, int y) const
+  {
+    gridSet(*visited_, x, y, true);
+  }
+
+private:
+  Obstacles const* obstacles_;
+  Visited* visited_;
+};
+
+/*
+ * Adapters for which all planning algorithms are instantiated
+ */
+typedef GridView<std::vector<std::vector<bool> >, std::vector<std::vector<bool> > > NestedVectorView;
+typedef GridView<RowMajorGrid, RowMajorGrid> BitsetView;
+typedef GridView<TiledGrid8, TiledGrid8> TiledView8;
+typedef GridView<TiledGrid64, TiledGrid64> TiledView64;
+
+/**
+ * Plan directly on a costmap char map. Instantiated for costmap_2d::INSCRIBED_INFLATED_OBSTACLE (253)
+ * and costmap_2d::LETHAL_OBSTACLE (254)
+ */
+template <unsigned char Threshold>
+using CostmapView = GridView<CostmapGrid<Threshold>, RowMajorGrid>;
+
+/**
+ * Plan on a shared obstacle layer with a copy-on-write visited overlay, so that several plans on the same map
+ * only allocate the pages of the visited layer they change
+ */
+typedef GridView<RowMajorGrid, PagedGrid> PagedView;
+#endif  // FULL_COVERAGE_PATH_PLANNER_GRID_VIEW_H
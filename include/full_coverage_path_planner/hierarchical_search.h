@@ -0,0 +1,107 @@
+//
+// Copyright [2020] Nobleo Technology"  [legal/copyright]
+//
+#include <list>
+#include <utility>
+#include <vector>
+
+#ifndef FULL_COVERAGE_PATH_PLANNER_HIERARCHICAL_SEARCH_H
+#define FULL_COVERAGE_PATH_PLANNER_HIERARCHICAL_SEARCH_H
+
+#include "full_coverage_path_planner/common.h"
+
+namespace full_coverage_path_planner
+{
+/**
+ * Hierarchical (HPA*-style) replacement for a_star_to_open_space, for long backtracking transitions on large maps.
+ *
+ * The grid is split into square clusters. Wherever free nodes of two neighboring clusters touch, entrances are
+ * placed, and the cost of traveling between entrances of the same cluster is precomputed. A search to open space
+ * then runs Dijkstra over this small abstract graph and only refines the chosen corridor on the grid itself.
+ *
+ * The abstraction only depends on the obstacles. The visited state is tracked by a counter of open nodes per
+ * cluster, so it is updated in O(1) per node that becomes visited (see markVisited).
+ *
+ * View is any type of the GridView concept in grid_view.h, instantiated for the same adapters as
+ * the functions in common.h.
+ */
+template <class View>
+class HierarchicalSearch
+{
+public:
+  /**
+   * Build the abstract graph of the obstacles of view
+   * @param view map and visited state. Only a copy of the view is kept, not of the grids it refers to
+   * @param cluster_size size of the side of a cluster, in nodes
+   */
+  HierarchicalSearch(View const &view, int cluster_size);
+
+  /**
+   * (Re)count the open nodes of each cluster
+   */
+  void initOpenCounts();
+
+  /**
+   * Register that a node became visited. Must be called once for each node that goes from open to visited
+   */
+  void markVisited(int x, int y);
+
+  /**
+   * Find a path from init to the closest (on the abstract level) open node
+   * @param init start position
+   * @param pathNodes nodes that form the path from init to open space, appended like a_star_to_open_space does
+   * @return whether we resign from finding a path or not. true is we resign and false if we found a path
+   */
+  bool searchToOpenSpace(gridNode_t init, std::list<gridNode_t> &pathNodes);
+
+  int clusterCount() const
+  {
+    return nClusterCols_ * nClusterRows_;
+  }
+
+  int entranceCount() const
+  {
+    return entrances_.size();
+  }
+
+private:
+  typedef struct
+  {
+    Point_t pos;
+    int cluster;
+    std::vector<std::pair<int, int> > edges;  // (entrance, cost)
+  }
+  entrance_t;
+
+  int clusterOf(int x, int y) const;
+
+  int addEntrance(int x, int y);
+
+  void addTransitions(Point_t first, Point_t step, Point_t across, int length);
+
+  /**
+   * Breadth-first search from 'from' that never leaves cluster.
+   * Results are stored in bfs_dist_ and bfs_parent_, indexed by the node index local to the cluster.
+   * @param to_open if true, stop at the first open node
+   * @param target if >= 0, stop at this local node index
+   * @return local index of the node the search stopped at, or -1 if the whole cluster was explored
+   */
+  int clusterBfs(Point_t from, int cluster, bool to_open, int target);
+
+  int localIndex(int cluster, Point_t p) const;
+
+  /**
+   * Append the path found by the last clusterBfs to path, excluding 'from' itself
+   */
+  void appendBfsPath(int cluster, int local, std::vector<Point_t> &path) const;
+
+  View view_;
+  int clusterSize_, nRows_, nCols_, nClusterRows_, nClusterCols_;
+  std::vector<entrance_t> entrances_;
+  std::vector<std::vector<int> > clusterEntrances_;
+  std::vector<int> entranceAt_;  // Entrance index per node (row-major), -1 if none
+  std::vector<int> openCount_;
+  std::vector<int> bfs_dist_, bfs_parent_, bfs_queue_;
+};
+}  // namespace full_coverage_path_planner
+#endif  // FULL_COVERAGE_PATH_PLANNER_HIERARCHICAL_SEARCH_H
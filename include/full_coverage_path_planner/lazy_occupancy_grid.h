@@ -0,0 +1,132 @@
+//
+// Copyright [2020] Nobleo Technology"  [legal/copyright]
+//
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+
+#ifndef FULL_COVERAGE_PATH_PLANNER_LAZY_OCCUPANCY_GRID_H
+#define FULL_COVERAGE_PATH_PLANNER_LAZY_OCCUPANCY_GRID_H
+
+#include "full_coverage_path_planner/common.h"
+#include "full_coverage_path_planner/grid_view.h"
+
+/**
+ * Read-only storage of the grid accessor interface on top of the cells of a nav_msgs/OccupancyGrid, which finds
+ * whether a node is occupied the first time it is read, with the same rules as FullCoveragePathPlanner::parseGrid.
+ * The result is kept in 2 bits per node (unknown, free or occupied), so every node is evaluated at most once, and
+ * the nodes that the planner never reads are not evaluated at all.
+ * The states are only ever set from unknown to known, atomically, so the grid can be read from several threads.
+ */
+class LazyOccupancyGrid
+{
+public:
+  LazyOccupancyGrid() : data_(NULL), width_(0), height_(0)
+  {
+  }
+
+  /**
+   * @param data cells of the map, row-major like nav_msgs/OccupancyGrid::data. Cells higher than 65 are occupied.
+   * Must outlive the grid
+   * @param nCols width of the map, in cells
+   * @param nRows height of the map, in cells
+   * @param firstColl cell at the lower left corner of node (0, 0)
+   * @param firstRow
+   * @param width width of the grid, in nodes
+   * @param height height of the grid, in nodes
+   * @param nodeSize side of a node, in cells
+   */
+  LazyOccupancyGrid(int8_t const* data, int nCols, int nRows, int firstColl, int firstRow, int width, int height,
+                    int nodeSize);
+
+  /**
+   * A node is occupied if an occupied cell lies in the square of robotNodeSize cells around it. This is the default,
+   * with a robot the size of a node. Must be set before the grid is read
+   */
+  void setSquareFootprint(int robotNodeSize);
+
+  /**
+   * A node is occupied if an occupied cell is closer to its center than robotCells cells. The nodes are then evaluated
+   * in blocks of kBlockSize x kBlockSize nodes, from one distance transform of the cells under a block and a margin of
+   * robotCells around them, so a node takes the same time whatever the radius
+   */
+  void setCircularFootprint(float robotCells);
+
+  /**
+   * Nodes whose center lies outside zone are occupied
+   * @param zone polygon in the map frame. Empty for the whole map
+   * @param grid_origin position of the corner of node (0, 0)
+   * @param tile_size size of a node, in meters
+   */
+  void setZone(std::vector<fPoint_t> const& zone, fPoint_t grid_origin, float tile_size);
+
+  int width() const
+  {
+    return width_;
+  }
+
+  int height() const
+  {
+    return height_;
+  }
+
+  bool get(int x, int y) const
+  {
+    uint64_t node = static_cast<uint64_t>(y) * width_ + x;
+    int shift = (node & 15) * 2;
+    uint32_t state = (states_[node >> 4].load(std::memory_order_relaxed) >> shift) & 3;
+    if (state == kStateUnknown)
+    {
+      state = evaluate(x, y) ? kStateOccupied : kStateFree;
+      states_[node >> 4].fetch_or(state << shift, std::memory_order_relaxed);
+    }
+    return state == kStateOccupied;
+  }
+
+  /**
+   * Number of nodes that were evaluated so far
+   */
+  int evaluated() const;
+
+  enum
+  {
+    kBlockSize = 64  // Side of the blocks of nodes that are evaluated together for a circular footprint
+  };
+
+private:
+  enum
+  {
+    kStateUnknown = 0,
+    kStateFree = 1,
+    kStateOccupied = 2
+  };
+
+  /**
+   * Whether node (x, y) is occupied, from the cells of the map
+   */
+  bool evaluate(int x, int y) const;
+
+  /**
+   * Whether the center of node (x, y) is outside of the zone
+   */
+  bool outsideZone(int x, int y) const;
+
+  /**
+   * Evaluate all nodes of the block that contains node (x, y) for the circular footprint, and store their states
+   * @return whether node (x, y) is occupied
+   */
+  bool evaluateCircularBlock(int x, int y) const;
+
+  int8_t const* data_;
+  int nCols_, nRows_, firstColl_, firstRow_;
+  int width_, height_, nodeSize_;
+  int robotNodeSize_;
+  float robotCells_;  // Radius of a circular footprint, 0 for a square one
+  std::vector<fPoint_t> zone_;
+  fPoint_t grid_origin_;
+  float tile_size_;
+  mutable std::vector<std::atomic<uint32_t> > states_;  // 16 nodes per word
+};
+
+typedef GridView<LazyOccupancyGrid, RowMajorGrid> LazyView;
+#endif  // FULL_COVERAGE_PATH_PLANNER_LAZY_OCCUPANCY_GRID_H
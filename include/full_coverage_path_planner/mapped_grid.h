@@ -0,0 +1,189 @@
+//
+// Copyright [2020] Nobleo Technology"  [legal/copyright]
+//
+#include <stdint.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#ifndef FULL_COVERAGE_PATH_PLANNER_MAPPED_GRID_H
+#define FULL_COVERAGE_PATH_PLANNER_MAPPED_GRID_H
+
+#include "full_coverage_path_planner/grid_storage.h"
+#include "full_coverage_path_planner/grid_view.h"
+
+/**
+ * Read-only memory mapping of a binary (P5) PGM with 8-bit pixels, the image format map_server saves maps in.
+ * Rows are stored top-down in the image, so image row 0 is the last row of the map.
+ */
+class MappedPgm
+{
+public:
+  /**
+   * @throw std::runtime_error if the file cannot be mapped or is not an 8-bit binary PGM
+   */
+  explicit MappedPgm(std::string const& path);
+  ~MappedPgm();
+
+  MappedPgm(MappedPgm const&) = delete;
+  MappedPgm& operator=(MappedPgm const&) = delete;
+
+  int width() const
+  {
+    return width_;
+  }
+
+  int height() const
+  {
+    return height_;
+  }
+
+  /**
+   * Pixels of image row r, 0 is the top row
+   */
+  unsigned char const* row(int r) const
+  {
+    return pixels_ + static_cast<uint64_t>(r) * width_;
+  }
+
+  /**
+   * Let the kernel drop the pages of image rows [first_row, end_row) from the resident set.
+   * They are read from the file again when they are touched the next time
+   */
+  void release(int first_row, int end_row) const;
+
+private:
+  int fd_;
+  void* data_;
+  std::size_t size_;
+  unsigned char const* pixels_;
+  int width_, height_;
+};
+
+/**
+ * Read-only storage of the grid accessor interface on top of a mapped map_server image, for maps too large to
+ * parse into memory at once. The nodes are parsed from the image a tile of 64x64 nodes at a time, when they are
+ * first read, and kept in a bounded LRU cache of fixed-size blocks; the least recently used tile is dropped when
+ * the cache is full, and parsed again if it is needed later.
+ * A node is occupied if any cell under a square footprint is occupied, like FullCoveragePathPlanner::parseGrid does
+ * with a square footprint. Unknown cells count as free.
+ * The cache is updated by get(), so a MappedGrid must not be read from several threads at the same time
+ * (spiral_stc_regions and spiral_stc_multi_start must use one thread on it).
+ */
+class MappedGrid
+{
+public:
+  /**
+   * @param pgm the map, must outlive the grid
+   * @param node_size side of a node, in cells
+   * @param robot_node_size side of the footprint checked per node, in cells
+   * @param occupied_thresh occupied_thresh of the map yaml: cells with a higher occupancy probability are occupied
+   * @param negate negate of the map yaml: whether white instead of black is occupied
+   * @param memory_limit bytes the cached tiles may take. At least one tile is kept, whatever the limit
+   */
+  MappedGrid(MappedPgm const& pgm, int node_size, int robot_node_size, double occupied_thresh, bool negate,
+             std::size_t memory_limit);
+
+  int width() const
+  {
+    return width_;
+  }
+
+  int height() const
+  {
+    return height_;
+  }
+
+  bool get(int x, int y) const
+  {
+    int tile = (y >> kTileShift) * tilesX_ + (x >> kTileShift);
+    if (tile != last_tile_)
+    {
+      last_words_ = load(tile);
+      last_tile_ = tile;
+    }
+    uint32_t bit = mortonEncode(x & (kTileSide - 1), y & (kTileSide - 1));
+    return (last_words_[bit >> 6] >> (bit & 63)) & 1ULL;
+  }
+
+  /**
+   * Number of times a tile was parsed from the image, including tiles that were parsed again after being dropped
+   */
+  uint64_t pageIns() const
+  {
+    return page_ins_;
+  }
+
+  /**
+   * Number of times a tile was dropped from the cache to make room for another one
+   */
+  uint64_t evictions() const
+  {
+    return evictions_;
+  }
+
+  /**
+   * Number of tiles in the cache now, at most capacity()
+   */
+  std::size_t residentTiles() const
+  {
+    return resident_;
+  }
+
+  std::size_t capacity() const
+  {
+    return capacity_;
+  }
+
+  static const int kTileShift = 6;
+  static const int kTileSide = 1 << kTileShift;
+  static const int kTileWords = kTileSide * kTileSide / 64;
+  static const std::size_t kTileBytes = kTileWords * sizeof(uint64_t);
+
+private:
+  /**
+   * Find tile in the cache, or parse it into the least recently used block
+   * @return the words of the tile
+   */
+  uint64_t const* load(int tile) const;
+
+  /**
+   * Parse the nodes of tile from the image
+   */
+  void parse(int tile, uint64_t* words) const;
+
+  void unlink(int slot) const;
+  void pushFront(int slot) const;
+
+  MappedPgm const* pgm_;
+  int node_size_, robot_node_size_, offset_;
+  int width_, height_, tilesX_;
+  bool occupied_[256];  // Whether a cell with this pixel value is occupied
+
+  // The blocks are preallocated. The slots are linked from the most to the least recently used
+  std::size_t capacity_;
+  mutable std::vector<uint64_t> blocks_;
+  mutable std::vector<int> tile_slot_;  // Slot of each tile, -1 if it is not cached
+  mutable std::vector<int> slot_tile_, slot_prev_, slot_next_;
+  mutable int head_, tail_;
+  mutable std::size_t resident_;
+  mutable uint64_t page_ins_, evictions_;
+  mutable int last_tile_;
+  mutable uint64_t const* last_words_;
+};
+
+typedef GridView<MappedGrid, RowMajorGrid> MappedView;
+
+/**
+ * Resource usage of this process so far, see getrusage(2)
+ */
+typedef struct
+{
+  long peak_rss_kb;  // Peak resident set size, in kilobytes
+  long major_faults;  // Page faults that had to read from disk
+  long minor_faults;  // Page faults that were served from the page cache
+}
+resource_usage_t;
+
+resource_usage_t resourceUsage();
+#endif  // FULL_COVERAGE_PATH_PLANNER_MAPPED_GRID_H
@@ -0,0 +1,92 @@
+//
+// Copyright [2020] Nobleo Technology"  [legal/copyright]
+//
+#include <chrono>
+#include <vector>
+
+#ifndef FULL_COVERAGE_PATH_PLANNER_REGION_TOUR_H
+#define FULL_COVERAGE_PATH_PLANNER_REGION_TOUR_H
+
+#include "full_coverage_path_planner/common.h"
+
+namespace full_coverage_path_planner
+{
+/**
+ * Build the adjacency graph of regions: two regions are adjacent if a node of one is a 4-neighbor of a node
+ * of the other
+ * @param labels region per node, row-major, -1 for obstacles (see label_block_regions)
+ * @param nCols width of the grid
+ * @param nRegions number of regions
+ * @param adjacency Output, the adjacent regions of each region
+ */
+void build_region_adjacency(std::vector<int> const &labels, int nCols, int nRegions,
+                            std::vector<std::vector<int> > &adjacency);
+
+/**
+ * Order in which to visit a set of regions, each of which is entered at its entry and left at its exit.
+ * This is an open asymmetric traveling salesman problem over the regions. The transit between two regions is
+ * estimated by the Manhattan distance from the exit of one to the entry of the other, a lower bound of the path
+ * on a 4-connected grid.
+ *
+ * The tour is built with nearest neighbor and then improved with 2-opt and Or-opt moves. Only moves that put a region
+ * right after one of its neighbors in the adjacency graph are tried, so a pass is linear in the number of regions.
+ */
+class RegionTour
+{
+public:
+  /**
+   * @param entries where each region is entered
+   * @param exits where each region is left
+   * @param adjacency adjacent regions of each region, used as candidates for the improvement moves
+   */
+  RegionTour(std::vector<Point_t> const &entries, std::vector<Point_t> const &exits,
+             std::vector<std::vector<int> > const &adjacency);
+
+  /**
+   * Build the tour by going to the region with the closest entry each time
+   * @param first region to start with, it stays first
+   */
+  void nearestNeighbor(int first);
+
+  /**
+   * Apply improving 2-opt and Or-opt moves until none is left or time_budget is used up
+   * @param time_budget in seconds
+   */
+  void improve(double time_budget);
+
+  std::vector<int> const &order() const
+  {
+    return tour_;
+  }
+
+  /**
+   * Estimated transit length of the tour, in nodes
+   */
+  int cost() const;
+
+private:
+  int transit(int from, int to) const;
+
+  /**
+   * Recompute the position of each region and the prefix sums of the tour cost, forwards and backwards
+   */
+  void update();
+
+  /**
+   * One sweep over the tour, applying every improving move found
+   * @return whether the tour was improved
+   */
+  bool twoOpt();
+
+  bool orOpt();
+
+  bool timeIsUp(int i) const;
+
+  std::vector<Point_t> const &entries_;
+  std::vector<Point_t> const &exits_;
+  std::vector<std::vector<int> > const &adjacency_;
+  std::vector<int> tour_, position_, forward_, backward_;
+  std::chrono::steady_clock::time_point deadline_;
+};
+}  // namespace full_coverage_path_planner
+#endif  // FULL_COVERAGE_PATH_PLANNER_REGION_TOUR_H
@@ -0,0 +1,139 @@
+//
+// Copyright [2020] Nobleo Technology"  [legal/copyright]
+//
+#include <list>
+#include <vector>
+
+#ifndef FULL_COVERAGE_PATH_PLANNER_SPANNING_TREE_COVERAGE_H
+#define FULL_COVERAGE_PATH_PLANNER_SPANNING_TREE_COVERAGE_H
+
+#include "full_coverage_path_planner/common.h"
+
+namespace full_coverage_path_planner
+{
+/**
+ * Spanning Tree Coverage (Gabriely and Rimon) on mega-cells: the 2x2 blocks of nodes that start at even coordinates.
+ * A mega-cell is free when its four nodes are free, open and reachable. A spanning tree over 4-connected free
+ * mega-cells is built with a depth-first search, and circumnavigated on the nodes: the walk keeps the tree on its
+ * left and covers every node of every mega-cell in the tree exactly once, ending next to where it started.
+ * Both steps are linear in the number of mega-cells.
+ * Nodes of partially occupied mega-cells are left to the spiral, see SpanningTreeSpiralView.
+ */
+class SpanningTreeCoverage
+{
+public:
+  /**
+   * @param view map and visited state
+   * @param components component labels as computed by label_connected_components
+   * @param component only mega-cells of which all nodes are labelled with component are free. -1 to allow any
+   */
+  template <class View>
+  SpanningTreeCoverage(View const &view, std::vector<int> const &components, int component)
+    : cols_(view.width() / 2),
+      rows_(view.height() / 2),
+      cells_(cols_ * rows_, eCellPartial),
+      edges_(cols_ * rows_, 0)
+  {
+    for (int cy = 0; cy < rows_; ++cy)
+    {
+      for (int cx = 0; cx < cols_; ++cx)
+      {
+        bool free = true;
+        for (int i = 0; i < 4 && free; ++i)
+        {
+          int x = 2 * cx + (i & 1), y = 2 * cy + (i >> 1);
+          // The component comes first, so the nodes outside it are not read
+          free = (component < 0 || components[y * view.width() + x] == component) &&
+                 !view.blocked(x, y) && !view.visited(x, y);
+        }
+        if (free)
+        {
+          cells_[cy * cols_ + cx] = eCellFree;
+        }
+      }
+    }
+  }
+
+  /**
+   * Whether node (x, y) is in a free mega-cell that is not covered yet
+   */
+  bool isFree(int x, int y) const
+  {
+    int cx = x / 2, cy = y / 2;
+    return cx < cols_ && cy < rows_ && cells_[cy * cols_ + cx] == eCellFree;
+  }
+
+  /**
+   * Build the spanning tree over the free mega-cells that can be reached from the one of the last node of pathNodes,
+   * and circumnavigate it from that node
+   * @param pathNodes path that ends in a node for which isFree holds. The circumnavigation is appended to it
+   */
+  void circumnavigate(std::list<gridNode_t> &pathNodes);
+
+  /**
+   * Same as above, appending the circumnavigation to a caller-owned path in place
+   */
+  void circumnavigate(std::vector<Point_t> &path);
+
+private:
+  enum
+  {
+    eCellPartial = 0,
+    eCellFree = 1,
+    eCellCovered = 2
+  };
+
+  /**
+   * Depth-first search over the free mega-cells from start, storing the tree edges in edges_
+   * @return number of mega-cells in the tree
+   */
+  int buildTree(int start);
+
+  int cols_, rows_;
+  std::vector<unsigned char> cells_;
+  std::vector<unsigned char> edges_;  // Tree edges of each mega-cell, one bit per direction
+};
+
+/**
+ * View for the spiral in between spanning trees: the nodes of the free mega-cells that are not covered yet
+ * appear visited, so the spiral leaves them to be circumnavigated
+ */
+template <class View>
+class SpanningTreeSpiralView
+{
+public:
+  SpanningTreeSpiralView(View const &view, SpanningTreeCoverage const &tree) : view_(view), tree_(&tree)
+  {
+  }
+
+  int width() const
+  {
+    return view_.width();
+  }
+
+  int height() const
+  {
+    return view_.height();
+  }
+
+  bool blocked(int x, int y) const
+  {
+    return view_.blocked(x, y);
+  }
+
+  bool visited(int x, int y) const
+  {
+    return view_.visited(x, y) || tree_->isFree(x, y);
+  }
+
+  void mark(int x, int y) const
+  {
+    view_.mark(x, y);
+  }
+
+private:
+  View view_;
+  SpanningTreeCoverage const *tree_;
+};
+}  // namespace full_coverage_path_planner
+#endif  // FULL_COVERAGE_PATH_PLANNER_SPANNING_TREE_COVERAGE_H
@@ -1,7 +1,9 @@
 //
 // Copyright [2020] Nobleo Technology"  [legal/copyright]
 //
+#include <cstddef>
 #include <list>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -12,6 +14,7 @@
 #include <nav_core/base_global_planner.h>
 #include <nav_msgs/Path.h>
 #include <nav_msgs/GetMap.h>
+#include <nav_msgs/OccupancyGrid.h>
 #include <geometry_msgs/PoseStamped.h>
 #include <angles/angles.h>
 #include <base_local_planner/world_model.h>
@@ -24,11 +27,58 @@ using std::string;
 #define FULL_COVERAGE_PATH_PLANNER_SPIRAL_STC_H
 
 #include "full_coverage_path_planner/full_coverage_path_planner.h"
+
+/** Search used by spiral_stc to get from the end of a spiral to the closest uncovered node */
+enum
+{
+  eSearchAStar = 0,
+  eSearchHierarchical = 1,
+  eSearchJumpPoint = 2,
+  eSearchTurnAware = 3,
+};
+
+/** How spiral_stc covers the open space it gets to */
+enum
+{
+  eCoverageSpiral = 0,
+  eCoverageSpanningTree = 1,
+};
+
 namespace full_coverage_path_planner
 {
 class SpiralSTC : public nav_core::BaseGlobalPlanner, private full_coverage_path_planner::FullCoveragePathPlanner
 {
 public:
+  struct spiral_stc_options_type
+  {
+    spiral_stc_options_type()
+      : search(eSearchAStar), cluster_size(32), threads(1), region_size(64), tour_time_budget(1.0),
+        coverage(eCoverageSpiral), heading(eDirUp), candidates(1), cost_per_step(1.0), cost_per_turn(1.0),
+        cost_per_revisit(0.0), turn_cost(1.0), costs(NULL), reachable_only(false)
+    {
+    }
+
+    int search;  // One of eSearchAStar, eSearchHierarchical, eSearchJumpPoint, eSearchTurnAware
+    int cluster_size;  // Side of a cluster in nodes, used by eSearchHierarchical
+    int threads;  // Threads used by spiral_stc_regions, 0 for one per hardware thread
+    int region_size;  // Side of the blocks that spiral_stc_regions decomposes the grid into, in nodes
+    double tour_time_budget;  // Seconds spiral_stc_regions may spend on improving the order of the regions
+    int coverage;  // One of eCoverageSpiral, eCoverageSpanningTree
+    int heading;  // Direction of the first step of the first spiral, one of eDirRight, eDirUp, eDirLeft, eDirDown
+    int candidates;  // Plans spiral_stc_multi_start chooses from
+    double cost_per_step;  // Cost model of spiral_stc_multi_start: weight of the path length
+    double cost_per_turn;  // Weight of the number of turns, see count_turns
+    double cost_per_revisit;  // Weight of the number of steps onto nodes that were covered before
+    double turn_cost;  // Cost of a 90 degree turn for eSearchTurnAware, in steps
+    // Traversal cost of each node, or NULL if all free nodes cost the same. With costs, the spiral goes to the
+    // cheapest open neighbor and dial_to_open_space is used for backtracking, whatever the search option
+    CostGrid const *costs;
+    // Only read the nodes that can be reached from init, for views that evaluate a node when it is first read: the
+    // component of init is found with a flood fill from init, and unreachable_counter is not counted. The hierarchical
+    // search, spiral_stc_regions and spiral_stc_multi_start still read every node
+    bool reachable_only;
+  };
+
   /**
    * Find a path that spirals inwards from init until an obstacle is seen in the grid
    * @param grid 2D grid of bools. true == occupied/blocked/obstacle
@@ -52,6 +102,180 @@ public:
                                         int &multiple_pass_counter,
                                         int &visited_counter);
 
+  /**
+   * Perform Spiral-STC coverage path planning, restricted to the connected component of free space containing init.
+   * Planning stops as soon as that component is fully covered, instead of letting A* exhaust the reachable region
+   * before resigning.
+   * @param grid
+   * @param init
+   * @param multiple_pass_counter
+   * @param visited_counter
+   * @param unreachable_counter number of free nodes that cannot be reached from init
+   * @return
+   */
+  static std::list<Point_t> spiral_stc(std::vector<std::vector<bool> > const &grid,
+                                        Point_t &init,
+                                        int &multiple_pass_counter,
+                                        int &visited_counter,
+                                        int &unreachable_counter);
+
+  /**
+   * Perform Spiral-STC coverage path planning with non-default options
+   * @param grid
+   * @param init
+   * @param multiple_pass_counter
+   * @param visited_counter
+   * @param unreachable_counter number of free nodes that cannot be reached from init
+   * @param options selects the search used for backtracking
+   * @return
+   */
+  static std::list<Point_t> spiral_stc(std::vector<std::vector<bool> > const &grid,
+                                        Point_t &init,
+                                        int &multiple_pass_counter,
+                                        int &visited_counter,
+                                        int &unreachable_counter,
+                                        spiral_stc_options_type const &options);
+
+  /*
+   * The functions below take a View, which is any type of the GridView concept in grid_view.h.
+   * The functions above are thin wrappers around these, through a NestedVectorView.
+   * They are explicitly instantiated in spiral_stc.cpp for the same adapters as the functions in common.h.
+   */
+
+  /**
+   * Find a path that spirals inwards from init until a blocked or visited node is seen, marking it in view
+   * @param heading direction of the first step if init is a single node, one of eDirRight, eDirUp, eDirLeft, eDirDown
+   * @param costs if not NULL, go to the cheapest open neighbor instead of the first one in spiral order
+   */
+  template <class View>
+  static std::list<gridNode_t> spiral(View const &view, std::list<gridNode_t> &init, int heading = eDirUp,
+                                      CostGrid const *costs = NULL);
+
+  /**
+   * Spiral inwards from the last node of path until a blocked or visited node is seen, marking it in view.
+   * The spiral is appended to path in place, so no node is allocated or copied on its own
+   * @param path caller-owned path, best reserved up front. Its nodes from begin on lead into the spiral
+   * @param begin if path has two nodes or more from begin, the spiral turns from the direction of the last step,
+   * otherwise its first step is in heading
+   */
+  template <class View>
+  static void spiral(View const &view, std::vector<Point_t> &path, std::size_t begin, int heading = eDirUp,
+                     CostGrid const *costs = NULL);
+
+  /**
+   * Perform Spiral-STC coverage path planning on view.
+   * Nodes that are already marked visited in view count as covered, and on return all covered nodes are marked.
+   * With options.coverage eCoverageSpanningTree, the free 2x2 mega-cells are covered by SpanningTreeCoverage
+   * without passing any node twice, and the spiral only fills the partially occupied mega-cells in between.
+   * @param view map and visited state
+   * @param init
+   * @param multiple_pass_counter
+   * @param visited_counter
+   * @param unreachable_counter number of free nodes that cannot be reached from init
+   * @param options selects the search used for backtracking and the coverage of open space
+   * @return
+   */
+  template <class View>
+  static std::list<Point_t> spiral_stc(View const &view,
+                                        Point_t &init,
+                                        int &multiple_pass_counter,
+                                        int &visited_counter,
+                                        int &unreachable_counter,
+                                        spiral_stc_options_type const &options);
+
+  /**
+   * Perform Spiral-STC coverage path planning on view, appending the plan to a caller-owned path in place.
+   * The spirals, the spanning tree circumnavigations and A* write straight into path, so the nodes are neither
+   * allocated one by one nor copied between lists; the list-based spiral_stc is a wrapper around this one.
+   * The plan is the same as that of the list-based spiral_stc
+   * @param path Output, the plan is appended. Best reserved up front, for example for the number of free nodes
+   */
+  template <class View>
+  static void spiral_stc(View const &view,
+                         Point_t &init,
+                         std::vector<Point_t> &path,
+                         int &multiple_pass_counter,
+                         int &visited_counter,
+                         int &unreachable_counter,
+                         spiral_stc_options_type const &options);
+
+  /**
+   * Perform Spiral-STC coverage path planning on view, appending the plan to a CompactPath.
+   * The nodes are moved into path after every step to open space, so only the nodes of one step are held as points.
+   * The plan is the same as that of the other spiral_stc
+   * @param path Output, the plan is appended
+   */
+  template <class View>
+  static void spiral_stc(View const &view,
+                         Point_t &init,
+                         CompactPath &path,
+                         int &multiple_pass_counter,
+                         int &visited_counter,
+                         int &unreachable_counter,
+                         spiral_stc_options_type const &options);
+
+  /**
+   * Perform Spiral-STC coverage path planning on regions of view in parallel.
+   * The free space is decomposed into regions of at most options.region_size squared nodes (see label_block_regions).
+   * Each region reachable from init is covered by spiral_stc on its own, concurrently on options.threads threads.
+   * The region plans are then chained with a shortest path between them, in the order found by a RegionTour:
+   * nearest neighbor improved by 2-opt and Or-opt within options.tour_time_budget.
+   * Because every region is covered completely, so is the whole reachable space.
+   * The result does not depend on the number of threads, as long as the ordering finishes within its time budget.
+   * @param view map and visited state. Regions of which every node was visited before are skipped, unless init is in
+   * one, and the spirals of the other regions start from what was visited
+   * @param init
+   * @param multiple_pass_counter
+   * @param visited_counter
+   * @param unreachable_counter number of free nodes that cannot be reached from init
+   * @param saved_transit_counter estimated transit between regions saved by the improved order,
+   * compared to the nearest neighbor order, in nodes
+   * @param options threads, region_size and tour_time_budget configure the decomposition,
+   * the other options are used for each region
+   * @return
+   */
+  template <class View>
+  static std::list<Point_t> spiral_stc_regions(View const &view,
+                                                Point_t &init,
+                                                int &multiple_pass_counter,
+                                                int &visited_counter,
+                                                int &unreachable_counter,
+                                                int &saved_transit_counter,
+                                                spiral_stc_options_type const &options);
+
+  /**
+   * Plan options.candidates times with spiral_stc, concurrently on options.threads threads, and return the plan
+   * with the lowest cost: options.cost_per_step * steps + options.cost_per_turn * turns
+   * + options.cost_per_revisit * multiple_pass_counter.
+   * The candidates start with each of the four headings, from init first and then from the open nodes closest to it,
+   * which are reached along a shortest path from init. The first candidate is the plan of spiral_stc with options.
+   * Ties are broken in favor of the earlier candidate, so the result does not depend on the number of threads.
+   * With at least as many threads as candidates, this takes about as long as a single plan.
+   * @param view map and visited state. Nodes that are already marked visited in view count as covered,
+   * and on return all covered nodes are marked
+   * @param init
+   * @param multiple_pass_counter
+   * @param visited_counter
+   * @param unreachable_counter number of free nodes that cannot be reached from init
+   * @param options candidates, threads and the cost model configure the evaluation,
+   * the other options are used for each candidate
+   * @return
+   */
+  template <class View>
+  static std::list<Point_t> spiral_stc_multi_start(View const &view,
+                                                    Point_t &init,
+                                                    int &multiple_pass_counter,
+                                                    int &visited_counter,
+                                                    int &unreachable_counter,
+                                                    spiral_stc_options_type const &options);
+
+  /**
+   * @brief  Initialization without nav_core, for example in a nodelet
+   * @param  nh node handle for the map service and the coverage grid
+   * @param  private_named_nh node handle for the parameters and the published plans
+   */
+  void initialize(ros::NodeHandle& nh, ros::NodeHandle& private_named_nh);
+
 private:
   /**
    * @brief Given a goal pose in the world, compute a plan
@@ -69,6 +293,29 @@ private:
    * @param  costmap A pointer to the ROS wrapper of the costmap to use for planning
    */
   void initialize(std::string name, costmap_2d::Costmap2DROS* costmap_ros);
+
+  /**
+   * Keep the latest coverage grid, to resume the coverage from
+   */
+  void coverageGridCallback(const nav_msgs::OccupancyGrid::ConstPtr& coverage_grid);
+
+  /**
+   * Plan the coverage of view for makePlan: skip the tiles of the latest coverage grid, and cover the rest with
+   * spiral_stc, spiral_stc_multi_start or spiral_stc_regions, as the options say. Fills in spiral_cpp_metrics_
+   * @param goalPoints Output, the coverage path
+   * @return whether the path was planned in regions, by spiral_stc_regions
+   */
+  template <class View>
+  bool coverView(View const& view, Point_t startPoint, spiral_stc_options_type const& options,
+                 CompactPath& goalPoints);
+
+  spiral_stc_options_type spiral_stc_options_;
+  bool cost_aware_;  // Plan with the costs of the tiles, see spiral_stc_options_type::costs
+  bool lazy_occupancy_;  // Plan on a LazyOccupancyGrid instead of parsing the whole map, unless cost_aware_
+  float covered_fraction_;  // Fraction of the coverage cells of a tile that must be covered to skip the tile
+  ros::Subscriber coverage_grid_sub_;
+  nav_msgs::OccupancyGrid::ConstPtr coverage_grid_;
+  std::mutex coverage_grid_mutex_;
 };
 
 }  // namespace full_coverage_path_planner
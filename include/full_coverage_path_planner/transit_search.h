@@ -0,0 +1,47 @@
+//
+// Copyright [2020] Nobleo Technology"  [legal/copyright]
+//
+#include <list>
+
+#ifndef FULL_COVERAGE_PATH_PLANNER_TRANSIT_SEARCH_H
+#define FULL_COVERAGE_PATH_PLANNER_TRANSIT_SEARCH_H
+
+#include "full_coverage_path_planner/common.h"
+
+namespace full_coverage_path_planner
+{
+/**
+ * Shortest paths between two given nodes, for the transits between the parts of a coverage plan.
+ * Keeps its own packed copy of the obstacles, and a layer in which only the node to go to is open,
+ * so jps_to_open_space finds the shortest path to exactly that node.
+ */
+class TransitSearch
+{
+public:
+  template <class View>
+  explicit TransitSearch(View const &view)
+    : obstacles_(view.width(), view.height(), false),
+      target_(view.width(), view.height(), eNodeVisited)
+  {
+    for (int iy = 0; iy < view.height(); ++iy)
+    {
+      for (int ix = 0; ix < view.width(); ++ix)
+      {
+        obstacles_.set(ix, iy, view.blocked(ix, iy));
+      }
+    }
+  }
+
+  /**
+   * Extend path from its last node to 'to' along a shortest path
+   * @param to node to go to, must be reachable from the last node of path
+   * @param path non-empty path to extend. The nodes after its last one up to and including 'to' are appended
+   * @return whether we resign from finding a path or not. true is we resign and false if we found a path
+   */
+  bool appendPath(Point_t to, std::list<Point_t> &path);
+
+private:
+  RowMajorGrid obstacles_, target_;
+};
+}  // namespace full_coverage_path_planner
+#endif  // FULL_COVERAGE_PATH_PLANNER_TRANSIT_SEARCH_H
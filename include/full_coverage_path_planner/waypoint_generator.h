@@ -0,0 +1,74 @@
+//
+// Copyright [2020] Nobleo Technology"  [legal/copyright]
+//
+#include <cstddef>
+
+#include <geometry_msgs/PoseStamped.h>
+
+#ifndef FULL_COVERAGE_PATH_PLANNER_WAYPOINT_GENERATOR_H
+#define FULL_COVERAGE_PATH_PLANNER_WAYPOINT_GENERATOR_H
+
+#include "full_coverage_path_planner/common.h"
+#include "full_coverage_path_planner/compact_path.h"
+
+namespace full_coverage_path_planner
+{
+/**
+ * Yields the poses of a plan one at a time, without building the whole plan first.
+ * The plan starts with the start pose. If the first point of the path is not at the start, it continues with the
+ * start pose and that point, both facing from one to the other. Then come the points of the path where the
+ * direction of movement changes, and the first and the last point. Each point after the first is preceded by the
+ * previous one turned to the new direction, so a robot that follows the plan strictly turns in place.
+ * The path must outlive the generator.
+ */
+class WaypointGenerator
+{
+public:
+  /**
+   * @param start Start pose of robot
+   * @param path coverage path on the grid
+   * @param tile_size size of a grid point, in meters
+   * @param grid_origin position of the corner of grid point (0, 0)
+   */
+  WaypointGenerator(geometry_msgs::PoseStamped const& start, CompactPath const& path, float tile_size,
+                    fPoint_t grid_origin);
+
+  /**
+   * @param pose Output, the next pose of the plan
+   * @return false if the plan is done
+   */
+  bool next(geometry_msgs::PoseStamped& pose);
+
+  /**
+   * Number of poses in the whole plan, found from the runs of the path without building the poses
+   */
+  std::size_t size() const;
+
+private:
+  /**
+   * Queue the poses to get to point, moving into it in move_dir (see eDirRight etc.)
+   */
+  void addGoal(Point_t const& point, int move_dir);
+
+  /**
+   * Queue the poses up to the next point where the direction of movement changes
+   * @return false if there are none left
+   */
+  bool advance();
+
+  geometry_msgs::PoseStamped pose(Point_t const& point) const;
+
+  CompactPath const& path_;
+  float tile_size_;
+  fPoint_t grid_origin_;
+  CompactPath::RunReader runs_;
+  int move_dir_prev_;
+  Point_t last_;
+  bool finished_, off_start_;
+  int orientation_;  // Index of the current orientation in the lookup table
+  geometry_msgs::PoseStamped previous_goal_;
+  geometry_msgs::PoseStamped queue_[4];
+  int queued_, dequeued_;
+};
+}  // namespace full_coverage_path_planner
+#endif  // FULL_COVERAGE_PATH_PLANNER_WAYPOINT_GENERATOR_H
@@ -0,0 +1,57 @@
+//
+// Copyright [2020] Nobleo Technology"  [legal/copyright]
+//
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifndef FULL_COVERAGE_PATH_PLANNER_WORK_STEALING_POOL_H
+#define FULL_COVERAGE_PATH_PLANNER_WORK_STEALING_POOL_H
+
+namespace full_coverage_path_planner
+{
+/**
+ * Runs a batch of independent tasks on a number of threads.
+ * Each thread takes tasks from the back of its own queue and, once that is empty,
+ * steals from the front of the queues of the other threads, so a few expensive tasks do not stall the batch.
+ */
+class WorkStealingPool
+{
+public:
+  /**
+   * @param threads number of threads to run on, including the calling thread. 0 for one per hardware thread
+   */
+  explicit WorkStealingPool(int threads);
+
+  int threadCount() const
+  {
+    return queues_.size();
+  }
+
+  /**
+   * Run task(i) for each i in [0, count) and wait until all of them are done.
+   * The worker threads are started for each batch; the calling thread is one of them.
+   * If a task throws, the remaining tasks are still run and the first exception is rethrown afterwards.
+   */
+  void run(int count, std::function<void(int)> const &task);
+
+private:
+  typedef struct
+  {
+    std::mutex mutex;
+    std::deque<int> tasks;
+  }
+  queue_t;
+
+  void work(int worker, std::function<void(int)> const &task);
+
+  bool pop(int worker, int &task);
+
+  bool steal(int worker, int &task);
+
+  std::vector<std::unique_ptr<queue_t> > queues_;
+};
+}  // namespace full_coverage_path_planner
+#endif  // FULL_COVERAGE_PATH_PLANNER_WORK_STEALING_POOL_H
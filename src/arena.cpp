@@ -0,0 +1,40 @@
+//
+// Copyright [2020] Nobleo Technology"  [legal/copyright]
+//
+#include <algorithm>
+#include <new>
+
+#include "full_coverage_path_planner/arena.h"
+
+Arena::Arena(std::size_t block_size) : block_size_(block_size), block_(0), offset_(0)
+{
+}
+
+Arena::~Arena()
+{
+  for (std::size_t i = 0; i < blocks_.size(); ++i)
+  {
+    ::operator delete(blocks_[i].data);
+  }
+}
+
+void* Arena::allocateFromNextBlock(std::size_t bytes, std::size_t alignment)
+{
+  // Blocks that were released are used again before new ones are added. Memory at the end of a block that is too
+  // small is left unused until the next release
+  for (++block_; block_ < blocks_.size(); ++block_)
+  {
+    if (bytes + alignment <= blocks_[block_].size)
+    {
+      offset_ = 0;
+      return allocate(bytes, alignment);
+    }
+  }
+  std::size_t size = blocks_.empty() ? block_size_ : 2 * blocks_.back().size;
+  block_t block = { static_cast<char*>(::operator new(std::max(size, bytes + alignment))),  // NOLINT
+                    std::max(size, bytes + alignment) };
+  blocks_.push_back(block);
+  block_ = blocks_.size() - 1;
+  offset_ = 0;
+  return allocate(bytes, alignment);
+}
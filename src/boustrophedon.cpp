@@ -0,0 +1,383 @@
+//
+// Copyright [2020] Nobleo Technology"  [legal/copyright]
+//
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "full_coverage_path_planner/boustrophedon.h"
+#include "full_coverage_path_planner/transit_search.h"
+#include <pluginlib/class_list_macros.h>
+
+// register this planner as a BaseGlobalPlanner plugin
+PLUGINLIB_EXPORT_CLASS(full_coverage_path_planner::Boustrophedon, nav_core::BaseGlobalPlanner)
+
+namespace full_coverage_path_planner
+{
+void Boustrophedon::initialize(std::string name, costmap_2d::Costmap2DROS* costmap_ros)
+{
+  ros::NodeHandle nh, private_named_nh("~/" + name);
+  initialize(nh, private_named_nh);
+}
+
+void Boustrophedon::initialize(ros::NodeHandle& nh, ros::NodeHandle& private_named_nh)
+{
+  if (!initialized_)
+  {
+    // Create a publisher to visualize the plan
+    plan_pub_ = private_named_nh.advertise<nav_msgs::Path>("plan", 1);
+    compact_plan_pub_ = private_named_nh.advertise<CompactPlan>("compact_plan", 1);
+    // Try to request the cpp-grid from the cpp_grid map_server
+    cpp_grid_client_ = nh.serviceClient<nav_msgs::GetMap>("static_map");
+
+    // Define  robot radius (radius) parameter
+    float robot_radius_default = 0.5f;
+    private_named_nh.param<float>("robot_radius", robot_radius_, robot_radius_default);
+    // Define  tool radius (radius) parameter
+    float tool_radius_default = 0.5f;
+    private_named_nh.param<float>("tool_radius", tool_radius_, tool_radius_default);
+    // Define the shape of the robot that is checked for collisions: a square that fits the robot, or its disk
+    std::string footprint;
+    private_named_nh.param<std::string>("footprint", footprint, "square");
+    circular_footprint_ = (footprint == "circular");
+    if (footprint != "circular" && footprint != "square")
+    {
+      ROS_WARN("Unknown footprint '%s', using 'square'", footprint.c_str());
+    }
+    // Define the parameters of the execution time estimate
+    private_named_nh.param<float>("linear_velocity", linear_velocity_, 0.2f);
+    private_named_nh.param<float>("turn_duration", turn_duration_, 2.0f);
+    // Restrict the coverage to a zone of the map
+    initializeZones(private_named_nh);
+    initialized_ = true;
+  }
+}
+
+std::list<Point_t> Boustrophedon::boustrophedon(std::vector<std::vector<bool> > const& grid,
+                                                Point_t& init,
+                                                int &multiple_pass_counter,
+                                                int &visited_counter,
+                                                int &unreachable_counter)
+{
+  std::vector<std::vector<bool> > visited(grid.size(), std::vector<bool>(grid[0].size(), eNodeOpen));
+  return boustrophedon(NestedVectorView(grid, visited), init, multiple_pass_counter, visited_counter,
+                       unreachable_counter);
+}
+
+/**
+ * A cell of the boustrophedon decomposition: one interval of free nodes [y0, y1] for each column from x0 on
+ */
+typedef struct
+{
+  int x0;
+  std::vector<std::pair<int, int> > spans;
+}
+cell_t;
+
+/**
+ * A straight lane from one node to another, covered in either direction
+ */
+typedef struct
+{
+  Point_t a, b;
+}
+lane_t;
+
+/**
+ * Lanes that cover a cell, along x or along y, in the order in which they are swept
+ */
+static std::vector<lane_t> cellLanes(cell_t const& cell, bool along_x)
+{
+  std::vector<lane_t> lanes;
+  int nSpans = cell.spans.size();
+  if (!along_x)
+  {
+    for (int i = 0; i < nSpans; ++i)
+    {
+      lane_t lane = { { cell.x0 + i, cell.spans[i].first }, { cell.x0 + i, cell.spans[i].second } };  // NOLINT
+      lanes.push_back(lane);
+    }
+    return lanes;
+  }
+
+  int y_min = INT_MAX, y_max = INT_MIN;
+  for (int i = 0; i < nSpans; ++i)
+  {
+    y_min = std::min(y_min, cell.spans[i].first);
+    y_max = std::max(y_max, cell.spans[i].second);
+  }
+  for (int y = y_min; y <= y_max; ++y)
+  {
+    // A row of a cell can consist of several intervals if the cell bends around an obstacle
+    int start = -1;
+    for (int i = 0; i <= nSpans; ++i)
+    {
+      bool inside = i < nSpans && cell.spans[i].first <= y && y <= cell.spans[i].second;
+      if (inside && start < 0)
+      {
+        start = i;
+      }
+      else if (!inside && start >= 0)
+      {
+        lane_t lane = { { cell.x0 + start, y }, { cell.x0 + i - 1, y } };  // NOLINT
+        lanes.push_back(lane);
+        start = -1;
+      }
+    }
+  }
+  return lanes;
+}
+
+/**
+ * Find where to enter a cell coming from 'from': the first or the last lane, at either of its ends
+ * @param reverse Output, whether to sweep the lanes in reverse order
+ * @param flip Output, whether to start the first lane at its end b
+ * @return Manhattan distance from 'from' to the entry
+ */
+static int closestEntry(std::vector<lane_t> const& lanes, Point_t from, bool& reverse, bool& flip)
+{
+  int best = INT_MAX;
+  for (int r = 0; r < 2; ++r)
+  {
+    lane_t const& lane = r ? lanes.back() : lanes.front();
+    for (int f = 0; f < 2; ++f)
+    {
+      Point_t entry = f ? lane.b : lane.a;
+      int distance = abs(entry.x - from.x) + abs(entry.y - from.y);
+      if (distance < best)
+      {
+        best = distance;
+        reverse = r;
+        flip = f;
+      }
+    }
+  }
+  return best;
+}
+
+template <class View>
+std::list<Point_t> Boustrophedon::boustrophedon(View const& view,
+                                                Point_t& init,
+                                                int &multiple_pass_counter,
+                                                int &visited_counter,
+                                                int &unreachable_counter)
+{
+  int nRows = view.height(), nCols = view.width();
+  unreachable_counter = 0;
+
+  // Only cover the free space that can be reached from init
+  std::vector<int> components;
+  label_connected_components(view, components);
+  int init_component = components[init.y * nCols + init.x];
+  for (int i = 0; i < components.size(); ++i)
+  {
+    if (components[i] >= 0 && components[i] != init_component)
+    {
+      unreachable_counter++;
+    }
+  }
+
+  // Boustrophedon decomposition: a free interval of a column continues the cell of the interval of the previous column
+  // it overlaps with, unless either of them overlaps with more than one interval (the sweep line splits or merges)
+  std::vector<cell_t> cells;
+  std::vector<std::pair<int, int> > prev_spans, spans;
+  std::vector<int> prev_cells, span_cells;
+  for (int ix = 0; ix < nCols; ++ix)
+  {
+    spans.clear();
+    for (int iy = 0; iy < nRows; ++iy)
+    {
+      if (init_component >= 0 && components[iy * nCols + ix] == init_component)
+      {
+        if (spans.empty() || spans.back().second != iy - 1)
+        {
+          spans.push_back(std::make_pair(iy, iy));
+        }
+        else
+        {
+          spans.back().second = iy;
+        }
+      }
+    }
+
+    std::vector<int> overlaps(spans.size(), 0), prev_overlaps(prev_spans.size(), 0), match(spans.size(), -1);
+    for (int i = 0; i < spans.size(); ++i)
+    {
+      for (int j = 0; j < prev_spans.size(); ++j)
+      {
+        if (spans[i].first <= prev_spans[j].second && prev_spans[j].first <= spans[i].second)
+        {
+          overlaps[i]++;
+          prev_overlaps[j]++;
+          match[i] = j;
+        }
+      }
+    }
+    span_cells.assign(spans.size(), -1);
+    for (int i = 0; i < spans.size(); ++i)
+    {
+      if (overlaps[i] == 1 && prev_overlaps[match[i]] == 1)
+      {
+        span_cells[i] = prev_cells[match[i]];
+      }
+      else
+      {
+        cell_t cell;
+        cell.x0 = ix;
+        span_cells[i] = cells.size();
+        cells.push_back(cell);
+      }
+      cells[span_cells[i]].spans.push_back(spans[i]);
+    }
+    prev_spans.swap(spans);
+    prev_cells.swap(span_cells);
+  }
+
+  // Sweep each cell in the direction that needs the fewest lanes
+  std::vector<std::vector<lane_t> > cell_lanes(cells.size());
+  for (int c = 0; c < cells.size(); ++c)
+  {
+    std::vector<lane_t> along_y = cellLanes(cells[c], false), along_x = cellLanes(cells[c], true);
+    cell_lanes[c] = (along_x.size() < along_y.size()) ? along_x : along_y;
+  }
+
+  TransitSearch transits(view);
+  std::list<Point_t> fullPath;
+  fullPath.push_back(init);
+  std::vector<bool> done(cells.size(), false);
+  for (int n = 0; n < cells.size(); ++n)
+  {
+    // Go to the closest cell that is not covered yet
+    int next = -1, next_distance = INT_MAX;
+    bool reverse = false, flip = false;
+    for (int c = 0; c < cells.size(); ++c)
+    {
+      bool r, f;
+      int distance = done[c] ? INT_MAX : closestEntry(cell_lanes[c], fullPath.back(), r, f);
+      if (distance < next_distance)
+      {
+        next = c;
+        next_distance = distance;
+        reverse = r;
+        flip = f;
+      }
+    }
+    done[next] = true;
+
+    std::vector<lane_t>& lanes = cell_lanes[next];
+    if (reverse)
+    {
+      std::reverse(lanes.begin(), lanes.end());
+    }
+    for (int i = 0; i < lanes.size(); ++i)
+    {
+      // Start each lane at the end closest to where the previous one ended
+      Point_t current = fullPath.back();
+      lane_t lane = lanes[i];
+      bool lane_flip = (i == 0) ? flip : (abs(lane.b.x - current.x) + abs(lane.b.y - current.y) <
+                                          abs(lane.a.x - current.x) + abs(lane.a.y - current.y));
+      if (lane_flip)
+      {
+        std::swap(lane.a, lane.b);
+      }
+      transits.appendPath(lane.a, fullPath);
+      int dx = (lane.b.x > lane.a.x) - (lane.b.x < lane.a.x);
+      int dy = (lane.b.y > lane.a.y) - (lane.b.y < lane.a.y);
+      for (Point_t p = lane.a; p.x != lane.b.x || p.y != lane.b.y;)
+      {
+        p.x += dx;
+        p.y += dy;
+        fullPath.push_back(p);
+      }
+    }
+  }
+
+  count_path_visits(fullPath, nCols, nRows, visited_counter, multiple_pass_counter);
+  return fullPath;
+}
+
+/*
+ * Explicit instantiations for each of the supported grid views
+ */
+#define FCPP_INSTANTIATE_BOUSTROPHEDON(View)                                                                       \
+  template std::list<Point_t> Boustrophedon::boustrophedon(View const &view, Point_t &init,                        \
+                                                           int &multiple_pass_counter, int &visited_counter,       \
+                                                           int &unreachable_counter);
+
+FCPP_INSTANTIATE_BOUSTROPHEDON(NestedVectorView)
+FCPP_INSTANTIATE_BOUSTROPHEDON(BitsetView)
+FCPP_INSTANTIATE_BOUSTROPHEDON(TiledView8)
+FCPP_INSTANTIATE_BOUSTROPHEDON(TiledView64)
+FCPP_INSTANTIATE_BOUSTROPHEDON(CostmapView<253>)
+FCPP_INSTANTIATE_BOUSTROPHEDON(CostmapView<254>)
+
+bool Boustrophedon::makePlan(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal,
+                             std::vector<geometry_msgs::PoseStamped>& plan)
+{
+  if (!initialized_)
+  {
+    ROS_ERROR("This planner has not been initialized yet, but it is being used, please call initialize() before use");
+    return false;
+  }
+
+  clock_t begin = clock();
+  Point_t startPoint;
+
+  /********************** Get grid from server **********************/
+  std::vector<std::vector<bool> > grid;
+  nav_msgs::GetMap grid_req_srv;
+  ROS_INFO("Requesting grid!!");
+  if (!cpp_grid_client_.call(grid_req_srv))
+  {
+    ROS_ERROR("Could not retrieve grid from map_server");
+    return false;
+  }
+
+  if (!parseGrid(grid_req_srv.response.map, grid, robot_radius_ * 2, tool_radius_ * 2, start, startPoint))
+  {
+    ROS_ERROR("Could not parse retrieved grid");
+    return false;
+  }
+
+  CompactPath goalPoints(boustrophedon(grid,
+                                       startPoint,
+                                       spiral_cpp_metrics_.multiple_pass_counter,
+                                       spiral_cpp_metrics_.visited_counter,
+                                       spiral_cpp_metrics_.unreachable_counter));
+  ROS_INFO("boustrophedon cpp completed!");
+  ROS_INFO("Converting path to plan");
+
+  parsePointlist2Plan(start, goalPoints, plan);
+  // Print some metrics:
+  spiral_cpp_metrics_.accessible_counter = spiral_cpp_metrics_.visited_counter
+                                            - spiral_cpp_metrics_.multiple_pass_counter;
+  spiral_cpp_metrics_.total_area_covered = (4.0 * tool_radius_ * tool_radius_) * spiral_cpp_metrics_.accessible_counter;
+  spiral_cpp_metrics_.total_area_unreachable = (4.0 * tool_radius_ * tool_radius_)
+                                                * spiral_cpp_metrics_.unreachable_counter;
+  updateExecutionMetrics(goalPoints);
+  ROS_INFO("Total visited: %d", spiral_cpp_metrics_.visited_counter);
+  ROS_INFO("Total re-visited: %d", spiral_cpp_metrics_.multiple_pass_counter);
+  ROS_INFO("Total accessible cells: %d", spiral_cpp_metrics_.accessible_counter);
+  ROS_INFO("Total accessible area: %f", spiral_cpp_metrics_.total_area_covered);
+  ROS_INFO("Total unreachable cells: %d", spiral_cpp_metrics_.unreachable_counter);
+  ROS_INFO("Total unreachable area: %f", spiral_cpp_metrics_.total_area_unreachable);
+  ROS_INFO("Total turns: %d", spiral_cpp_metrics_.turn_counter);
+  ROS_INFO("Estimated execution time: %f s", spiral_cpp_metrics_.estimated_execution_time);
+
+  ROS_INFO("Publishing plan!");
+  publishPlan(plan);
+  publishCompactPlan(start, goalPoints);
+  ROS_INFO("Plan published!");
+
+  clock_t end = clock();
+  double elapsed_secs = static_cast<double>(end - begin) / CLOCKS_PER_SEC;
+  std::cout << "elapsed time: " << elapsed_secs << "\n";
+
+  return true;
+}
+}  // namespace full_coverage_path_planner
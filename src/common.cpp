@@ -2,12 +2,19 @@
 // Copyright [2020] Nobleo Technology"  [legal/copyright]
 //
 #include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
 #include <iostream>
 #include <limits>
 #include <list>
+#include <queue>
+#include <utility>
 #include <vector>
 
 #include <full_coverage_path_planner/common.h>
+#include <full_coverage_path_planner/lazy_occupancy_grid.h>
+#include <full_coverage_path_planner/mapped_grid.h>
 
 int distanceToClosestPoint(Point_t poi, std::list<Point_t> const& goals)
 {
@@ -49,31 +56,347 @@ int distanceSquared(const Point_t& p1, const Point_t& p2)
   return d2;
 }
 
+int count_turns(std::list<Point_t> const& path)
+{
+  int turns = 0, dir_prev = 0;
+  std::list<Point_t>::const_iterator it = path.begin(), prev = it;
+  for (++it; prev != path.end() && it != path.end(); prev = it++)
+  {
+    int dir = (it->x - prev->x) + 2 * (it->y - prev->y);  // dx + 2 * dy, like the eDir* directions
+    if (dir == 0)
+    {
+      continue;
+    }
+    if (dir_prev != 0 && dir != dir_prev)
+    {
+      turns += (dir == -dir_prev) ? 2 : 1;
+    }
+    dir_prev = dir;
+  }
+  return turns;
+}
+
+void count_path_visits(std::list<Point_t> const& path, int nCols, int nRows,
+                       int &visited_counter, int &multiple_pass_counter)
+{
+  visited_counter = 0;
+  multiple_pass_counter = 0;
+  RowMajorGrid covered(nCols, nRows, eNodeOpen);
+  std::list<Point_t>::const_iterator prev = path.end();
+  for (std::list<Point_t>::const_iterator it = path.begin(); it != path.end(); prev = it++)
+  {
+    if (prev != path.end() && prev->x == it->x && prev->y == it->y)
+    {
+      continue;
+    }
+    visited_counter++;
+    if (covered.get(it->x, it->y))
+    {
+      multiple_pass_counter++;
+    }
+    covered.set(it->x, it->y, eNodeVisited);
+  }
+}
+
+bool point_in_polygon(fPoint_t const& point, std::vector<fPoint_t> const& polygon)
+{
+  // Count the edges that cross the horizontal ray from point towards +x
+  bool inside = false;
+  for (int i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++)
+  {
+    fPoint_t const& a = polygon[i];
+    fPoint_t const& b = polygon[j];
+    if ((a.y > point.y) != (b.y > point.y) && point.x < a.x + (point.y - a.y) * (b.x - a.x) / (b.y - a.y))
+    {
+      inside = !inside;
+    }
+  }
+  return inside;
+}
+
+/**
+ * One dimensional squared distance transform of a sampled function: d[q] = min over p of (q - p)^2 + f[p]
+ * v and z are scratch space of at least n and n + 1 elements
+ */
+static void squaredDistanceTransform1D(double const* f, int n, double* d, int* v, double* z)
+{
+  // Lower envelope of the parabolas rooted at (p, f[p]): v are their roots, z the boundaries between them
+  int k = 0;
+  v[0] = 0;
+  z[0] = -std::numeric_limits<double>::infinity();
+  z[1] = std::numeric_limits<double>::infinity();
+  for (int q = 1; q < n; ++q)
+  {
+    double s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0 * (q - v[k]));
+    while (s <= z[k])
+    {
+      k--;
+      s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0 * (q - v[k]));
+    }
+    k++;
+    v[k] = q;
+    z[k] = s;
+    z[k + 1] = std::numeric_limits<double>::infinity();
+  }
+  k = 0;
+  for (int q = 0; q < n; ++q)
+  {
+    while (z[k + 1] < q)
+    {
+      k++;
+    }
+    d[q] = (q - v[k]) * static_cast<double>(q - v[k]) + f[v[k]];
+  }
+}
+
+void squared_distance_transform(std::vector<bool> const& occupied, int width, int height, std::vector<int>& d2)
+{
+  // Far enough to never be the closest, small enough to keep the differences between parabolas exact
+  const double far = 1e20;
+  int n = std::max(width, height);
+  std::vector<double> f(n), d(n), z(n + 1);
+  std::vector<int> v(n);
+  d2.resize(static_cast<size_t>(width) * height);
+  if (d2.empty())
+  {
+    return;
+  }
+
+  // The distance within the columns is just the distance to the closest occupied cell above or below, found with a
+  // sweep up and a sweep down over whole rows. It is kept in d2, -1 if the column has no occupied cell
+  for (int x = 0; x < width; ++x)
+  {
+    d2[x] = occupied[x] ? 0 : -1;
+  }
+  for (int y = 1; y < height; ++y)
+  {
+    for (int x = 0; x < width; ++x)
+    {
+      int below = d2[(y - 1) * width + x];
+      d2[y * width + x] = occupied[y * width + x] ? 0 : (below < 0 ? -1 : below + 1);
+    }
+  }
+  for (int y = height - 2; y >= 0; --y)
+  {
+    for (int x = 0; x < width; ++x)
+    {
+      int above = d2[(y + 1) * width + x], here = d2[y * width + x];
+      if (above >= 0 && (here < 0 || above + 1 < here))
+      {
+        d2[y * width + x] = above + 1;
+      }
+    }
+  }
+
+  // Then the rows, over the squared distances within the columns
+  for (int y = 0; y < height; ++y)
+  {
+    for (int x = 0; x < width; ++x)
+    {
+      int column = d2[y * width + x];
+      f[x] = (column < 0) ? far : static_cast<double>(column) * column;
+    }
+    squaredDistanceTransform1D(&f[0], width, &d[0], &v[0], &z[0]);
+    for (int x = 0; x < width; ++x)
+    {
+      d2[y * width + x] = (d[x] < INT_MAX) ? static_cast<int>(d[x]) : INT_MAX;
+    }
+  }
+}
+
+/**
+ * Range of coverage cells [first, last] along one axis that make up the tile from lower to lower + tile_size
+ */
+static void coverageCellRange(float lower, float tile_size, float resolution, int &first, int &last)
+{
+  // The cells whose centers lie in [lower, lower + tile_size)
+  first = ceil(lower / resolution - 0.5);
+  last = ceil((lower + tile_size) / resolution - 0.5) - 1;
+  if (first > last)
+  {
+    first = last = floor((lower + 0.5 * tile_size) / resolution);
+  }
+}
+
+int mark_covered_tiles(std::vector<std::vector<bool> > const& grid, RowMajorGrid const& covered, float resolution,
+                       fPoint_t origin, float tile_size, fPoint_t grid_origin, float min_fraction,
+                       std::vector<std::vector<bool> >& visited)
+{
+  return mark_covered_tiles(NestedVectorView(grid, visited), covered, resolution, origin, tile_size, grid_origin,
+                            min_fraction);
+}
+
+template <class View>
+int mark_covered_tiles(View const& view, RowMajorGrid const& covered, float resolution, fPoint_t origin,
+                       float tile_size, fPoint_t grid_origin, float min_fraction)
+{
+  int marked = 0;
+  for (int iy = 0; iy < view.height(); ++iy)
+  {
+    int firstRow, lastRow;
+    coverageCellRange(grid_origin.y + iy * tile_size - origin.y, tile_size, resolution, firstRow, lastRow);
+    for (int ix = 0; ix < view.width(); ++ix)
+    {
+      if (view.visited(ix, iy))
+      {
+        continue;
+      }
+      int firstColl, lastColl;
+      coverageCellRange(grid_origin.x + ix * tile_size - origin.x, tile_size, resolution, firstColl, lastColl);
+      int count = 0;
+      for (int y = std::max(firstRow, 0); y <= std::min(lastRow, covered.height() - 1); ++y)
+      {
+        for (int x = std::max(firstColl, 0); x <= std::min(lastColl, covered.width() - 1); ++x)
+        {
+          count += covered.get(x, y);
+        }
+      }
+      // Whether the tile is blocked is only read for the covered ones, a lazily evaluated grid reads no more
+      if (count >= min_fraction * (lastRow - firstRow + 1) * (lastColl - firstColl + 1) && !view.blocked(ix, iy))
+      {
+        view.mark(ix, iy);
+        marked++;
+      }
+    }
+  }
+  return marked;
+}
+
 /**
- * Sort vector<gridNode> by the heuristic value of the last element
- * @return whether last elem. of first has a larger heuristic value than last elem of second
+ * Sort the ends of paths of nodes by their heuristic value, the nodes being stored in nodes
+ * @return whether first has a larger heuristic value than second
  */
-bool sort_gridNodePath_heuristic_desc(const std::vector<gridNode_t> &first, const std::vector<gridNode_t> &second)
+template <class Node>
+class SortGridNodeHeuristicDesc
 {
-  return (first.back().he > second.back().he);
+public:
+  explicit SortGridNodeHeuristicDesc(ArenaVector<Node> const &nodes) : nodes_(&nodes)
+  {
+  }
+
+  bool operator()(uint32_t first, uint32_t second) const
+  {
+    return ((*nodes_)[first].he > (*nodes_)[second].he);
+  }
+
+private:
+  ArenaVector<Node> const *nodes_;
+};
+
+/**
+ * distanceToClosestPoint over goals in contiguous memory
+ */
+template <class Coord>
+static int distanceToClosestPoint(Point_t poi, ArenaVector<PackedPoint<Coord> > const &goals)
+{
+  int min_dist = INT_MAX;
+  for (typename ArenaVector<PackedPoint<Coord> >::const_iterator it = goals.begin(); it != goals.end(); ++it)
+  {
+    int dx = poi.x - it->x;
+    int dy = poi.y - it->y;
+    min_dist = std::min(min_dist, dx * dx + dy * dy);
+  }
+  return min_dist;
 }
 
 bool a_star_to_open_space(std::vector<std::vector<bool> > const &grid, gridNode_t init, int cost,
                           std::vector<std::vector<bool> > &visited, std::list<Point_t> const &open_space,
                           std::list<gridNode_t> &pathNodes)
 {
-  uint dx, dy, dx_prev, nRows = grid.size(), nCols = grid[0].size();
+  return a_star_to_open_space(NestedVectorView(grid, visited), init, cost, open_space, pathNodes);
+}
 
-  std::vector<std::vector<bool> > closed(nRows, std::vector<bool>(nCols, eNodeOpen));
-  // All nodes in the closest list are currently still open
+/**
+ * Report the path that A* found to open space, by appending it to the output.
+ * The path is the chain of parents from nodes[last] back to the first node
+ */
+template <class Coord>
+static void appendAStarPath(ArenaVector<PackedNode<Coord> > const &nodes, ArenaVector<uint32_t> const &parents,
+                            uint32_t last, std::list<gridNode_t> &pathNodes)
+{
+  std::list<gridNode_t>::iterator where = pathNodes.end();
+  for (uint32_t i = last; ; i = parents[i])
+  {
+    gridNode_t node = { { nodes[i].pos.x, nodes[i].pos.y }, nodes[i].cost, nodes[i].he };  // NOLINT
+    where = pathNodes.insert(where, node);
+    if (i == 0)
+    {
+      break;
+    }
+  }
+}
+
+template <class Coord>
+static void appendAStarPath(ArenaVector<PackedNode<Coord> > const &nodes, ArenaVector<uint32_t> const &parents,
+                            uint32_t last, std::vector<Point_t> &path)
+{
+  std::size_t length = 1;
+  for (uint32_t i = last; i != 0; i = parents[i])
+  {
+    ++length;
+  }
+  path.resize(path.size() + length);
+  std::vector<Point_t>::iterator where = path.end();
+  for (uint32_t i = last; ; i = parents[i])
+  {
+    Point_t p = { nodes[i].pos.x, nodes[i].pos.y };  // NOLINT
+    *(--where) = p;
+    if (i == 0)
+    {
+      break;
+    }
+  }
+}
+
+/**
+ * Report that A* resigns: the list of nodes is left with init as its last node, a caller-owned path is not touched
+ */
+static void resignAStar(gridNode_t init, std::list<gridNode_t> &pathNodes)
+{
+  // Empty end_node list and add init as only element
+  pathNodes.erase(pathNodes.begin(), --(pathNodes.end()));
+  pathNodes.push_back(init);
+}
+
+static void resignAStar(gridNode_t, std::vector<Point_t> &)
+{
+}
+
+/**
+ * A* from init to the closest open node of view, reporting the path to a list of gridNode_t or to a caller-owned path.
+ * Every node of the search is stored once, as a PackedNode<Coord> in arena with the index of the node it was reached
+ * from. A path of the search is the index of its last node, so the memory grows with the number of nodes only
+ */
+template <class Coord, class View, class Goals, class Path>
+static bool aStarToOpenSpace(View const &view, gridNode_t init, int cost,
+                             Goals const &open_space, Path &pathNodes, Arena &arena)
+{
+  typedef PackedNode<Coord> Node;
+  uint dx, dy, dx_prev, nRows = view.height(), nCols = view.width();
+
+  // The heuristic looks at all of open_space for every node, so read it from contiguous memory
+  ArenaVector<PackedPoint<Coord> > goals((ArenaAllocator<PackedPoint<Coord> >(arena)));
+  goals.reserve(open_space.size());
+  for (typename Goals::const_iterator it = open_space.begin(); it != open_space.end(); ++it)
+  {
+    PackedPoint<Coord> goal = { static_cast<Coord>(it->x), static_cast<Coord>(it->y) };  // NOLINT
+    goals.push_back(goal);
+  }
 
-  closed[init.pos.y][init.pos.x] = eNodeVisited;  // Of course we have visited the current/initial location
+  // All nodes in the closest list are currently still open. Only the pages the search reaches get allocated
+  PagedGrid closed(nCols, nRows, eNodeOpen);
+
+  gridSet(closed, init.pos.x, init.pos.y, eNodeVisited);  // Of course we have visited the current/initial location
 #ifdef DEBUG_PLOT
   std::cout << "A*: Marked init " << init << " as eNodeVisited (true)" << std::endl;
   printGrid(closed);
 #endif
 
-  std::vector<std::vector<gridNode_t> > open1(1, std::vector<gridNode_t>(1, init));  // open1 is a *vector* of paths
+  Node start = { { static_cast<Coord>(init.pos.x), static_cast<Coord>(init.pos.y) }, init.cost, init.he };  // NOLINT
+  ArenaVector<Node> nodes(1, start, ArenaAllocator<Node>(arena));
+  ArenaVector<uint32_t> parents(1, 0, ArenaAllocator<uint32_t>(arena));  // The first node is its own parent
+  // open1 is a *vector* of paths, each given by the index of its last node
+  ArenaVector<uint32_t> open1(1, 0, ArenaAllocator<uint32_t>(arena));
 
   while (true)
   {
@@ -82,44 +405,38 @@ bool a_star_to_open_space(std::vector<std::vector<bool> > const &grid, gridNode_
 #endif
     if (open1.size() == 0)  // If there are no open paths, there's no place to go and we must resign
     {
-      // Empty end_node list and add init as only element
-      pathNodes.erase(pathNodes.begin(), --(pathNodes.end()));
-      pathNodes.push_back(init);
+      resignAStar(init, pathNodes);
       return true;  // We resign, cannot find a path
     }
     else
     {
-      // Sort elements from high to low (because sort_gridNodePath_heuristic_desc uses a > b)
-      std::sort(open1.begin(), open1.end(), sort_gridNodePath_heuristic_desc);
+      // Sort elements from high to low (because SortGridNodeHeuristicDesc uses a > b)
+      std::sort(open1.begin(), open1.end(), SortGridNodeHeuristicDesc<Node>(nodes));
 
-      std::vector<gridNode_t> nn = open1.back();  // Get the *path* with the lowest heuristic cost
+      uint32_t nn = open1.back();  // Get the *path* with the lowest heuristic cost
       open1.pop_back();  // The last element is no longer open because we use it here, so remove from open list
+      Node last = nodes[nn];
 #ifdef DEBUG_PLOT
-      std::cout << "A*: Check out path from" << nn.front().pos << " to " << nn.back().pos
-      << " of length " << nn.size() << std::endl;
+      std::cout << "A*: Check out path from" << nodes.front().pos << " to " << last.pos << std::endl;
 #endif
 
       // Does the path nn end in open space?
-      if (visited[nn.back().pos.y][nn.back().pos.x] == eNodeOpen)
+      if (!view.blocked(last.pos.x, last.pos.y) && !view.visited(last.pos.x, last.pos.y))
       {
         // If so, we found a path to open space
         // Copy the path nn to pathNodes so we can report that path (to get to open space)
-        std::vector<gridNode_t>::iterator iter;
-        for (iter = nn.begin(); iter != nn.end(); ++iter)
-        {
-          pathNodes.push_back((*iter));
-        }
+        appendAStarPath(nodes, parents, nn, pathNodes);
 
         return false;  // We do not resign, we found a path
       }
       else  // Path nn does not lead to open space
       {
-        if (nn.size() > 1)
+        if (nn != 0)
         {
-          // Create iterator for gridNode_t list and let it point to the last element of nn
-          std::vector<gridNode_t>::iterator it = --(nn.end());
-          dx = it->pos.x - (it - 1)->pos.x;
-          dy = it->pos.y - (it - 1)->pos.y;
+          // Look at the last step of the path nn
+          Node const &prev = nodes[parents[nn]];
+          dx = last.pos.x - prev.pos.x;
+          dy = last.pos.y - prev.pos.y;
           // TODO(CesarLopez) docs: this seems to cycle through directions
           // (notice the shift-by-one between both sides of the =)
           dx_prev = dx;
@@ -137,8 +454,8 @@ bool a_star_to_open_space(std::vector<std::vector<bool> > const &grid, gridNode_
         {
           Point_t p2 =
           {
-            static_cast<int>(nn.back().pos.x + dx),
-            static_cast<int>(nn.back().pos.y + dy),
+            static_cast<int>(last.pos.x + dx),
+            static_cast<int>(last.pos.y + dy),
           };
 
 #ifdef DEBUG_PLOT
@@ -147,41 +464,41 @@ bool a_star_to_open_space(std::vector<std::vector<bool> > const &grid, gridNode_
 
           if (p2.x >= 0 && p2.x < nCols && p2.y >= 0 && p2.y < nRows)  // Bounds check, do not sep out of map
           {
-            // If the new node (a neighbor of the end of the path nn) is open, append it to newPath ( = nn)
-            // and add that to the open1-list of paths.
-            // Because of the pop_back on open1, what happens is that the path is temporarily 'checked out',
-            // modified here, and then added back (if the condition above and below holds)
-            if (closed[p2.y][p2.x] == eNodeOpen && grid[p2.y][p2.x] == eNodeOpen)
+            // If the new node (a neighbor of the end of the path nn) is open, store it with nn as its parent
+            // and add that path to the open1-list of paths.
+            // nn itself stays in nodes, so all paths that branch off from it share it
+            if (gridGet(closed, p2.x, p2.y) == eNodeOpen && !view.blocked(p2.x, p2.y))
             {
 #ifdef DEBUG_PLOT
               std::cout << "A*: p2=" << p2 << " is OPEN" << std::endl;
 #endif
-              std::vector<gridNode_t> newPath = nn;
               // # heuristic  has to be designed to prefer a CCW turn
-              Point_t new_point = { p2.x, p2.y };
-              gridNode_t new_node =
+              PackedPoint<Coord> new_point = { static_cast<Coord>(p2.x), static_cast<Coord>(p2.y) };  // NOLINT
+              Node new_node =
               {
                 new_point,                                                                             // Point: x,y
-                static_cast<int>(cost + nn.back().cost),                                               // Cost
-                static_cast<int>(cost + nn.back().cost + distanceToClosestPoint(p2, open_space) + i),
+                static_cast<int>(cost + last.cost),                                                    // Cost
+                static_cast<int>(cost + last.cost + distanceToClosestPoint(p2, goals) + i),
                 // Heuristic (+i so CCW turns are cheaper)
               };
-              newPath.push_back(new_node);
-              closed[new_node.pos.y][new_node.pos.x] = eNodeVisited;  // New node is now used in a path and thus visited
+              nodes.push_back(new_node);
+              parents.push_back(nn);
+              // New node is now used in a path and thus visited
+              gridSet(closed, new_node.pos.x, new_node.pos.y, eNodeVisited);
 
 #ifdef DEBUG_PLOT
               std::cout << "A*: Marked new_node " << new_node << " as eNodeVisited (true)" << std::endl;
-              std::cout << "A*: Add path from " << newPath.front().pos << " to " << newPath.back().pos
-              << " of length " << newPath.size() << " to open1" << std::endl;
+              std::cout << "A*: Add path from " << nodes.front().pos << " to " << new_node.pos << " to open1"
+              << std::endl;
 #endif
-              open1.push_back(newPath);
+              open1.push_back(nodes.size() - 1);
             }
 #ifdef DEBUG_PLOT
             else
             {
               std::cout << "A*: p2=" << p2 << " is not open: "
-                        "closed[" << p2.y << "][" << p2.x << "]=" << closed[p2.y][p2.x] << ", "
-                        "grid["  << p2.y << "][" << p2.x << "]=" << grid[p2.y][p2.x] << std::endl;
+                        "closed[" << p2.y << "][" << p2.x << "]=" << gridGet(closed, p2.x, p2.y) << ", "
+                        "grid["  << p2.y << "][" << p2.x << "]=" << view.blocked(p2.x, p2.y) << std::endl;
             }
 #endif
           }
@@ -201,49 +518,481 @@ bool a_star_to_open_space(std::vector<std::vector<bool> > const &grid, gridNode_
   }
 }
 
-void printGrid(std::vector<std::vector<bool> > const& grid, std::vector<std::vector<bool> > const& visited,
-               std::list<Point_t> const& path)
+template <class View>
+bool a_star_to_open_space(View const &view, gridNode_t init, int cost,
+                          std::list<Point_t> const &open_space, std::list<gridNode_t> &pathNodes)
+{
+  Arena arena;
+  return aStarToOpenSpace<int32_t>(view, init, cost, open_space, pathNodes, arena);
+}
+
+template <class View>
+bool a_star_to_open_space(View const &view, gridNode_t init, int cost,
+                          std::list<Point_t> const &open_space, std::vector<Point_t> &path)
+{
+  Arena arena;
+  return aStarToOpenSpace<int32_t>(view, init, cost, open_space, path, arena);
+}
+
+template <class View>
+bool a_star_to_open_space(View const &view, gridNode_t init, int cost,
+                          ArenaList<Point_t> const &open_space, std::vector<Point_t> &path, Arena &arena)
 {
-  for (uint iy = grid.size() - 1; iy >= 0; --iy)
+  return aStarToOpenSpace<int32_t>(view, init, cost, open_space, path, arena);
+}
+
+
+/**
+ * Scan along row y from x in direction dx
+ * @return x of the first jump point: an open node or a node with a forced vertical neighbor. -1 if there is none
+ */
+template <class View>
+static int jumpHorizontal(View const &view, int x, int y, int dx)
+{
+  int nRows = view.height(), nCols = view.width();
+  while (true)
   {
-    for (uint ix = 0; ix < grid[0].size(); ++ix)
+    int x2 = x + dx;
+    if (x2 < 0 || x2 >= nCols || view.blocked(x2, y))
     {
-      if (visited[iy][ix])
+      return -1;
+    }
+    if (!view.visited(x2, y))
+    {
+      return x2;
+    }
+    for (int dy = -1; dy <= 1; dy += 2)
+    {
+      // A vertical step is forced if it could not have been taken from the previous node in the row
+      int y2 = y + dy;
+      if (y2 >= 0 && y2 < nRows && !view.blocked(x2, y2) && view.blocked(x, y2))
       {
-        if (ix == path.front().x && iy == path.front().y)
+        return x2;
+      }
+    }
+    x = x2;
+  }
+}
+
+/**
+ * Scan along column x from y in direction dy
+ * @return y of the first jump point: an open node or a node from which a horizontal scan finds a jump point.
+ * -1 if there is none
+ */
+template <class View>
+static int jumpVertical(View const &view, int x, int y, int dy)
+{
+  int nRows = view.height();
+  while (true)
+  {
+    int y2 = y + dy;
+    if (y2 < 0 || y2 >= nRows || view.blocked(x, y2))
+    {
+      return -1;
+    }
+    if (!view.visited(x, y2) || jumpHorizontal(view, x, y2, 1) >= 0 || jumpHorizontal(view, x, y2, -1) >= 0)
+    {
+      return y2;
+    }
+    y = y2;
+  }
+}
+
+bool jps_to_open_space(std::vector<std::vector<bool> > const &grid, gridNode_t init, int cost,
+                       std::vector<std::vector<bool> > const &visited, std::list<gridNode_t> &pathNodes)
+{
+  GridView<std::vector<std::vector<bool> >, std::vector<std::vector<bool> > const> view(grid, visited);
+  return jps_to_open_space(view, init, cost, pathNodes);
+}
+
+template <class View>
+bool jps_to_open_space(View const &view, gridNode_t init, int cost, std::list<gridNode_t> &pathNodes)
+{
+  int nRows = view.height(), nCols = view.width();
+  int start = init.pos.y * nCols + init.pos.x;
+
+  // Per node: best cost so far, jump point we came from and direction of arrival (dx + 2 * dy, 0 for init)
+  std::vector<int> g(nRows * nCols, INT_MAX);
+  std::vector<int> parent(nRows * nCols, -1);
+  std::vector<int> arrival(nRows * nCols, 0);
+
+  typedef std::pair<int, int> queue_item_t;  // (cost, node index)
+  std::priority_queue<queue_item_t, std::vector<queue_item_t>, std::greater<queue_item_t> > open;
+  g[start] = 0;
+  open.push(std::make_pair(0, start));
+
+  int goal = -1;
+  while (!open.empty())
+  {
+    queue_item_t item = open.top();
+    open.pop();
+    int n = item.second;
+    if (item.first > g[n])
+    {
+      continue;  // Outdated queue entry
+    }
+    int x = n % nCols, y = n / nCols;
+    if (!view.blocked(x, y) && !view.visited(x, y))
+    {
+      goal = n;
+      break;
+    }
+
+    // Directions to scan: all of them from init, otherwise the natural and forced neighbors of the arrival
+    int dx = arrival[n] % 2;
+    int dy = arrival[n] / 2;
+    std::vector<Point_t> dirs;
+    if (arrival[n] == 0 || dy != 0)
+    {
+      // Vertical arrival: continue vertically and scan the row both ways
+      Point_t right = { 1, 0 }, left = { -1, 0 }, up = { 0, 1 }, down = { 0, -1 };
+      dirs.push_back(right);
+      dirs.push_back(left);
+      if (arrival[n] == 0 || dy > 0)
+      {
+        dirs.push_back(up);
+      }
+      if (arrival[n] == 0 || dy < 0)
+      {
+        dirs.push_back(down);
+      }
+    }
+    else
+    {
+      Point_t ahead = { dx, 0 };
+      dirs.push_back(ahead);
+      for (int side = -1; side <= 1; side += 2)
+      {
+        int y2 = y + side;
+        if (y2 >= 0 && y2 < nRows && !view.blocked(x, y2) && view.blocked(x - dx, y2))
         {
-          std::cout << "\033[1;32m▓\033[0m";  // Show starting position in green color
+          Point_t forced = { 0, side };
+          dirs.push_back(forced);
         }
-        else if (ix == path.back().x && iy == path.back().y)
+      }
+    }
+
+    for (int i = 0; i < dirs.size(); ++i)
+    {
+      int jx = x, jy = y;
+      if (dirs[i].x != 0)
+      {
+        jx = jumpHorizontal(view, x, y, dirs[i].x);
+      }
+      else
+      {
+        jy = jumpVertical(view, x, y, dirs[i].y);
+      }
+      if (jx < 0 || jy < 0)
+      {
+        continue;
+      }
+      int m = jy * nCols + jx;
+      int g2 = item.first + cost * (abs(jx - x) + abs(jy - y));
+      if (g2 < g[m])
+      {
+        g[m] = g2;
+        parent[m] = n;
+        arrival[m] = dirs[i].x + 2 * dirs[i].y;
+        open.push(std::make_pair(g2, m));
+      }
+    }
+  }
+
+  if (goal < 0)
+  {
+    // Empty end_node list and add init as only element, like a_star_to_open_space
+    if (!pathNodes.empty())
+    {
+      pathNodes.erase(pathNodes.begin(), --(pathNodes.end()));
+    }
+    pathNodes.push_back(init);
+    return true;  // We resign, cannot find a path
+  }
+
+  // Collect the jump points and fill in the straight runs between them
+  std::vector<int> jumpPoints;
+  for (int n = goal; n != start; n = parent[n])
+  {
+    jumpPoints.push_back(n);
+  }
+  std::reverse(jumpPoints.begin(), jumpPoints.end());
+
+  gridNode_t node = init;
+  pathNodes.push_back(node);
+  for (int i = 0; i < jumpPoints.size(); ++i)
+  {
+    Point_t target = { jumpPoints[i] % nCols, jumpPoints[i] / nCols };
+    int dx = (target.x > node.pos.x) - (target.x < node.pos.x);
+    int dy = (target.y > node.pos.y) - (target.y < node.pos.y);
+    while (node.pos.x != target.x || node.pos.y != target.y)
+    {
+      node.pos.x += dx;
+      node.pos.y += dy;
+      node.cost += cost;
+      node.he = node.cost;
+      pathNodes.push_back(node);
+    }
+  }
+  return false;  // We do not resign, we found a path
+}
+
+bool turn_aware_to_open_space(std::vector<std::vector<bool> > const &grid, gridNode_t init, int heading, int cost,
+                              int turn_cost, std::vector<std::vector<bool> > const &visited,
+                              std::list<Point_t> const &open_space, std::list<gridNode_t> &pathNodes)
+{
+  GridView<std::vector<std::vector<bool> >, std::vector<std::vector<bool> > const> view(grid, visited);
+  return turn_aware_to_open_space(view, init, heading, cost, turn_cost, open_space, pathNodes);
+}
+
+/**
+ * Manhattan distance from poi to the closest point in goals, 0 if there are none.
+ * Unlike distanceToClosestPoint, this is a lower bound of the number of steps on a 4-connected grid
+ */
+template <class Allocator>
+static int manhattanToClosestPoint(Point_t poi, std::list<Point_t, Allocator> const& goals)
+{
+  int min_dist = goals.empty() ? 0 : INT_MAX;
+  for (typename std::list<Point_t, Allocator>::const_iterator it = goals.begin(); it != goals.end(); ++it)
+  {
+    min_dist = std::min(min_dist, abs(it->x - poi.x) + abs(it->y - poi.y));
+  }
+  return min_dist;
+}
+
+template <class View, class Allocator>
+bool turn_aware_to_open_space(View const &view, gridNode_t init, int heading, int cost, int turn_cost,
+                              std::list<Point_t, Allocator> const &open_space, std::list<gridNode_t> &pathNodes)
+{
+  int nRows = view.height(), nCols = view.width();
+  int start = init.pos.y * nCols + init.pos.x;
+  int dirX[] = { 1, 0, -1, 0 }, dirY[] = { 0, 1, 0, -1 };  // NOLINT
+
+  // Per state (node * 4 + heading): best cost so far and the state we came from.
+  // The heuristic only depends on the node, so it is computed once per node
+  std::vector<int> g(4 * nRows * nCols, INT_MAX);
+  std::vector<int> parent(4 * nRows * nCols, -1);
+  std::vector<int> h(nRows * nCols, -1);
+
+  typedef std::pair<int, int> queue_item_t;  // (cost + heuristic, state)
+  std::priority_queue<queue_item_t, std::vector<queue_item_t>, std::greater<queue_item_t> > open;
+  h[start] = cost * manhattanToClosestPoint(init.pos, open_space);
+  for (int d = 0; d < 4; ++d)
+  {
+    // Without a heading, init can be left in any direction for free
+    if (heading < 0 || heading == d)
+    {
+      g[4 * start + d] = 0;
+      open.push(std::make_pair(h[start], 4 * start + d));
+    }
+  }
+
+  int goal = -1;
+  while (!open.empty())
+  {
+    queue_item_t item = open.top();
+    open.pop();
+    int s = item.second, n = s / 4, d = s % 4;
+    if (item.first > g[s] + h[n])
+    {
+      continue;  // Outdated queue entry
+    }
+    int x = n % nCols, y = n / nCols;
+    if (!view.blocked(x, y) && !view.visited(x, y))
+    {
+      goal = s;
+      break;
+    }
+
+    for (int d2 = 0; d2 < 4; ++d2)
+    {
+      int x2 = x + dirX[d2], y2 = y + dirY[d2];
+      if (x2 < 0 || x2 >= nCols || y2 < 0 || y2 >= nRows || view.blocked(x2, y2))
+      {
+        continue;
+      }
+      int turns = abs(d2 - d) == 3 ? 1 : abs(d2 - d);
+      int m = y2 * nCols + x2, s2 = 4 * m + d2;
+      int g2 = g[s] + cost + turn_cost * turns;
+      if (g2 < g[s2])
+      {
+        if (h[m] < 0)
         {
-          std::cout << "\033[1;31m▓\033[0m";  // Show stopping position in red color
+          Point_t p2 = { x2, y2 };
+          h[m] = cost * manhattanToClosestPoint(p2, open_space);
         }
-        else if (visited[iy][ix] && grid[iy][ix])
+        g[s2] = g2;
+        parent[s2] = s;
+        open.push(std::make_pair(g2 + h[m], s2));
+      }
+    }
+  }
+
+  if (goal < 0)
+  {
+    // Empty end_node list and add init as only element, like a_star_to_open_space
+    if (!pathNodes.empty())
+    {
+      pathNodes.erase(pathNodes.begin(), --(pathNodes.end()));
+    }
+    pathNodes.push_back(init);
+    return true;  // We resign, cannot find a path
+  }
+
+  std::vector<int> states;
+  for (int s = goal; parent[s] >= 0; s = parent[s])
+  {
+    states.push_back(s);
+  }
+  pathNodes.push_back(init);
+  for (int i = states.size() - 1; i >= 0; --i)
+  {
+    int n = states[i] / 4;
+    Point_t p = { n % nCols, n / nCols };
+    gridNode_t node =
+    {
+      p,                          // Point: x,y
+      init.cost + g[states[i]],   // Cost
+      init.cost + g[states[i]],   // Heuristic
+    };
+    pathNodes.push_back(node);
+  }
+  return false;  // We do not resign, we found a path
+}
+
+bool dial_to_open_space(std::vector<std::vector<bool> > const &grid, CostGrid const &costs, gridNode_t init,
+                        int cost, std::vector<std::vector<bool> > const &visited, std::list<gridNode_t> &pathNodes)
+{
+  GridView<std::vector<std::vector<bool> >, std::vector<std::vector<bool> > const> view(grid, visited);
+  return dial_to_open_space(view, costs, init, cost, pathNodes);
+}
+
+template <class View>
+bool dial_to_open_space(View const &view, CostGrid const &costs, gridNode_t init, int cost,
+                        std::list<gridNode_t> &pathNodes)
+{
+  int nRows = view.height(), nCols = view.width();
+  int start = init.pos.y * nCols + init.pos.x;
+  int dirX[] = { 1, 0, -1, 0 }, dirY[] = { 0, 1, 0, -1 };  // NOLINT
+
+  // No step costs more than cost + 255, so all queued nodes fit in that many buckets, used round-robin
+  int nBuckets = cost + 256;
+  std::vector<std::vector<int> > buckets(nBuckets);
+  std::vector<int> g(nRows * nCols, INT_MAX);
+  std::vector<int> parent(nRows * nCols, -1);
+  g[start] = 0;
+  buckets[0].push_back(start);
+  int queued = 1;
+
+  int goal = -1;
+  for (int current = 0; queued > 0 && goal < 0; ++current)
+  {
+    std::vector<int>& bucket = buckets[current % nBuckets];
+    // Nodes of cost 'current' can still be added to this bucket while it is processed, if cost is 0
+    for (int i = 0; i < bucket.size(); ++i)
+    {
+      int n = bucket[i];
+      queued--;
+      if (g[n] != current)
+      {
+        continue;  // Outdated queue entry
+      }
+      int x = n % nCols, y = n / nCols;
+      if (!view.blocked(x, y) && !view.visited(x, y))
+      {
+        goal = n;
+        break;
+      }
+      for (int d = 0; d < 4; ++d)
+      {
+        int x2 = x + dirX[d], y2 = y + dirY[d];
+        if (x2 < 0 || x2 >= nCols || y2 < 0 || y2 >= nRows || view.blocked(x2, y2))
         {
-          std::cout << "\033[1;33m▓\033[0m";  // Show walls in yellow color
+          continue;
         }
-        else
+        int m = y2 * nCols + x2;
+        int g2 = current + cost + costs.get(x2, y2);
+        if (g2 < g[m])
         {
-          std::cout << "\033[1;36m▓\033[0m";
+          g[m] = g2;
+          parent[m] = n;
+          buckets[g2 % nBuckets].push_back(m);
+          queued++;
         }
       }
-      else
-      {
-        std::cout << "\033[1;37m▓\033[0m";
-      }
     }
-    std::cout << "\n";
+    bucket.clear();
   }
+
+  if (goal < 0)
+  {
+    // Empty end_node list and add init as only element, like a_star_to_open_space
+    if (!pathNodes.empty())
+    {
+      pathNodes.erase(pathNodes.begin(), --(pathNodes.end()));
+    }
+    pathNodes.push_back(init);
+    return true;  // We resign, cannot find a path
+  }
+
+  std::vector<int> nodes;
+  for (int n = goal; n != start; n = parent[n])
+  {
+    nodes.push_back(n);
+  }
+  pathNodes.push_back(init);
+  for (int i = nodes.size() - 1; i >= 0; --i)
+  {
+    Point_t p = { nodes[i] % nCols, nodes[i] / nCols };
+    gridNode_t node =
+    {
+      p,                          // Point: x,y
+      init.cost + g[nodes[i]],    // Cost
+      init.cost + g[nodes[i]],    // Heuristic
+    };
+    pathNodes.push_back(node);
+  }
+  return false;  // We do not resign, we found a path
+}
+
+void printGrid(std::vector<std::vector<bool> > const& grid,
+               std::vector<std::vector<bool> > const& visited,
+               std::list<Point_t> const& path)
+{
+  GridView<std::vector<std::vector<bool> >, std::vector<std::vector<bool> > const> view(grid, visited);
+  printGrid(view, path);
 }
 
-void printGrid(std::vector<std::vector<bool> > const& grid, std::vector<std::vector<bool> > const& visited,
-               std::list<gridNode_t> const& path, gridNode_t start, gridNode_t end)
+void printGrid(std::vector<std::vector<bool> > const& grid,
+               std::vector<std::vector<bool> > const& visited,
+               std::list<gridNode_t> const& path,
+               gridNode_t start,
+               gridNode_t end)
 {
-  for (uint iy = grid.size() - 1; iy >= 0; --iy)
+  GridView<std::vector<std::vector<bool> >, std::vector<std::vector<bool> > const> view(grid, visited);
+  printGrid(view, path, start, end);
+}
+
+template <class View>
+void printGrid(View const& view, std::list<Point_t> const& path)
+{
+  gridNode_t start = { path.front(), 0, 0 };
+  gridNode_t end = { path.back(), 0, 0 };
+  printGrid(view, std::list<gridNode_t>(), start, end);
+}
+
+template <class View>
+void printGrid(View const& view, std::list<gridNode_t> const&, gridNode_t start, gridNode_t end)
+{
+  for (int iy = view.height() - 1; iy >= 0; --iy)
   {
-    for (uint ix = 0; ix < grid[0].size(); ++ix)
+    for (int ix = 0; ix < view.width(); ++ix)
     {
-      if (visited[iy][ix])
+      if (view.blocked(ix, iy))
+      {
+        std::cout << "\033[1;33m▓\033[0m";  // Show walls in yellow color
+      }
+      else if (view.visited(ix, iy))
       {
         if (ix == start.pos.x && iy == start.pos.y)
         {
@@ -253,10 +1002,6 @@ void printGrid(std::vector<std::vector<bool> > const& grid, std::vector<std::vec
         {
           std::cout << "\033[1;31m▓\033[0m";  // Show stopping position in red color
         }
-        else if (visited[iy][ix] && grid[iy][ix])
-        {
-          std::cout << "\033[1;33m▓\033[0m";  // Show walls in yellow color
-        }
         else
         {
           std::cout << "\033[1;36m▓\033[0m";
@@ -271,13 +1016,14 @@ void printGrid(std::vector<std::vector<bool> > const& grid, std::vector<std::vec
   }
 }
 
-void printGrid(std::vector<std::vector<bool> > const& grid)
+template <class Grid>
+void printGrid(Grid const& grid)
 {
-  for (uint iy = grid.size() - 1; iy >= 0; --iy)
+  for (int iy = gridHeight(grid) - 1; iy >= 0; --iy)
   {
-    for (uint ix = 0; ix < grid[0].size(); ++ix)
+    for (int ix = 0; ix < gridWidth(grid); ++ix)
     {
-      if (grid[iy][ix])
+      if (gridGet(grid, ix, iy))
       {
         std::cout << "\033[1;36m▓\033[0m";
       }
@@ -290,22 +1036,275 @@ void printGrid(std::vector<std::vector<bool> > const& grid)
   }
 }
 
-std::list<Point_t> map_2_goals(std::vector<std::vector<bool> > const& grid, bool value_to_search)
+template <class Grid>
+std::list<Point_t> map_2_goals(Grid const& grid, bool value_to_search)
+{
+  std::list<Point_t> goals;
+  int ix, iy;
+  uint nRows = gridHeight(grid);
+  uint nCols = gridWidth(grid);
+  for (iy = 0; iy < nRows; ++(iy))
+  {
+    for (ix = 0; ix < nCols; ++(ix))
+    {
+      if (gridGet(grid, ix, iy) == value_to_search)
+      {
+        Point_t p = { ix, iy };  // x, y
+        goals.push_back(p);
+      }
+    }
+  }
+  return goals;
+}
+
+template <class Grid>
+std::list<Point_t> map_2_goals(Grid const& grid, bool value_to_search,
+                               std::vector<int> const& labels, int component)
 {
   std::list<Point_t> goals;
   int ix, iy;
-  uint nRows = grid.size();
-  uint nCols = grid[0].size();
+  uint nRows = gridHeight(grid);
+  uint nCols = gridWidth(grid);
   for (iy = 0; iy < nRows; ++(iy))
   {
     for (ix = 0; ix < nCols; ++(ix))
     {
-      if (grid[iy][ix] == value_to_search)
+      if (gridGet(grid, ix, iy) == value_to_search && labels[iy * nCols + ix] == component)
+      {
+        Point_t p = { ix, iy };  // x, y
+        goals.push_back(p);
+      }
+    }
+  }
+  return goals;
+}
+
+template <class View>
+std::list<Point_t> map_2_goals(View const& view)
+{
+  std::list<Point_t> goals;
+  map_2_goals(view, goals);
+  return goals;
+}
+
+template <class View, class Allocator>
+void map_2_goals(View const& view, std::list<Point_t, Allocator>& goals)
+{
+  int nRows = view.height();
+  int nCols = view.width();
+  for (int iy = 0; iy < nRows; ++iy)
+  {
+    for (int ix = 0; ix < nCols; ++ix)
+    {
+      if (!view.blocked(ix, iy) && !view.visited(ix, iy))
       {
         Point_t p = { ix, iy };  // x, y
         goals.push_back(p);
       }
     }
   }
+}
+
+template <class View>
+std::list<Point_t> map_2_goals(View const& view, std::vector<int> const& labels, int component)
+{
+  std::list<Point_t> goals;
+  map_2_goals(view, labels, component, goals);
   return goals;
 }
+
+template <class View, class Allocator>
+void map_2_goals(View const& view, std::vector<int> const& labels, int component, std::list<Point_t, Allocator>& goals)
+{
+  int nRows = view.height();
+  int nCols = view.width();
+  for (int iy = 0; iy < nRows; ++iy)
+  {
+    for (int ix = 0; ix < nCols; ++ix)
+    {
+      // Blocked nodes are labelled -1, so they never match
+      if (labels[iy * nCols + ix] == component && !view.visited(ix, iy))
+      {
+        Point_t p = { ix, iy };  // x, y
+        goals.push_back(p);
+      }
+    }
+  }
+}
+
+/**
+ * Find the root of a provisional label, halving the path on the way
+ */
+static int findRoot(std::vector<int> &parent, int label)
+{
+  while (parent[label] != label)
+  {
+    parent[label] = parent[parent[label]];
+    label = parent[label];
+  }
+  return label;
+}
+
+int label_connected_components(std::vector<std::vector<bool> > const& grid, std::vector<int> &labels)
+{
+  GridView<std::vector<std::vector<bool> >, std::vector<std::vector<bool> > const> view(grid, grid);
+  return label_connected_components(view, labels);
+}
+
+/**
+ * Label the 4-connected components of free space, without connecting nodes of different blocks
+ * @param block_size side of the square blocks, INT_MAX to label the components of the whole grid
+ */
+template <class View>
+static int labelComponents(View const& view, int block_size, std::vector<int> &labels)
+{
+  int ix, iy;
+  int nRows = view.height();
+  int nCols = view.width();
+  labels.assign(nRows * nCols, -1);
+
+  // First pass: give each free node the label of its left or lower neighbor and record equivalences
+  std::vector<int> parent;
+  for (iy = 0; iy < nRows; ++iy)
+  {
+    for (ix = 0; ix < nCols; ++ix)
+    {
+      if (view.blocked(ix, iy))
+      {
+        continue;
+      }
+      int left = (ix % block_size != 0) ? labels[iy * nCols + ix - 1] : -1;
+      int below = (iy % block_size != 0) ? labels[(iy - 1) * nCols + ix] : -1;
+      if (left < 0 && below < 0)
+      {
+        labels[iy * nCols + ix] = parent.size();
+        parent.push_back(parent.size());
+      }
+      else if (left < 0 || below < 0)
+      {
+        labels[iy * nCols + ix] = std::max(left, below);
+      }
+      else
+      {
+        int rootLeft = findRoot(parent, left);
+        int rootBelow = findRoot(parent, below);
+        parent[std::max(rootLeft, rootBelow)] = std::min(rootLeft, rootBelow);
+        labels[iy * nCols + ix] = left;
+      }
+    }
+  }
+
+  // Second pass: resolve equivalences and renumber the components consecutively
+  std::vector<int> component(parent.size(), -1);
+  int nComponents = 0;
+  for (int i = 0; i < labels.size(); ++i)
+  {
+    if (labels[i] < 0)
+    {
+      continue;
+    }
+    int root = findRoot(parent, labels[i]);
+    if (component[root] < 0)
+    {
+      component[root] = nComponents++;
+    }
+    labels[i] = component[root];
+  }
+  return nComponents;
+}
+
+template <class View>
+int label_connected_components(View const& view, std::vector<int> &labels)
+{
+  return labelComponents(view, INT_MAX, labels);
+}
+
+template <class View>
+int label_block_regions(View const& view, int block_size, std::vector<int> &labels)
+{
+  return labelComponents(view, block_size, labels);
+}
+
+template <class View>
+int label_component(View const& view, Point_t init, std::vector<int> &labels)
+{
+  int nRows = view.height();
+  int nCols = view.width();
+  labels.assign(nRows * nCols, -1);
+  if (view.blocked(init.x, init.y))
+  {
+    return 0;
+  }
+
+  // The labels double as the set of nodes that were queued
+  std::vector<int> queue(1, init.y * nCols + init.x);
+  labels[queue[0]] = 0;
+  int dx[] = { 1, 0, -1, 0 }, dy[] = { 0, 1, 0, -1 };  // NOLINT
+  for (std::size_t i = 0; i < queue.size(); ++i)
+  {
+    int x = queue[i] % nCols, y = queue[i] / nCols;
+    for (int d = 0; d < 4; ++d)
+    {
+      int x2 = x + dx[d], y2 = y + dy[d];
+      if (x2 >= 0 && x2 < nCols && y2 >= 0 && y2 < nRows && labels[y2 * nCols + x2] < 0 && !view.blocked(x2, y2))
+      {
+        labels[y2 * nCols + x2] = 0;
+        queue.push_back(y2 * nCols + x2);
+      }
+    }
+  }
+  return queue.size();
+}
+
+/*
+ * Explicit instantiations for each of the supported grid storages and grid views
+ */
+#define FCPP_INSTANTIATE_COMMON_GRID(Grid)                                                                          \
+  template void printGrid(Grid const& grid);                                                                        \
+  template std::list<Point_t> map_2_goals(Grid const& grid, bool value_to_search);                                 \
+  template std::list<Point_t> map_2_goals(Grid const& grid, bool value_to_search,                                  \
+                                          std::vector<int> const& labels, int component);
+
+FCPP_INSTANTIATE_COMMON_GRID(std::vector<std::vector<bool> >)
+FCPP_INSTANTIATE_COMMON_GRID(RowMajorGrid)
+FCPP_INSTANTIATE_COMMON_GRID(TiledGrid8)
+FCPP_INSTANTIATE_COMMON_GRID(TiledGrid64)
+
+#define FCPP_INSTANTIATE_COMMON_VIEW(View)                                                                          \
+  template bool a_star_to_open_space(View const &view, gridNode_t init, int cost,                                  \
+                                     std::list<Point_t> const &open_space, std::list<gridNode_t> &pathNodes);      \
+  template bool a_star_to_open_space(View const &view, gridNode_t init, int cost,                                  \
+                                     std::list<Point_t> const &open_space, std::vector<Point_t> &path);            \
+  template bool a_star_to_open_space(View const &view, gridNode_t init, int cost,                                  \
+                                     ArenaList<Point_t> const &open_space, std::vector<Point_t> &path,             \
+                                     Arena &arena);                                                                \
+  template bool jps_to_open_space(View const &view, gridNode_t init, int cost, std::list<gridNode_t> &pathNodes);  \
+  template bool turn_aware_to_open_space(View const &view, gridNode_t init, int heading, int cost, int turn_cost,   \
+                                         std::list<Point_t> const &open_space, std::list<gridNode_t> &pathNodes);  \
+  template bool turn_aware_to_open_space(View const &view, gridNode_t init, int heading, int cost, int turn_cost,   \
+                                         ArenaList<Point_t> const &open_space,                                     \
+                                         std::list<gridNode_t> &pathNodes);                                        \
+  template bool dial_to_open_space(View const &view, CostGrid const &costs, gridNode_t init, int cost,             \
+                                   std::list<gridNode_t> &pathNodes);                                              \
+  template int label_connected_components(View const& view, std::vector<int> &labels);                             \
+  template int label_block_regions(View const& view, int block_size, std::vector<int> &labels);                    \
+  template int label_component(View const& view, Point_t init, std::vector<int> &labels);                          \
+  template void printGrid(View const& view, std::list<Point_t> const& path);                                       \
+  template void printGrid(View const& view, std::list<gridNode_t> const& path, gridNode_t start, gridNode_t end);  \
+  template std::list<Point_t> map_2_goals(View const& view);                                                       \
+  template std::list<Point_t> map_2_goals(View const& view, std::vector<int> const& labels, int component);        \
+  template void map_2_goals(View const& view, ArenaList<Point_t>& goals);                                          \
+  template void map_2_goals(View const& view, std::vector<int> const& labels, int component,                       \
+                            ArenaList<Point_t>& goals);                                                            \
+  template int mark_covered_tiles(View const& view, RowMajorGrid const& covered, float resolution,                 \
+                                  fPoint_t origin, float tile_size, fPoint_t grid_origin, float min_fraction);
+
+FCPP_INSTANTIATE_COMMON_VIEW(NestedVectorView)
+FCPP_INSTANTIATE_COMMON_VIEW(BitsetView)
+FCPP_INSTANTIATE_COMMON_VIEW(TiledView8)
+FCPP_INSTANTIATE_COMMON_VIEW(TiledView64)
+FCPP_INSTANTIATE_COMMON_VIEW(CostmapView<253>)
+FCPP_INSTANTIATE_COMMON_VIEW(CostmapView<254>)
+FCPP_INSTANTIATE_COMMON_VIEW(MappedView)
+FCPP_INSTANTIATE_COMMON_VIEW(LazyView)
+FCPP_INSTANTIATE_COMMON_VIEW(PagedView)
@@ -0,0 +1,234 @@
+//
+// Copyright [2020] Nobleo Technology"  [legal/copyright]
+//
+#include <stdint.h>
+#include <cstddef>
+#include <list>
+#include <stdexcept>
+#include <vector>
+
+#include <full_coverage_path_planner/compact_path.h>
+
+namespace full_coverage_path_planner
+{
+static const int dirX[] = { 1, 0, -1, 0 };  // NOLINT
+static const int dirY[] = { 0, 1, 0, -1 };  // NOLINT
+
+const int CompactPath::MAX_RUN;
+
+CompactPath::CompactPath()
+  : size_(0),
+    last_run_(0)
+{
+  front_.x = front_.y = back_.x = back_.y = 0;
+}
+
+CompactPath::CompactPath(std::list<Point_t> const& points)
+  : CompactPath()
+{
+  assign(points.begin(), points.end());
+}
+
+CompactPath::CompactPath(Point_t const& front, std::size_t size, std::vector<uint16_t> const& codes)
+  : codes_(codes),
+    size_(size),
+    front_(front),
+    back_(front),
+    last_run_(codes.size())
+{
+  // Walk the codes once to find the last point, and check that nothing is read past the end later on
+  std::size_t steps = 0, code = 0;
+  while (code < codes_.size())
+  {
+    if (codes_[code] == 0)
+    {
+      if (code + 5 > codes_.size())
+      {
+        throw std::invalid_argument("CompactPath: jump is cut off");
+      }
+      back_ = readJump(codes_, code);
+      last_run_ = codes_.size();
+      ++steps;
+    }
+    else
+    {
+      int length = codes_[code] >> 2;
+      if (length == 0)
+      {
+        throw std::invalid_argument("CompactPath: run without steps");
+      }
+      back_.x += dirX[codes_[code] & 3] * length;
+      back_.y += dirY[codes_[code] & 3] * length;
+      last_run_ = code++;
+      steps += length;
+    }
+  }
+  if ((size == 0 && !codes_.empty()) || (size > 0 && steps + 1 != size))
+  {
+    throw std::invalid_argument("CompactPath: codes do not match the number of points");
+  }
+}
+
+void CompactPath::clear()
+{
+  codes_.clear();
+  size_ = 0;
+  last_run_ = 0;
+}
+
+void CompactPath::shrink_to_fit()
+{
+  std::vector<uint16_t>(codes_).swap(codes_);
+}
+
+void CompactPath::push_back(Point_t const& point)
+{
+  if (size_ == 0)
+  {
+    front_ = back_ = point;
+    size_ = 1;
+    last_run_ = codes_.size();
+    return;
+  }
+
+  int dir = -1;
+  for (int d = 0; d < 4; ++d)
+  {
+    if (point.x - back_.x == dirX[d] && point.y - back_.y == dirY[d])
+    {
+      dir = d;
+    }
+  }
+  if (dir < 0)
+  {
+    pushJump(point);
+  }
+  else if (last_run_ < codes_.size() && (codes_[last_run_] & 3) == dir && (codes_[last_run_] >> 2) < MAX_RUN)
+  {
+    codes_[last_run_] += 4;
+  }
+  else
+  {
+    last_run_ = codes_.size();
+    codes_.push_back((1 << 2) | dir);
+  }
+  back_ = point;
+  ++size_;
+}
+
+void CompactPath::pushJump(Point_t const& point)
+{
+  uint32_t x = static_cast<uint32_t>(point.x), y = static_cast<uint32_t>(point.y);
+  codes_.push_back(0);
+  codes_.push_back(x & 0xffff);
+  codes_.push_back(x >> 16);
+  codes_.push_back(y & 0xffff);
+  codes_.push_back(y >> 16);
+  last_run_ = codes_.size();
+}
+
+Point_t CompactPath::readJump(std::vector<uint16_t> const& codes, std::size_t& code)
+{
+  Point_t point;
+  point.x = static_cast<int32_t>(codes[code + 1] | (static_cast<uint32_t>(codes[code + 2]) << 16));
+  point.y = static_cast<int32_t>(codes[code + 3] | (static_cast<uint32_t>(codes[code + 4]) << 16));
+  code += 5;
+  return point;
+}
+
+std::list<Point_t> CompactPath::toList() const
+{
+  return std::list<Point_t>(begin(), end());
+}
+
+CompactPath::const_iterator::const_iterator(CompactPath const* path, std::size_t index)
+  : path_(path),
+    index_(index),
+    code_(0),
+    remaining_(0),
+    dir_(0),
+    point_(path->front_)
+{
+}
+
+CompactPath::const_iterator& CompactPath::const_iterator::operator++()
+{
+  ++index_;
+  if (index_ >= path_->size_)
+  {
+    return *this;
+  }
+  if (remaining_ == 0)
+  {
+    uint16_t code = path_->codes_[code_];
+    if (code == 0)
+    {
+      point_ = readJump(path_->codes_, code_);
+      return *this;
+    }
+    dir_ = code & 3;
+    remaining_ = code >> 2;
+    ++code_;
+  }
+  point_.x += dirX[dir_];
+  point_.y += dirY[dir_];
+  --remaining_;
+  return *this;
+}
+
+CompactPath::RunReader::RunReader(CompactPath const& path)
+  : path_(path),
+    code_(0),
+    point_(path.front_)
+{
+}
+
+bool CompactPath::RunReader::next(run_t& run)
+{
+  if (code_ >= path_.codes_.size())
+  {
+    return false;
+  }
+  run.from = point_;
+  uint16_t code = path_.codes_[code_];
+  if (code == 0)
+  {
+    run.to = readJump(path_.codes_, code_);
+    run.dx = run.to.x - run.from.x;
+    run.dy = run.to.y - run.from.y;
+    run.length = 1;
+  }
+  else
+  {
+    run.dx = dirX[code & 3];
+    run.dy = dirY[code & 3];
+    run.length = code >> 2;
+    run.to.x = run.from.x + run.dx * run.length;
+    run.to.y = run.from.y + run.dy * run.length;
+    ++code_;
+  }
+  point_ = run.to;
+  return true;
+}
+
+int count_turns(CompactPath const& path)
+{
+  int turns = 0, dir_prev = 0;
+  CompactPath::RunReader runs(path);
+  CompactPath::run_t run;
+  while (runs.next(run))
+  {
+    int dir = run.dx + 2 * run.dy;  // dx + 2 * dy, like the eDir* directions
+    if (dir == 0)
+    {
+      continue;
+    }
+    if (dir_prev != 0 && dir != dir_prev)
+    {
+      turns += (dir == -dir_prev) ? 2 : 1;
+    }
+    dir_prev = dir;
+  }
+  return turns;
+}
+}  // namespace full_coverage_path_planner
@@ -0,0 +1,48 @@
+//
+// Copyright [2020] Nobleo Technology"  [legal/copyright]
+//
+#include <full_coverage_path_planner/compact_plan.h>
+
+namespace full_coverage_path_planner
+{
+void toCompactPlanMsg(geometry_msgs::PoseStamped const& start, CompactPath const& path, fPoint_t grid_origin,
+                      float tile_size, CompactPlan& msg)
+{
+  // The poses of the plan are in the map frame, see WaypointGenerator
+  msg.header.frame_id = "map";
+  msg.start = start;
+  msg.origin.x = grid_origin.x;
+  msg.origin.y = grid_origin.y;
+  msg.origin.z = 0;
+  msg.tile_size = tile_size;
+  msg.start_x = path.front().x;
+  msg.start_y = path.front().y;
+  msg.length = path.size();
+  msg.codes = path.codes();
+}
+
+CompactPlanDecoder::CompactPlanDecoder(CompactPlan const& msg)
+  : path_(Point_t{ msg.start_x, msg.start_y }, msg.length, msg.codes),  // NOLINT
+    start_(msg.start),
+    tile_size_(msg.tile_size),
+    frame_(msg.header.frame_id)
+{
+  // The origin was a float in the planner, so this gives the same positions
+  origin_.x = msg.origin.x;
+  origin_.y = msg.origin.y;
+}
+
+geometry_msgs::Point CompactPlanDecoder::position(Point_t const& tile) const
+{
+  geometry_msgs::Point point;
+  point.x = (tile.x) * tile_size_ + origin_.x + tile_size_ * 0.5;
+  point.y = (tile.y) * tile_size_ + origin_.y + tile_size_ * 0.5;
+  point.z = 0;
+  return point;
+}
+
+WaypointGenerator CompactPlanDecoder::waypoints() const
+{
+  return WaypointGenerator(start_, path_, tile_size_, origin_);
+}
+}  // namespace full_coverage_path_planner
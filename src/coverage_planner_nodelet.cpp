@@ -0,0 +1,54 @@
+//
+// Copyright [2020] Nobleo Technology"  [legal/copyright]
+//
+#include <string>
+#include <vector>
+
+#include <pluginlib/class_list_macros.h>
+
+#include "full_coverage_path_planner/boustrophedon.h"
+#include "full_coverage_path_planner/coverage_planner_nodelet.h"
+#include "full_coverage_path_planner/spiral_stc.h"
+
+// register this nodelet
+PLUGINLIB_EXPORT_CLASS(full_coverage_path_planner::CoveragePlannerNodelet, nodelet::Nodelet)
+
+namespace full_coverage_path_planner
+{
+void CoveragePlannerNodelet::onInit()
+{
+  ros::NodeHandle& nh = getNodeHandle();
+  ros::NodeHandle& private_nh = getPrivateNodeHandle();
+
+  // The planner takes its parameters from the private namespace of the nodelet and publishes the plans there
+  std::string planner;
+  private_nh.param<std::string>("planner", planner, "spiral_stc");
+  if (planner == "boustrophedon")
+  {
+    boost::shared_ptr<Boustrophedon> boustrophedon(new Boustrophedon());
+    boustrophedon->initialize(nh, private_nh);
+    planner_ = boustrophedon;
+  }
+  else
+  {
+    if (planner != "spiral_stc")
+    {
+      NODELET_WARN("Unknown planner '%s', using 'spiral_stc'", planner.c_str());
+    }
+    boost::shared_ptr<SpiralSTC> spiral(new SpiralSTC());
+    spiral->initialize(nh, private_nh);
+    planner_ = spiral;
+  }
+  start_sub_ = private_nh.subscribe("start", 1, &CoveragePlannerNodelet::startCallback, this);
+}
+
+void CoveragePlannerNodelet::startCallback(const geometry_msgs::PoseStamped::ConstPtr& start)
+{
+  // A coverage plan has no goal, the start is passed for both
+  std::vector<geometry_msgs::PoseStamped> plan;
+  if (!planner_->makePlan(*start, *start, plan))
+  {
+    NODELET_ERROR("No coverage plan from (%f, %f)", start->pose.position.x, start->pose.position.y);
+  }
+}
+}  // namespace full_coverage_path_planner
@@ -1,7 +1,9 @@
 //
 // Copyright [2020] Nobleo Technology"  [legal/copyright]
 //
+#include <climits>
 #include <list>
+#include <string>
 #include <vector>
 
 #include "full_coverage_path_planner/full_coverage_path_planner.h"
@@ -32,7 +34,8 @@
 // Default Constructor
 namespace full_coverage_path_planner
 {
-FullCoveragePathPlanner::FullCoveragePathPlanner() : initialized_(false)
+FullCoveragePathPlanner::FullCoveragePathPlanner()
+  : linear_velocity_(0.2f), turn_duration_(2.0f), circular_footprint_(false), initialized_(false)
 {
 }
 
@@ -43,185 +46,274 @@ void FullCoveragePathPlanner::publishPlan(const std::vector<geometry_msgs::PoseS
     ROS_ERROR("This planner has not been initialized yet, but it is being used, please call initialize() before use");
     return;
   }
+  if (plan_pub_.getNumSubscribers() == 0)
+  {
+    // A big plan takes long to serialize, don't bother if no one listens
+    return;
+  }
 
   // create a message for the plan
-  nav_msgs::Path gui_path;
-  gui_path.poses.resize(path.size());
+  nav_msgs::Path::Ptr gui_path(new nav_msgs::Path());
+  gui_path->poses.resize(path.size());
 
   if (!path.empty())
   {
-    gui_path.header.frame_id = path[0].header.frame_id;
-    gui_path.header.stamp = path[0].header.stamp;
+    gui_path->header.frame_id = path[0].header.frame_id;
+    gui_path->header.stamp = path[0].header.stamp;
   }
 
   // Extract the plan in world co-ordinates, we assume the path is all in the same frame
   for (unsigned int i = 0; i < path.size(); i++)
   {
-    gui_path.poses[i] = path[i];
+    gui_path->poses[i] = path[i];
   }
 
-  plan_pub_.publish(gui_path);
+  // Subscribers in the same process, like nodelets, get the message itself instead of a serialized copy
+  plan_pub_.publish(nav_msgs::Path::ConstPtr(gui_path));
+}
+
+void FullCoveragePathPlanner::publishCompactPlan(const geometry_msgs::PoseStamped& start, CompactPath const& path)
+{
+  if (!initialized_ || compact_plan_pub_.getNumSubscribers() == 0)
+  {
+    return;
+  }
+  CompactPlan::Ptr msg(new CompactPlan());
+  toCompactPlanMsg(start, path, grid_origin_, tile_size_, *msg);
+  msg->header.stamp = ros::Time::now();
+  compact_plan_pub_.publish(CompactPlan::ConstPtr(msg));
 }
 
 void FullCoveragePathPlanner::parsePointlist2Plan(const geometry_msgs::PoseStamped& start,
     std::list<Point_t> const& goalpoints,
     std::vector<geometry_msgs::PoseStamped>& plan)
 {
-  geometry_msgs::PoseStamped new_goal;
-  std::list<Point_t>::const_iterator it, it_next, it_prev;
-  int dx_now, dy_now, dx_next, dy_next, move_dir_now = 0, move_dir_prev = 0, move_dir_next = 0;
-  bool do_publish = false;
-  float orientation = eDirNone;
+  parsePointlist2Plan(start, CompactPath(goalpoints), plan);
+}
+
+void FullCoveragePathPlanner::parsePointlist2Plan(const geometry_msgs::PoseStamped& start,
+    CompactPath const& goalpoints,
+    std::vector<geometry_msgs::PoseStamped>& plan)
+{
   ROS_INFO("Received goalpoints with length: %lu", goalpoints.size());
-  if (goalpoints.size() > 1)
+  WaypointGenerator generator = waypoints(start, goalpoints);
+  plan.reserve(plan.size() + generator.size());
+  geometry_msgs::PoseStamped pose;
+  while (generator.next(pose))
+  {
+    plan.push_back(pose);
+  }
+  ROS_INFO("Plan ready containing %lu goals!", plan.size());
+}
+
+WaypointGenerator FullCoveragePathPlanner::waypoints(const geometry_msgs::PoseStamped& start,
+                                                     CompactPath const& goalpoints) const
+{
+  return WaypointGenerator(start, goalpoints, tile_size_, grid_origin_);
+}
+
+bool FullCoveragePathPlanner::parseGridBounds(nav_msgs::OccupancyGrid const& cpp_grid_,
+                                              uint32_t nodeSize,
+                                              geometry_msgs::PoseStamped const& realStart,
+                                              std::vector<fPoint_t>& zone,
+                                              int& firstColl,
+                                              int& firstRow,
+                                              int& endColl,
+                                              int& endRow,
+                                              Point_t& scaledStart)
+{
+  uint32_t nRows = cpp_grid_.info.height, nCols = cpp_grid_.info.width;
+  ROS_INFO("nRows: %u nCols: %u nodeSize: %d", nRows, nCols, nodeSize);
+
+  if (nRows == 0 || nCols == 0)
+  {
+    return false;
+  }
+
+  // Only parse the tiles that overlap the bounding box of the coverage zone, on the same tiling as the whole map
+  {
+    std::lock_guard<std::mutex> lock(coverage_zone_mutex_);
+    zone = coverage_zone_;
+  }
+  firstColl = 0;
+  firstRow = 0;
+  endColl = nCols;
+  endRow = nRows;
+  if (!zone.empty())
   {
-    for (it = goalpoints.begin(); it != goalpoints.end(); ++it)
+    fPoint_t lower = zone[0], upper = zone[0];
+    for (int i = 1; i < zone.size(); ++i)
+    {
+      lower.x = dmin(lower.x, zone[i].x);
+      lower.y = dmin(lower.y, zone[i].y);
+      upper.x = dmax(upper.x, zone[i].x);
+      upper.y = dmax(upper.y, zone[i].y);
+    }
+    float resolution = cpp_grid_.info.resolution;
+    firstColl = clamp(floor((lower.x - cpp_grid_.info.origin.position.x) / resolution / nodeSize) * nodeSize,
+                      0, static_cast<int>(nCols));
+    firstRow = clamp(floor((lower.y - cpp_grid_.info.origin.position.y) / resolution / nodeSize) * nodeSize,
+                     0, static_cast<int>(nRows));
+    endColl = clamp(ceil((upper.x - cpp_grid_.info.origin.position.x) / resolution), 0, static_cast<int>(nCols));
+    endRow = clamp(ceil((upper.y - cpp_grid_.info.origin.position.y) / resolution), 0, static_cast<int>(nRows));
+    if (firstColl >= endColl || firstRow >= endRow)
     {
-      it_next = it;
-      it_next++;
-      it_prev = it;
-      it_prev--;
+      ROS_ERROR("The coverage zone does not overlap the map");
+      return false;
+    }
+  }
+  int nTileColls = (endColl - firstColl + nodeSize - 1) / nodeSize;
+  int nTileRows = (endRow - firstRow + nodeSize - 1) / nodeSize;
 
-      // Check for the direction of movement
-      if (it == goalpoints.begin())
-      {
-        dx_now = it_next->x - it->x;
-        dy_now = it_next->y - it->y;
-      }
-      else
-      {
-        dx_now = it->x - it_prev->x;
-        dy_now = it->y - it_prev->y;
-        dx_next = it_next->x - it->x;
-        dy_next = it_next->y - it->y;
-      }
+  // Save map origin and scaling
+  tile_size_ = nodeSize * cpp_grid_.info.resolution;  // Size of a tile in meters
+  grid_origin_.x = cpp_grid_.info.origin.position.x + firstColl * cpp_grid_.info.resolution;  // x-origin in meters
+  grid_origin_.y = cpp_grid_.info.origin.position.y + firstRow * cpp_grid_.info.resolution;  // y-origin in meters
+
+  // Scale starting point
+  scaledStart.x = static_cast<unsigned int>(clamp((realStart.pose.position.x - grid_origin_.x) / tile_size_, 0.0,
+                             nTileColls - 1.0));
+  scaledStart.y = static_cast<unsigned int>(clamp((realStart.pose.position.y - grid_origin_.y) / tile_size_, 0.0,
+                             nTileRows - 1.0));
+  return true;
+}
 
-      // Calculate direction enum: dx + dy*2 will give a unique number for each of the four possible directions because
-      // of their signs:
-      //  1 +  0*2 =  1
-      //  0 +  1*2 =  2
-      // -1 +  0*2 = -1
-      //  0 + -1*2 = -2
-      move_dir_now = dx_now + dy_now * 2;
-      move_dir_next = dx_next + dy_next * 2;
-
-      // Check if this points needs to be published (i.e. a change of direction or first or last point in list)
-      do_publish = move_dir_next != move_dir_now || it == goalpoints.begin() ||
-                   (it != goalpoints.end() && it == --goalpoints.end());
-      move_dir_prev = move_dir_now;
-
-      // Add to vector if required
-      if (do_publish)
+template <class Grid>
+bool FullCoveragePathPlanner::moveStartIntoZone(Grid const& grid, geometry_msgs::PoseStamped const& realStart,
+                                                Point_t& scaledStart)
+{
+  if (!gridGet(grid, scaledStart.x, scaledStart.y))
+  {
+    return true;
+  }
+  fPoint_t start = { static_cast<float>((realStart.pose.position.x - grid_origin_.x) / tile_size_ - 0.5),  // NOLINT
+                     static_cast<float>((realStart.pose.position.y - grid_origin_.y) / tile_size_ - 0.5) };
+  // Look at the tiles in square rings around the clamped start, which is less than a tile from the closest point of
+  // the grid to start. A tile in ring r is at least r - 1 tiles further than that point, so once that is further
+  // than the closest free tile found, no other tile can be closer. Only the tiles up to there are read, which matters
+  // for a lazily evaluated grid. Ties go to the first tile in row-major order
+  int nCols = gridWidth(grid), nRows = gridHeight(grid);
+  Point_t center = scaledStart;
+  int rings = dmax(dmax(center.x, nCols - 1 - center.x), dmax(center.y, nRows - 1 - center.y));
+  float closest = -1;
+  for (int r = 0; r <= rings && (closest < 0 || (r - 1.0f) * (r - 1.0f) <= closest); ++r)
+  {
+    for (int iy = dmax(center.y - r, 0); iy <= dmin(center.y + r, nRows - 1); ++iy)
+    {
+      // All tiles of the first and last row of the ring, only the first and last tile of the rows in between
+      int step = (iy == center.y - r || iy == center.y + r) ? 1 : 2 * r;
+      for (int ix = center.x - r; ix <= center.x + r; ix += step)
       {
-        new_goal.header.frame_id = "map";
-        new_goal.pose.position.x = (it->x) * tile_size_ + grid_origin_.x + tile_size_ * 0.5;
-        new_goal.pose.position.y = (it->y) * tile_size_ + grid_origin_.y + tile_size_ * 0.5;
-        // Calculate desired orientation to be in line with movement direction
-        switch (move_dir_now)
+        if (ix < 0 || ix >= nCols)
         {
-        case eDirNone:
-          // Keep orientation
-          break;
-        case eDirRight:
-          orientation = 0;
-          break;
-        case eDirUp:
-          orientation = M_PI / 2;
-          break;
-        case eDirLeft:
-          orientation = M_PI;
-          break;
-        case eDirDown:
-          orientation = M_PI * 1.5;
-          break;
+          continue;
         }
-        new_goal.pose.orientation = tf::createQuaternionMsgFromYaw(orientation);
-        if (it != goalpoints.begin())
+        float d = (ix - start.x) * (ix - start.x) + (iy - start.y) * (iy - start.y);
+        bool closer = closest < 0 || d < closest
+                      || (d == closest && (iy < scaledStart.y || (iy == scaledStart.y && ix < scaledStart.x)));
+        if (closer && !gridGet(grid, ix, iy))
         {
-          previous_goal_.pose.orientation = new_goal.pose.orientation;
-          // republish previous goal but with new orientation to indicate change of direction
-          // useful when the plan is strictly followed with base_link
-          plan.push_back(previous_goal_);
+          closest = d;
+          scaledStart.x = ix;
+          scaledStart.y = iy;
         }
-        ROS_DEBUG("Voila new point: x=%f, y=%f, o=%f,%f,%f,%f", new_goal.pose.position.x, new_goal.pose.position.y,
-                  new_goal.pose.orientation.x, new_goal.pose.orientation.y, new_goal.pose.orientation.z,
-                  new_goal.pose.orientation.w);
-        plan.push_back(new_goal);
-        previous_goal_ = new_goal;
       }
     }
   }
-  else
-  {
-    new_goal.header.frame_id = "map";
-    new_goal.pose.position.x = (goalpoints.begin()->x) * tile_size_ + grid_origin_.x + tile_size_ * 0.5;
-    new_goal.pose.position.y = (goalpoints.begin()->y) * tile_size_ + grid_origin_.y + tile_size_ * 0.5;
-    new_goal.pose.orientation = tf::createQuaternionMsgFromYaw(0);
-    plan.push_back(new_goal);
-  }
-  /* Add poses from current position to start of plan */
-
-  // Compute angle between current pose and first plan point
-  double dy = plan.begin()->pose.position.y - start.pose.position.y;
-  double dx = plan.begin()->pose.position.x - start.pose.position.x;
-  // Arbitrary choice of 100.0*FLT_EPSILON to determine minimum angle precision of 1%
-  if (!(fabs(dy) < 100.0 * FLT_EPSILON && fabs(dx) < 100.0 * FLT_EPSILON))
-  {
-    // Add extra translation waypoint
-    double yaw = std::atan2(dy, dx);
-    geometry_msgs::Quaternion quat_temp = tf::createQuaternionMsgFromYaw(yaw);
-    geometry_msgs::PoseStamped extra_pose;
-    extra_pose = *plan.begin();
-    extra_pose.pose.orientation = quat_temp;
-    plan.insert(plan.begin(), extra_pose);
-    extra_pose = start;
-    extra_pose.pose.orientation = quat_temp;
-    plan.insert(plan.begin(), extra_pose);
-  }
-
-  // Insert current pose
-  plan.insert(plan.begin(), start);
-
-  ROS_INFO("Plan ready containing %lu goals!", plan.size());
+  return closest >= 0;
 }
 
+template <class Grid>
 bool FullCoveragePathPlanner::parseGrid(nav_msgs::OccupancyGrid const& cpp_grid_,
-                                        std::vector<std::vector<bool> >& grid,
+                                        Grid& grid,
                                         float robotRadius,
                                         float toolRadius,
                                         geometry_msgs::PoseStamped const& realStart,
-                                        Point_t& scaledStart)
+                                        Point_t& scaledStart,
+                                        CostGrid* costs)
 {
   int ix, iy, nodeRow, nodeColl;
   uint32_t nodeSize = dmax(floor(toolRadius / cpp_grid_.info.resolution), 1);  // Size of node in pixels/units
   uint32_t robotNodeSize = dmax(floor(robotRadius / cpp_grid_.info.resolution), 1);  // RobotRadius in pixels/units
   uint32_t nRows = cpp_grid_.info.height, nCols = cpp_grid_.info.width;
-  ROS_INFO("nRows: %u nCols: %u nodeSize: %d", nRows, nCols, nodeSize);
-
-  if (nRows == 0 || nCols == 0)
+  std::vector<fPoint_t> zone;
+  int firstColl, firstRow, endColl, endRow;
+  if (!parseGridBounds(cpp_grid_, nodeSize, realStart, zone, firstColl, firstRow, endColl, endRow, scaledStart))
   {
     return false;
   }
+  int nTileColls = (endColl - firstColl + nodeSize - 1) / nodeSize;
+  int nTileRows = (endRow - firstRow + nodeSize - 1) / nodeSize;
 
-  // Save map origin and scaling
-  tile_size_ = nodeSize * cpp_grid_.info.resolution;  // Size of a tile in meters
-  grid_origin_.x = cpp_grid_.info.origin.position.x;  // x-origin in meters
-  grid_origin_.y = cpp_grid_.info.origin.position.y;  // y-origin in meters
-
-  // Scale starting point
-  scaledStart.x = static_cast<unsigned int>(clamp((realStart.pose.position.x - grid_origin_.x) / tile_size_, 0.0,
-                             floor(cpp_grid_.info.width / tile_size_)));
-  scaledStart.y = static_cast<unsigned int>(clamp((realStart.pose.position.y - grid_origin_.y) / tile_size_, 0.0,
-                             floor(cpp_grid_.info.height / tile_size_)));
+  // With a circular footprint, a tile is occupied if an occupied cell is closer to its center than the robot radius.
+  // The distances are computed once for the parsed area and a margin of the robot radius around it
+  float robotCells = robotRadius / 2 / cpp_grid_.info.resolution;  // Radius of the robot in cells
+  uint32_t boxNodeSize = circular_footprint_ ? 0 : robotNodeSize;  // Side of the square footprint checked per tile
+  int dtFirstColl = 0, dtFirstRow = 0, dtWidth = 0, dtHeight = 0;
+  std::vector<int> distances;
+  if (circular_footprint_)
+  {
+    int margin = ceil(robotCells) + 1;
+    dtFirstColl = dmax(firstColl - margin, 0);
+    dtFirstRow = dmax(firstRow - margin, 0);
+    dtWidth = dmin(endColl + margin, static_cast<int>(nCols)) - dtFirstColl;
+    dtHeight = dmin(endRow + margin, static_cast<int>(nRows)) - dtFirstRow;
+    std::vector<bool> occupied(dtWidth * dtHeight);
+    for (iy = 0; iy < dtHeight; ++iy)
+    {
+      for (ix = 0; ix < dtWidth; ++ix)
+      {
+        occupied[iy * dtWidth + ix] = cpp_grid_.data[(iy + dtFirstRow) * nCols + ix + dtFirstColl] > 65;
+      }
+    }
+    squared_distance_transform(occupied, dtWidth, dtHeight, distances);
+  }
 
   // Scale grid
-  for (iy = 0; iy < nRows; iy = iy + nodeSize)
+  if (costs)
   {
-    std::vector<bool> gridRow;
-    for (ix = 0; ix < nCols; ix = ix + nodeSize)
+    *costs = CostGrid(nTileColls, nTileRows);
+  }
+  // The grid is allocated once and filled in place
+  gridAssign(grid, nTileColls, nTileRows, false);
+  int tileRow = 0, tileColl;
+  for (iy = firstRow; iy < endRow; iy = iy + nodeSize, ++tileRow)
+  {
+    for (ix = firstColl, tileColl = 0; ix < endColl; ix = ix + nodeSize, ++tileColl)
     {
       bool nodeOccupied = false;
-      for (nodeRow = 0; (nodeRow < robotNodeSize) && ((iy + nodeRow) < nRows) && (nodeOccupied == false); ++nodeRow)
+      int8_t nodeCost = 0;
+      if (!zone.empty())
+      {
+        fPoint_t center = { grid_origin_.x + (tileColl + 0.5f) * tile_size_,  // NOLINT
+                            grid_origin_.y + (tileRow + 0.5f) * tile_size_ };
+        nodeOccupied = !point_in_polygon(center, zone);
+      }
+      if (circular_footprint_ && !nodeOccupied)
+      {
+        // The center of the tile is in the middle of one cell, or between four if nodeSize is even
+        int centerColl = dmin(ix + (nodeSize - 1) / 2, nCols - 1) - dtFirstColl;
+        int centerRow = dmin(iy + (nodeSize - 1) / 2, nRows - 1) - dtFirstRow;
+        int centerSize = (nodeSize % 2 == 0) ? 2 : 1;
+        int d2 = INT_MAX;
+        for (nodeRow = centerRow; nodeRow < dmin(centerRow + centerSize, dtHeight); ++nodeRow)
+        {
+          for (nodeColl = centerColl; nodeColl < dmin(centerColl + centerSize, dtWidth); ++nodeColl)
+          {
+            d2 = dmin(d2, distances[nodeRow * dtWidth + nodeColl]);
+          }
+        }
+        nodeOccupied = d2 < robotCells * robotCells;
+        // The cost is that of the tile itself, the highest cost under the robot would take a loop over the footprint
+        for (nodeRow = 0; (nodeRow < nodeSize) && ((iy + nodeRow) < nRows) && costs && !nodeOccupied; ++nodeRow)
+        {
+          for (nodeColl = 0; (nodeColl < nodeSize) && ((ix + nodeColl) < nCols); ++nodeColl)
+          {
+            nodeCost = dmax(nodeCost, cpp_grid_.data[(iy + nodeRow) * nCols + ix + nodeColl]);
+          }
+        }
+      }
+      for (nodeRow = 0; (nodeRow < boxNodeSize) && ((iy + nodeRow) < nRows) && (nodeOccupied == false); ++nodeRow)
       {
         for (nodeColl = 0; (nodeColl < robotNodeSize) && ((ix + nodeColl) < nCols); ++nodeColl)
         {
@@ -232,12 +324,164 @@ bool FullCoveragePathPlanner::parseGrid(nav_msgs::OccupancyGrid const& cpp_grid_
             nodeOccupied = true;
             break;
           }
+          nodeCost = dmax(nodeCost, cpp_grid_.data[index_grid]);  // Unknown (-1) counts as free
         }
       }
-      gridRow.push_back(nodeOccupied);
+      if (costs)
+      {
+        costs->set(tileColl, tileRow, nodeCost);
+      }
+      gridSet(grid, tileColl, tileRow, nodeOccupied);
     }
-    grid.push_back(gridRow);
+  }
+
+  // Start from the closest free tile in the zone if the robot is outside of it
+  if (!zone.empty() && !moveStartIntoZone(grid, realStart, scaledStart))
+  {
+    ROS_ERROR("No free tile in the coverage zone");
+    return false;
+  }
+  return true;
+}
+
+template bool FullCoveragePathPlanner::parseGrid(nav_msgs::OccupancyGrid const& cpp_grid_,
+                                                 std::vector<std::vector<bool> >& grid, float robotRadius,
+                                                 float toolRadius, geometry_msgs::PoseStamped const& realStart,
+                                                 Point_t& scaledStart, CostGrid* costs);
+template bool FullCoveragePathPlanner::parseGrid(nav_msgs::OccupancyGrid const& cpp_grid_, RowMajorGrid& grid,
+                                                 float robotRadius, float toolRadius,
+                                                 geometry_msgs::PoseStamped const& realStart, Point_t& scaledStart,
+                                                 CostGrid* costs);
+
+bool FullCoveragePathPlanner::parseGridLazily(nav_msgs::OccupancyGrid const& cpp_grid_,
+                                              LazyOccupancyGrid& grid,
+                                              float robotRadius,
+                                              float toolRadius,
+                                              geometry_msgs::PoseStamped const& realStart,
+                                              Point_t& scaledStart)
+{
+  uint32_t nodeSize = dmax(floor(toolRadius / cpp_grid_.info.resolution), 1);  // Size of node in pixels/units
+  uint32_t robotNodeSize = dmax(floor(robotRadius / cpp_grid_.info.resolution), 1);  // RobotRadius in pixels/units
+  std::vector<fPoint_t> zone;
+  int firstColl, firstRow, endColl, endRow;
+  if (!parseGridBounds(cpp_grid_, nodeSize, realStart, zone, firstColl, firstRow, endColl, endRow, scaledStart))
+  {
+    return false;
+  }
+  int nTileColls = (endColl - firstColl + nodeSize - 1) / nodeSize;
+  int nTileRows = (endRow - firstRow + nodeSize - 1) / nodeSize;
+  grid = LazyOccupancyGrid(&cpp_grid_.data[0], cpp_grid_.info.width, cpp_grid_.info.height, firstColl, firstRow,
+                           nTileColls, nTileRows, nodeSize);
+  if (circular_footprint_)
+  {
+    grid.setCircularFootprint(robotRadius / 2 / cpp_grid_.info.resolution);
+  }
+  else
+  {
+    grid.setSquareFootprint(robotNodeSize);
+  }
+  grid.setZone(zone, grid_origin_, tile_size_);
+
+  // Start from the closest free tile in the zone if the robot is outside of it. This evaluates the tiles up to that
+  // one before the planner gets to them
+  if (!zone.empty() && !moveStartIntoZone(grid, realStart, scaledStart))
+  {
+    ROS_ERROR("No free tile in the coverage zone");
+    return false;
   }
   return true;
 }
+
+void FullCoveragePathPlanner::initializeZones(ros::NodeHandle& nh)
+{
+  // The registry is a map from zone ID to the vertices of its polygon in the map frame, e.g. kitchen: [[0, 0], [4, 0],
+  // [4, 3], [0, 3]]
+  XmlRpc::XmlRpcValue zones;
+  if (nh.getParam("zones", zones) && zones.getType() == XmlRpc::XmlRpcValue::TypeStruct)
+  {
+    for (XmlRpc::XmlRpcValue::iterator it = zones.begin(); it != zones.end(); ++it)
+    {
+      XmlRpc::XmlRpcValue& vertices = it->second;
+      std::vector<fPoint_t> polygon;
+      bool valid = vertices.getType() == XmlRpc::XmlRpcValue::TypeArray && vertices.size() >= 3;
+      for (int i = 0; valid && i < vertices.size(); ++i)
+      {
+        valid = vertices[i].getType() == XmlRpc::XmlRpcValue::TypeArray && vertices[i].size() == 2;
+        fPoint_t vertex = { 0, 0 };  // NOLINT
+        for (int j = 0; valid && j < 2; ++j)
+        {
+          XmlRpc::XmlRpcValue& value = vertices[i][j];
+          valid = value.getType() == XmlRpc::XmlRpcValue::TypeDouble ||
+                  value.getType() == XmlRpc::XmlRpcValue::TypeInt;
+          if (valid)
+          {
+            float coordinate = (value.getType() == XmlRpc::XmlRpcValue::TypeInt) ? static_cast<int>(value)
+                                                                                 : static_cast<double>(value);
+            (j == 0 ? vertex.x : vertex.y) = coordinate;
+          }
+        }
+        polygon.push_back(vertex);
+      }
+      if (valid)
+      {
+        zones_[it->first] = polygon;
+      }
+      else
+      {
+        ROS_WARN("Zone '%s' is not a list of at least 3 [x, y] points, skipping it", it->first.c_str());
+      }
+    }
+  }
+
+  std_msgs::String zone;
+  nh.param<std::string>("zone", zone.data, "");
+  zoneCallback(zone);
+  zone_sub_ = nh.subscribe("zone", 1, &FullCoveragePathPlanner::zoneCallback, this);
+  coverage_polygon_sub_ = nh.subscribe("coverage_polygon", 1, &FullCoveragePathPlanner::coveragePolygonCallback, this);
+}
+
+void FullCoveragePathPlanner::zoneCallback(const std_msgs::String& zone)
+{
+  std::lock_guard<std::mutex> lock(coverage_zone_mutex_);
+  std::map<std::string, std::vector<fPoint_t> >::const_iterator it = zones_.find(zone.data);
+  if (it != zones_.end())
+  {
+    ROS_INFO("Covering zone '%s'", zone.data.c_str());
+    coverage_zone_ = it->second;
+    return;
+  }
+  if (!zone.data.empty())
+  {
+    ROS_WARN("Unknown zone '%s', covering the whole map", zone.data.c_str());
+  }
+  coverage_zone_.clear();
+}
+
+void FullCoveragePathPlanner::coveragePolygonCallback(const geometry_msgs::PolygonStamped& polygon)
+{
+  if (!polygon.header.frame_id.empty() && polygon.header.frame_id != "map")
+  {
+    ROS_WARN("Coverage polygon is in frame '%s', it is used as if it is in the map frame",
+             polygon.header.frame_id.c_str());
+  }
+  std::lock_guard<std::mutex> lock(coverage_zone_mutex_);
+  coverage_zone_.clear();
+  if (polygon.polygon.points.size() >= 3)
+  {
+    for (int i = 0; i < polygon.polygon.points.size(); ++i)
+    {
+      fPoint_t vertex = { polygon.polygon.points[i].x, polygon.polygon.points[i].y };  // NOLINT
+      coverage_zone_.push_back(vertex);
+    }
+  }
+}
+
+void FullCoveragePathPlanner::updateExecutionMetrics(CompactPath const& path)
+{
+  // Straight driving at linear_velocity_ plus a fixed duration per 90 degree turn in place
+  int steps = path.empty() ? 0 : path.size() - 1;
+  spiral_cpp_metrics_.turn_counter = count_turns(path);
+  spiral_cpp_metrics_.estimated_execution_time = steps * tile_size_ / linear_velocity_
+                                                 + spiral_cpp_metrics_.turn_counter * turn_duration_;
+}
 }  // namespace full_coverage_path_planner
@@ -0,0 +1,373 @@
+//
+// Copyright [2020] Nobleo Technology"  [legal/copyright]
+//
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <list>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include <full_coverage_path_planner/hierarchical_search.h>
+#include <full_coverage_path_planner/lazy_occupancy_grid.h>
+#include <full_coverage_path_planner/mapped_grid.h>
+
+// Border segments shorter than this get a single entrance in the middle, longer ones an entrance at each end
+#define HPA_MAX_SINGLE_ENTRANCE_LENGTH 6
+
+namespace full_coverage_path_planner
+{
+template <class View>
+HierarchicalSearch<View>::HierarchicalSearch(View const& view, int cluster_size)
+  : view_(view),
+    clusterSize_(std::max(cluster_size, 2)),
+    nRows_(view.height()),
+    nCols_(view.width())
+{
+  nClusterCols_ = (nCols_ + clusterSize_ - 1) / clusterSize_;
+  nClusterRows_ = (nRows_ + clusterSize_ - 1) / clusterSize_;
+  clusterEntrances_.resize(nClusterCols_ * nClusterRows_);
+  entranceAt_.assign(nRows_ * nCols_, -1);
+  openCount_.assign(nClusterCols_ * nClusterRows_, 0);
+  bfs_dist_.resize(clusterSize_ * clusterSize_);
+  bfs_parent_.resize(clusterSize_ * clusterSize_);
+  bfs_queue_.reserve(clusterSize_ * clusterSize_);
+
+  // Scan the borders between horizontally neighboring clusters for runs of free node pairs
+  for (int cx = 1; cx < nClusterCols_; ++cx)
+  {
+    int x = cx * clusterSize_ - 1;
+    for (int cy = 0; cy < nClusterRows_; ++cy)
+    {
+      int y_end = std::min((cy + 1) * clusterSize_, nRows_);
+      int run = 0;
+      for (int y = cy * clusterSize_; y <= y_end; ++y)
+      {
+        if (y < y_end && !view_.blocked(x, y) && !view_.blocked(x + 1, y))
+        {
+          run++;
+          continue;
+        }
+        if (run > 0)
+        {
+          Point_t first = { x, y - run };
+          Point_t step = { 0, 1 };
+          Point_t across = { 1, 0 };
+          addTransitions(first, step, across, run);
+        }
+        run = 0;
+      }
+    }
+  }
+
+  // Same for vertically neighboring clusters
+  for (int cy = 1; cy < nClusterRows_; ++cy)
+  {
+    int y = cy * clusterSize_ - 1;
+    for (int cx = 0; cx < nClusterCols_; ++cx)
+    {
+      int x_end = std::min((cx + 1) * clusterSize_, nCols_);
+      int run = 0;
+      for (int x = cx * clusterSize_; x <= x_end; ++x)
+      {
+        if (x < x_end && !view_.blocked(x, y) && !view_.blocked(x, y + 1))
+        {
+          run++;
+          continue;
+        }
+        if (run > 0)
+        {
+          Point_t first = { x - run, y };
+          Point_t step = { 1, 0 };
+          Point_t across = { 0, 1 };
+          addTransitions(first, step, across, run);
+        }
+        run = 0;
+      }
+    }
+  }
+
+  // Precompute the cost of traveling between entrances within each cluster
+  for (int c = 0; c < clusterEntrances_.size(); ++c)
+  {
+    std::vector<int> const& members = clusterEntrances_[c];
+    for (int i = 0; i < members.size(); ++i)
+    {
+      clusterBfs(entrances_[members[i]].pos, c, false, -1);
+      for (int j = 0; j < members.size(); ++j)
+      {
+        int d = bfs_dist_[localIndex(c, entrances_[members[j]].pos)];
+        if (i != j && d > 0)
+        {
+          entrances_[members[i]].edges.push_back(std::make_pair(members[j], d));
+        }
+      }
+    }
+  }
+}
+
+template <class View>
+int HierarchicalSearch<View>::clusterOf(int x, int y) const
+{
+  return (y / clusterSize_) * nClusterCols_ + (x / clusterSize_);
+}
+
+template <class View>
+int HierarchicalSearch<View>::localIndex(int cluster, Point_t p) const
+{
+  int x0 = (cluster % nClusterCols_) * clusterSize_;
+  int y0 = (cluster / nClusterCols_) * clusterSize_;
+  return (p.y - y0) * clusterSize_ + (p.x - x0);
+}
+
+template <class View>
+int HierarchicalSearch<View>::addEntrance(int x, int y)
+{
+  int& index = entranceAt_[y * nCols_ + x];
+  if (index < 0)
+  {
+    index = entrances_.size();
+    entrance_t entrance;
+    entrance.pos.x = x;
+    entrance.pos.y = y;
+    entrance.cluster = clusterOf(x, y);
+    entrances_.push_back(entrance);
+    clusterEntrances_[entrance.cluster].push_back(index);
+  }
+  return index;
+}
+
+template <class View>
+void HierarchicalSearch<View>::addTransitions(Point_t first, Point_t step, Point_t across, int length)
+{
+  std::vector<int> offsets;
+  if (length < HPA_MAX_SINGLE_ENTRANCE_LENGTH)
+  {
+    offsets.push_back(length / 2);
+  }
+  else
+  {
+    offsets.push_back(0);
+    offsets.push_back(length - 1);
+  }
+
+  for (int i = 0; i < offsets.size(); ++i)
+  {
+    int x = first.x + offsets[i] * step.x;
+    int y = first.y + offsets[i] * step.y;
+    int a = addEntrance(x, y);
+    int b = addEntrance(x + across.x, y + across.y);
+    entrances_[a].edges.push_back(std::make_pair(b, 1));
+    entrances_[b].edges.push_back(std::make_pair(a, 1));
+  }
+}
+
+template <class View>
+void HierarchicalSearch<View>::initOpenCounts()
+{
+  std::fill(openCount_.begin(), openCount_.end(), 0);
+  for (int iy = 0; iy < nRows_; ++iy)
+  {
+    for (int ix = 0; ix < nCols_; ++ix)
+    {
+      if (!view_.blocked(ix, iy) && !view_.visited(ix, iy))
+      {
+        openCount_[clusterOf(ix, iy)]++;
+      }
+    }
+  }
+}
+
+template <class View>
+void HierarchicalSearch<View>::markVisited(int x, int y)
+{
+  openCount_[clusterOf(x, y)]--;
+}
+
+template <class View>
+int HierarchicalSearch<View>::clusterBfs(Point_t from, int cluster, bool to_open, int target)
+{
+  int x0 = (cluster % nClusterCols_) * clusterSize_;
+  int y0 = (cluster / nClusterCols_) * clusterSize_;
+  int x1 = std::min(x0 + clusterSize_, nCols_);
+  int y1 = std::min(y0 + clusterSize_, nRows_);
+  static const int dirs[4][2] = { { 0, 1 }, { -1, 0 }, { 0, -1 }, { 1, 0 } };  // NOLINT
+
+  std::fill(bfs_dist_.begin(), bfs_dist_.end(), -1);
+  bfs_queue_.clear();
+  int start = localIndex(cluster, from);
+  bfs_dist_[start] = 0;
+  bfs_parent_[start] = -1;
+  bfs_queue_.push_back(start);
+
+  for (int head = 0; head < bfs_queue_.size(); ++head)
+  {
+    int local = bfs_queue_[head];
+    int x = x0 + local % clusterSize_;
+    int y = y0 + local / clusterSize_;
+    if (local == target || (to_open && !view_.visited(x, y)))
+    {
+      return local;
+    }
+    for (int i = 0; i < 4; ++i)
+    {
+      int x2 = x + dirs[i][0];
+      int y2 = y + dirs[i][1];
+      if (x2 >= x0 && x2 < x1 && y2 >= y0 && y2 < y1 && !view_.blocked(x2, y2))
+      {
+        int local2 = (y2 - y0) * clusterSize_ + (x2 - x0);
+        if (bfs_dist_[local2] < 0)
+        {
+          bfs_dist_[local2] = bfs_dist_[local] + 1;
+          bfs_parent_[local2] = local;
+          bfs_queue_.push_back(local2);
+        }
+      }
+    }
+  }
+  return -1;
+}
+
+template <class View>
+void HierarchicalSearch<View>::appendBfsPath(int cluster, int local, std::vector<Point_t>& path) const
+{
+  int x0 = (cluster % nClusterCols_) * clusterSize_;
+  int y0 = (cluster / nClusterCols_) * clusterSize_;
+  std::vector<Point_t>::size_type begin = path.size();
+  for (; bfs_parent_[local] >= 0; local = bfs_parent_[local])
+  {
+    Point_t p = { x0 + local % clusterSize_, y0 + local / clusterSize_ };
+    path.push_back(p);
+  }
+  std::reverse(path.begin() + begin, path.end());
+}
+
+template <class View>
+bool HierarchicalSearch<View>::searchToOpenSpace(gridNode_t init, std::list<gridNode_t>& pathNodes)
+{
+  std::vector<Point_t> path;  // Path from init (exclusive) to open space
+  int startCluster = clusterOf(init.pos.x, init.pos.y);
+
+  // Try to reach open space without leaving the start cluster.
+  // This also gives the distance from init to each of the entrances of the start cluster
+  int found = clusterBfs(init.pos, startCluster, openCount_[startCluster] > 0, -1);
+  if (found >= 0)
+  {
+    appendBfsPath(startCluster, found, path);
+  }
+  else
+  {
+    // Dijkstra over the abstract graph, seeded with the reachable entrances of the start cluster
+    typedef std::pair<int, int> queue_item_t;  // (cost, entrance)
+    std::priority_queue<queue_item_t, std::vector<queue_item_t>, std::greater<queue_item_t> > open;
+    std::vector<int> dist(entrances_.size(), INT_MAX);
+    std::vector<int> prev(entrances_.size(), -1);
+    std::vector<int> const& seeds = clusterEntrances_[startCluster];
+    for (int i = 0; i < seeds.size(); ++i)
+    {
+      int d = bfs_dist_[localIndex(startCluster, entrances_[seeds[i]].pos)];
+      if (d >= 0)
+      {
+        dist[seeds[i]] = d;
+        open.push(std::make_pair(d, seeds[i]));
+      }
+    }
+
+    int goal = -1;
+    std::vector<Point_t> tail;
+    while (!open.empty() && goal < 0)
+    {
+      queue_item_t item = open.top();
+      open.pop();
+      int n = item.second;
+      if (item.first > dist[n])
+      {
+        continue;  // Outdated queue entry
+      }
+
+      int cluster = entrances_[n].cluster;
+      if (openCount_[cluster] > 0)
+      {
+        int local = clusterBfs(entrances_[n].pos, cluster, true, -1);
+        if (local >= 0)
+        {
+          appendBfsPath(cluster, local, tail);
+          goal = n;
+          break;
+        }
+      }
+
+      for (int i = 0; i < entrances_[n].edges.size(); ++i)
+      {
+        int m = entrances_[n].edges[i].first;
+        int d = item.first + entrances_[n].edges[i].second;
+        if (d < dist[m])
+        {
+          dist[m] = d;
+          prev[m] = n;
+          open.push(std::make_pair(d, m));
+        }
+      }
+    }
+
+    if (goal < 0)
+    {
+      // Empty end_node list and add init as only element, like a_star_to_open_space
+      if (!pathNodes.empty())
+      {
+        pathNodes.erase(pathNodes.begin(), --(pathNodes.end()));
+      }
+      pathNodes.push_back(init);
+      return true;  // We resign, cannot find a path
+    }
+
+    // Refine only the chosen corridor: hop between the entrances on the abstract path
+    std::vector<int> chain;
+    for (int n = goal; n >= 0; n = prev[n])
+    {
+      chain.push_back(n);
+    }
+    std::reverse(chain.begin(), chain.end());
+
+    Point_t current = init.pos;
+    for (int i = 0; i < chain.size(); ++i)
+    {
+      Point_t next = entrances_[chain[i]].pos;
+      int cluster = clusterOf(current.x, current.y);
+      if (entrances_[chain[i]].cluster == cluster)
+      {
+        clusterBfs(current, cluster, false, localIndex(cluster, next));
+        appendBfsPath(cluster, localIndex(cluster, next), path);
+      }
+      else
+      {
+        path.push_back(next);  // Crossing the border between two clusters
+      }
+      current = next;
+    }
+    path.insert(path.end(), tail.begin(), tail.end());
+  }
+
+  gridNode_t node = init;
+  pathNodes.push_back(node);
+  for (int i = 0; i < path.size(); ++i)
+  {
+    node.pos = path[i];
+    node.cost += 1;
+    node.he = node.cost;
+    pathNodes.push_back(node);
+  }
+  return false;  // We do not resign, we found a path
+}
+
+template class HierarchicalSearch<NestedVectorView>;
+template class HierarchicalSearch<BitsetView>;
+template class HierarchicalSearch<TiledView8>;
+template class HierarchicalSearch<TiledView64>;
+template class HierarchicalSearch<CostmapView<253> >;
+template class HierarchicalSearch<CostmapView<254> >;
+template class HierarchicalSearch<MappedView>;
+template class HierarchicalSearch<LazyView>;
+template class HierarchicalSearch<PagedView>;
+}  // namespace full_coverage_path_planner
@@ -0,0 +1,162 @@
+//
+// Copyright [2020] Nobleo Technology"  [legal/copyright]
+//
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <vector>
+
+#include "full_coverage_path_planner/lazy_occupancy_grid.h"
+
+LazyOccupancyGrid::LazyOccupancyGrid(int8_t const* data, int nCols, int nRows, int firstColl, int firstRow, int width,
+                                     int height, int nodeSize)
+  : data_(data),
+    nCols_(nCols),
+    nRows_(nRows),
+    firstColl_(firstColl),
+    firstRow_(firstRow),
+    width_(width),
+    height_(height),
+    nodeSize_(nodeSize),
+    robotNodeSize_(nodeSize),
+    robotCells_(0),
+    tile_size_(0),
+    states_((static_cast<uint64_t>(width) * height + 15) / 16)
+{
+  grid_origin_.x = 0;
+  grid_origin_.y = 0;
+  for (std::size_t i = 0; i < states_.size(); ++i)
+  {
+    states_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void LazyOccupancyGrid::setSquareFootprint(int robotNodeSize)
+{
+  robotNodeSize_ = robotNodeSize;
+  robotCells_ = 0;
+}
+
+void LazyOccupancyGrid::setCircularFootprint(float robotCells)
+{
+  robotCells_ = robotCells;
+}
+
+void LazyOccupancyGrid::setZone(std::vector<fPoint_t> const& zone, fPoint_t grid_origin, float tile_size)
+{
+  zone_ = zone;
+  grid_origin_ = grid_origin;
+  tile_size_ = tile_size;
+}
+
+int LazyOccupancyGrid::evaluated() const
+{
+  int count = 0;
+  for (std::size_t i = 0; i < states_.size(); ++i)
+  {
+    uint32_t word = states_[i].load(std::memory_order_relaxed);
+    for (int shift = 0; shift < 32; shift += 2)
+    {
+      count += ((word >> shift) & 3) != kStateUnknown;
+    }
+  }
+  return count;
+}
+
+bool LazyOccupancyGrid::outsideZone(int x, int y) const
+{
+  if (zone_.empty())
+  {
+    return false;
+  }
+  fPoint_t center = { grid_origin_.x + (x + 0.5f) * tile_size_,  // NOLINT
+                      grid_origin_.y + (y + 0.5f) * tile_size_ };
+  return !point_in_polygon(center, zone_);
+}
+
+bool LazyOccupancyGrid::evaluateCircularBlock(int x, int y) const
+{
+  int firstX = x - x % kBlockSize, firstY = y - y % kBlockSize;
+  int endX = std::min(firstX + kBlockSize, width_), endY = std::min(firstY + kBlockSize, height_);
+
+  // The distances are computed for the cells under the block and a margin of the robot radius around it, like
+  // parseGrid does for the whole grid
+  int margin = std::ceil(robotCells_) + 1;
+  int dtFirstColl = std::max(firstColl_ + firstX * nodeSize_ - margin, 0);
+  int dtFirstRow = std::max(firstRow_ + firstY * nodeSize_ - margin, 0);
+  int dtWidth = std::min(firstColl_ + endX * nodeSize_ + margin, nCols_) - dtFirstColl;
+  int dtHeight = std::min(firstRow_ + endY * nodeSize_ + margin, nRows_) - dtFirstRow;
+  std::vector<bool> occupied(dtWidth * dtHeight);
+  for (int row = 0; row < dtHeight; ++row)
+  {
+    for (int coll = 0; coll < dtWidth; ++coll)
+    {
+      int64_t index = static_cast<int64_t>(row + dtFirstRow) * nCols_ + coll + dtFirstColl;
+      occupied[row * dtWidth + coll] = data_[index] > 65;
+    }
+  }
+  std::vector<int> distances;
+  squared_distance_transform(occupied, dtWidth, dtHeight, distances);
+
+  bool result = false;
+  int centerSize = (nodeSize_ % 2 == 0) ? 2 : 1;
+  for (int ty = firstY; ty < endY; ++ty)
+  {
+    for (int tx = firstX; tx < endX; ++tx)
+    {
+      bool nodeOccupied = outsideZone(tx, ty);
+      if (!nodeOccupied)
+      {
+        // The center of the tile is in the middle of one cell, or between four if nodeSize is even
+        int centerColl = std::min(firstColl_ + tx * nodeSize_ + (nodeSize_ - 1) / 2, nCols_ - 1) - dtFirstColl;
+        int centerRow = std::min(firstRow_ + ty * nodeSize_ + (nodeSize_ - 1) / 2, nRows_ - 1) - dtFirstRow;
+        int d2 = INT_MAX;
+        for (int row = centerRow; row < std::min(centerRow + centerSize, dtHeight); ++row)
+        {
+          for (int coll = centerColl; coll < std::min(centerColl + centerSize, dtWidth); ++coll)
+          {
+            d2 = std::min(d2, distances[row * dtWidth + coll]);
+          }
+        }
+        nodeOccupied = d2 < robotCells_ * robotCells_;
+      }
+      uint64_t node = static_cast<uint64_t>(ty) * width_ + tx;
+      uint32_t state = nodeOccupied ? kStateOccupied : kStateFree;
+      states_[node >> 4].fetch_or(state << ((node & 15) * 2), std::memory_order_relaxed);
+      if (tx == x && ty == y)
+      {
+        result = nodeOccupied;
+      }
+    }
+  }
+  return result;
+}
+
+bool LazyOccupancyGrid::evaluate(int x, int y) const
+{
+  if (robotCells_ > 0)
+  {
+    return evaluateCircularBlock(x, y);
+  }
+  if (outsideZone(x, y))
+  {
+    return true;
+  }
+
+  int ix = firstColl_ + x * nodeSize_, iy = firstRow_ + y * nodeSize_;
+  // The square around the tile that fits the robot, indexed like parseGrid does
+  int offset = std::ceil((robotNodeSize_ - nodeSize_) / 2.0);
+  for (int nodeRow = 0; nodeRow < robotNodeSize_ && iy + nodeRow < nRows_; ++nodeRow)
+  {
+    for (int nodeColl = 0; nodeColl < robotNodeSize_ && ix + nodeColl < nCols_; ++nodeColl)
+    {
+      int64_t index = std::max<int64_t>(static_cast<int64_t>(iy + nodeRow - offset) * nCols_
+                                        + (ix + nodeColl - offset), 0);
+      if (data_[index] > 65)
+      {
+        return true;
+      }
+    }
+  }
+  return false;
+}
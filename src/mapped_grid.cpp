@@ -0,0 +1,276 @@
+//
+// Copyright [2020] Nobleo Technology"  [legal/copyright]
+//
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "full_coverage_path_planner/mapped_grid.h"
+
+/**
+ * Skip the whitespace and comments in front of the next field of a PGM header
+ * @param pos position in the header, moved to the start of the field
+ */
+static void skipPgmSeparators(unsigned char const* data, std::size_t size, std::size_t& pos)
+{
+  while (pos < size && (std::isspace(data[pos]) || data[pos] == '#'))
+  {
+    if (data[pos] == '#')
+    {
+      while (pos < size && data[pos] != '\n')
+      {
+        ++pos;
+      }
+    }
+    else
+    {
+      ++pos;
+    }
+  }
+}
+
+/**
+ * Read a positive number of a PGM header
+ * @return the number, or -1 if there is none
+ */
+static int readPgmNumber(unsigned char const* data, std::size_t size, std::size_t& pos)
+{
+  skipPgmSeparators(data, size, pos);
+  if (pos >= size || !std::isdigit(data[pos]))
+  {
+    return -1;
+  }
+  int64_t value = 0;
+  while (pos < size && std::isdigit(data[pos]) && value <= INT32_MAX)
+  {
+    value = value * 10 + (data[pos++] - '0');
+  }
+  return (value <= INT32_MAX) ? static_cast<int>(value) : -1;
+}
+
+MappedPgm::MappedPgm(std::string const& path) : fd_(-1), data_(MAP_FAILED), size_(0), pixels_(NULL)
+{
+  fd_ = open(path.c_str(), O_RDONLY);
+  struct stat st;
+  if (fd_ < 0 || fstat(fd_, &st) != 0 || st.st_size == 0)
+  {
+    if (fd_ >= 0)
+    {
+      close(fd_);
+    }
+    throw std::runtime_error("Cannot open " + path);
+  }
+  size_ = st.st_size;
+  data_ = mmap(NULL, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+  if (data_ == MAP_FAILED)
+  {
+    close(fd_);
+    throw std::runtime_error("Cannot map " + path);
+  }
+
+  // P5, width, height and the maximum value, separated by whitespace, then one whitespace character and the pixels
+  unsigned char const* data = static_cast<unsigned char const*>(data_);
+  std::size_t pos = 2;
+  bool valid = size_ > 2 && data[0] == 'P' && data[1] == '5';
+  width_ = valid ? readPgmNumber(data, size_, pos) : -1;
+  height_ = valid ? readPgmNumber(data, size_, pos) : -1;
+  int max_value = valid ? readPgmNumber(data, size_, pos) : -1;
+  valid = width_ > 0 && height_ > 0 && max_value > 0 && max_value < 256 && pos < size_ && std::isspace(data[pos]);
+  ++pos;
+  if (!valid || size_ - pos < static_cast<uint64_t>(width_) * height_)
+  {
+    munmap(data_, size_);
+    close(fd_);
+    throw std::runtime_error(path + " is not an 8-bit binary PGM");
+  }
+  pixels_ = data + pos;
+}
+
+MappedPgm::~MappedPgm()
+{
+  munmap(data_, size_);
+  close(fd_);
+}
+
+void MappedPgm::release(int first_row, int end_row) const
+{
+  // Only whole pages, the pages at the ends may hold rows that are still needed
+  uintptr_t page = sysconf(_SC_PAGESIZE);
+  uintptr_t begin = reinterpret_cast<uintptr_t>(row(first_row));
+  uintptr_t end = reinterpret_cast<uintptr_t>(row(end_row));
+  begin = (begin + page - 1) / page * page;
+  end = end / page * page;
+  if (begin < end)
+  {
+    madvise(reinterpret_cast<void*>(begin), end - begin, MADV_DONTNEED);
+  }
+}
+
+MappedGrid::MappedGrid(MappedPgm const& pgm, int node_size, int robot_node_size, double occupied_thresh,
+                       bool negate, std::size_t memory_limit)
+  : pgm_(&pgm),
+    node_size_(node_size),
+    robot_node_size_(robot_node_size),
+    // The footprint is centered on the node, like in parseGrid
+    offset_(std::ceil((robot_node_size - node_size) / 2.0)),
+    width_((pgm.width() + node_size - 1) / node_size),
+    height_((pgm.height() + node_size - 1) / node_size),
+    tilesX_((width_ + kTileSide - 1) >> kTileShift),
+    head_(-1),
+    tail_(-1),
+    resident_(0),
+    page_ins_(0),
+    evictions_(0),
+    last_tile_(-1),
+    last_words_(NULL)
+{
+  // Thresholds of map_server: the occupancy probability of a pixel is (255 - value) / 255, or value / 255 if negated
+  for (int value = 0; value < 256; ++value)
+  {
+    double occupancy = negate ? value / 255.0 : (255 - value) / 255.0;
+    occupied_[value] = occupancy > occupied_thresh;
+  }
+
+  int tiles = tilesX_ * ((height_ + kTileSide - 1) >> kTileShift);
+  capacity_ = std::max<std::size_t>(std::min<std::size_t>(memory_limit / kTileBytes, tiles), 1);
+  tile_slot_.assign(tiles, -1);
+  slot_tile_.assign(capacity_, -1);
+  slot_prev_.assign(capacity_, -1);
+  slot_next_.assign(capacity_, -1);
+  // The blocks are only touched when they are used, so a generous limit costs address space, not memory
+  blocks_.reserve(capacity_ * kTileWords);
+}
+
+uint64_t const* MappedGrid::load(int tile) const
+{
+  int slot = tile_slot_[tile];
+  if (slot >= 0)
+  {
+    if (slot != head_)
+    {
+      unlink(slot);
+      pushFront(slot);
+    }
+    return &blocks_[static_cast<std::size_t>(slot) * kTileWords];
+  }
+
+  if (resident_ < capacity_)
+  {
+    slot = resident_++;
+    blocks_.resize(blocks_.size() + kTileWords);
+  }
+  else
+  {
+    slot = tail_;
+    unlink(slot);
+    tile_slot_[slot_tile_[slot]] = -1;
+    ++evictions_;
+  }
+  slot_tile_[slot] = tile;
+  tile_slot_[tile] = slot;
+  pushFront(slot);
+
+  uint64_t* words = &blocks_[static_cast<std::size_t>(slot) * kTileWords];
+  parse(tile, words);
+  ++page_ins_;
+  return words;
+}
+
+void MappedGrid::parse(int tile, uint64_t* words) const
+{
+  std::fill(words, words + kTileWords, 0ULL);
+  int firstX = (tile % tilesX_) << kTileShift, firstY = (tile / tilesX_) << kTileShift;
+  int endX = std::min(firstX + kTileSide, width_), endY = std::min(firstY + kTileSide, height_);
+  int nCols = pgm_->width(), nRows = pgm_->height();
+  for (int y = firstY; y < endY; ++y)
+  {
+    int firstRow = std::max(y * node_size_ - offset_, 0);
+    int endRow = std::min(y * node_size_ - offset_ + robot_node_size_, nRows);
+    for (int x = firstX; x < endX; ++x)
+    {
+      int firstColl = std::max(x * node_size_ - offset_, 0);
+      int endColl = std::min(x * node_size_ - offset_ + robot_node_size_, nCols);
+      bool nodeOccupied = false;
+      for (int row = firstRow; row < endRow && !nodeOccupied; ++row)
+      {
+        // Row 0 of the map is the last row of the image
+        unsigned char const* pixels = pgm_->row(nRows - 1 - row);
+        for (int coll = firstColl; coll < endColl; ++coll)
+        {
+          if (occupied_[pixels[coll]])
+          {
+            nodeOccupied = true;
+            break;
+          }
+        }
+      }
+      if (nodeOccupied)
+      {
+        uint32_t bit = mortonEncode(x - firstX, y - firstY);
+        words[bit >> 6] |= (1ULL << (bit & 63));
+      }
+    }
+  }
+
+  // The parsed tile is all we need of these rows for now, so do not let the image fill up the memory
+  int firstRow = std::max(firstY * node_size_ - offset_, 0);
+  int endRow = std::min((endY - 1) * node_size_ - offset_ + robot_node_size_, nRows);
+  if (firstRow < endRow)
+  {
+    pgm_->release(nRows - endRow, nRows - firstRow);
+  }
+}
+
+void MappedGrid::unlink(int slot) const
+{
+  if (slot_prev_[slot] >= 0)
+  {
+    slot_next_[slot_prev_[slot]] = slot_next_[slot];
+  }
+  else
+  {
+    head_ = slot_next_[slot];
+  }
+  if (slot_next_[slot] >= 0)
+  {
+    slot_prev_[slot_next_[slot]] = slot_prev_[slot];
+  }
+  else
+  {
+    tail_ = slot_prev_[slot];
+  }
+}
+
+void MappedGrid::pushFront(int slot) const
+{
+  slot_prev_[slot] = -1;
+  slot_next_[slot] = head_;
+  if (head_ >= 0)
+  {
+    slot_prev_[head_] = slot;
+  }
+  head_ = slot;
+  if (tail_ < 0)
+  {
+    tail_ = slot;
+  }
+}
+
+resource_usage_t resourceUsage()
+{
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  resource_usage_t result;
+  result.peak_rss_kb = usage.ru_maxrss;  // Kilobytes on Linux
+  result.major_faults = usage.ru_majflt;
+  result.minor_faults = usage.ru_minflt;
+  return result;
+}
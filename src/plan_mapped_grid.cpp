@@ -0,0 +1,157 @@
+//
+// Copyright [2020] Nobleo Technology"  [legal/copyright]
+//
+#include <stdint.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "full_coverage_path_planner/mapped_grid.h"
+#include "full_coverage_path_planner/spiral_stc.h"
+
+using full_coverage_path_planner::CompactPath;
+using full_coverage_path_planner::SpiralSTC;
+
+/**
+ * Bytes taken by each free node that the plan can reach, for the list of goals: a point and the two links of a node
+ * of a std::list
+ */
+static const std::size_t kGoalBytes = sizeof(Point_t) + 2 * sizeof(void*);
+
+static double megabytes(uint64_t bytes)
+{
+  return bytes / (1024.0 * 1024.0);
+}
+
+static void usage(char const* name)
+{
+  fprintf(stderr,
+          "Usage: %s [options] map.pgm start_x start_y\n"
+          "Plan Spiral-STC coverage of a map_server image without loading it into memory.\n"
+          "The start is a node of the grid, counted from the lower left corner of the map.\n"
+          "  -n cells      side of a node in cells (default 1)\n"
+          "  -r cells      side of the robot footprint in cells (default: the node size)\n"
+          "  -m megabytes  memory the parsed tiles of the map may take (default 64). A warning is given if the\n"
+          "                bookkeeping per node of the plan may take more\n"
+          "  -t threshold  occupied_thresh of the map yaml (default 0.65)\n"
+          "  -i            negate: white is occupied\n"
+          "  -o file       write the plan to file, one node 'x y' per line\n",
+          name);
+}
+
+int main(int argc, char** argv)
+{
+  int node_size = 1, robot_node_size = -1;
+  double memory_limit_mb = 64, occupied_thresh = 0.65;
+  bool negate = false;
+  std::string output;
+  int option;
+  while ((option = getopt(argc, argv, "n:r:m:t:io:")) != -1)
+  {
+    switch (option)
+    {
+    case 'n':
+      node_size = atoi(optarg);
+      break;
+    case 'r':
+      robot_node_size = atoi(optarg);
+      break;
+    case 'm':
+      memory_limit_mb = atof(optarg);
+      break;
+    case 't':
+      occupied_thresh = atof(optarg);
+      break;
+    case 'i':
+      negate = true;
+      break;
+    case 'o':
+      output = optarg;
+      break;
+    default:
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if (argc - optind != 3 || node_size < 1 || memory_limit_mb < 0)
+  {
+    usage(argv[0]);
+    return 1;
+  }
+  robot_node_size = (robot_node_size < 1) ? node_size : robot_node_size;
+
+  try
+  {
+    MappedPgm pgm(argv[optind]);
+    MappedGrid grid(pgm, node_size, robot_node_size, occupied_thresh, negate,
+                    static_cast<std::size_t>(memory_limit_mb * 1024 * 1024));
+    Point_t start = { atoi(argv[optind + 1]), atoi(argv[optind + 2]) };  // NOLINT
+    if (start.x < 0 || start.x >= grid.width() || start.y < 0 || start.y >= grid.height() ||
+        grid.get(start.x, start.y))
+    {
+      fprintf(stderr, "The start (%d, %d) is not a free node of the %d x %d grid\n", start.x, start.y, grid.width(),
+              grid.height());
+      return 1;
+    }
+
+    // The tile cache is bounded, but the plan keeps a visited bit and a component label for every node of the grid,
+    // and a goal for every free node it can reach. At worst, all nodes are free
+    uint64_t nodes = static_cast<uint64_t>(grid.width()) * grid.height();
+    uint64_t visited_bytes = (nodes + 63) / 64 * 8, label_bytes = nodes * sizeof(int);
+    double worst_mb = megabytes(visited_bytes + label_bytes + nodes * kGoalBytes);
+    if (worst_mb > memory_limit_mb)
+    {
+      fprintf(stderr, "warning: the bookkeeping per node of the plan may take up to %.1f MB, more than the %.1f MB of "
+              "-m for the tiles\n", worst_mb, memory_limit_mb);
+    }
+
+    RowMajorGrid visited(grid.width(), grid.height(), false);
+    // The plan is kept as runs, a fraction of a byte per node
+    CompactPath path;
+    int multiple_pass_counter, visited_counter, unreachable_counter;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    SpiralSTC::spiral_stc(MappedView(grid, visited), start, path, multiple_pass_counter, visited_counter,
+                          unreachable_counter, SpiralSTC::spiral_stc_options_type());
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    resource_usage_t usage = resourceUsage();
+    printf("grid: %d x %d nodes, %zu tiles of %zu bytes cached at most\n", grid.width(), grid.height(),
+           grid.capacity(), MappedGrid::kTileBytes);
+    printf("plan: %zu nodes, %d visited, %d passed twice, %d unreachable, %.3f s\n", path.size(), visited_counter,
+           multiple_pass_counter, unreachable_counter, seconds);
+    printf("tile page-ins: %llu, evictions: %llu\n", static_cast<unsigned long long>(grid.pageIns()),  // NOLINT
+           static_cast<unsigned long long>(grid.evictions()));  // NOLINT
+    printf("page faults: %ld major, %ld minor\n", usage.major_faults, usage.minor_faults);
+    // Every node that was covered was a goal before
+    uint64_t goal_bytes = static_cast<uint64_t>(visited_counter - multiple_pass_counter) * kGoalBytes;
+    printf("bookkeeping: %.1f MB visited, %.1f MB component labels, %.1f MB goals at most, %.1f MB path\n",
+           megabytes(visited_bytes), megabytes(label_bytes), megabytes(goal_bytes), megabytes(path.memoryUsage()));
+    printf("peak RSS: %ld kB\n", usage.peak_rss_kb);
+
+    if (!output.empty())
+    {
+      FILE* file = fopen(output.c_str(), "w");
+      if (!file)
+      {
+        fprintf(stderr, "Cannot write %s\n", output.c_str());
+        return 1;
+      }
+      for (CompactPath::const_iterator it = path.begin(); it != path.end(); ++it)
+      {
+        fprintf(file, "%d %d\n", it->x, it->y);
+      }
+      fclose(file);
+    }
+  }
+  catch (std::runtime_error const& e)
+  {
+    fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,225 @@
+//
+// Copyright [2020] Nobleo Technology"  [legal/copyright]
+//
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <vector>
+
+#include <full_coverage_path_planner/region_tour.h>
+
+// Longest segment that Or-opt moves to another place in the tour
+#define OR_OPT_MAX_SEGMENT_LENGTH 3
+
+namespace full_coverage_path_planner
+{
+void build_region_adjacency(std::vector<int> const& labels, int nCols, int nRegions,
+                            std::vector<std::vector<int> >& adjacency)
+{
+  adjacency.assign(nRegions, std::vector<int>());
+  int nRows = labels.size() / nCols;
+  for (int iy = 0; iy < nRows; ++iy)
+  {
+    for (int ix = 0; ix < nCols; ++ix)
+    {
+      int a = labels[iy * nCols + ix];
+      if (a < 0)
+      {
+        continue;
+      }
+      // Only look right and up, the other directions are covered from the neighbor
+      int right = (ix + 1 < nCols) ? labels[iy * nCols + ix + 1] : -1;
+      int up = (iy + 1 < nRows) ? labels[(iy + 1) * nCols + ix] : -1;
+      int neighbors[] = { right, up };  // NOLINT
+      for (int i = 0; i < 2; ++i)
+      {
+        int b = neighbors[i];
+        if (b >= 0 && b != a)
+        {
+          adjacency[a].push_back(b);
+          adjacency[b].push_back(a);
+        }
+      }
+    }
+  }
+  for (int r = 0; r < nRegions; ++r)
+  {
+    std::sort(adjacency[r].begin(), adjacency[r].end());
+    adjacency[r].erase(std::unique(adjacency[r].begin(), adjacency[r].end()), adjacency[r].end());
+  }
+}
+
+RegionTour::RegionTour(std::vector<Point_t> const& entries, std::vector<Point_t> const& exits,
+                       std::vector<std::vector<int> > const& adjacency)
+  : entries_(entries),
+    exits_(exits),
+    adjacency_(adjacency)
+{
+}
+
+int RegionTour::transit(int from, int to) const
+{
+  return abs(exits_[from].x - entries_[to].x) + abs(exits_[from].y - entries_[to].y);
+}
+
+void RegionTour::nearestNeighbor(int first)
+{
+  int n = entries_.size();
+  std::vector<bool> done(n, false);
+  tour_.clear();
+  for (int current = first; current >= 0;)
+  {
+    done[current] = true;
+    tour_.push_back(current);
+    int next = -1, next_transit = INT_MAX;
+    for (int r = 0; r < n; ++r)
+    {
+      if (!done[r] && transit(current, r) < next_transit)
+      {
+        next = r;
+        next_transit = transit(current, r);
+      }
+    }
+    current = next;
+  }
+  update();
+}
+
+void RegionTour::improve(double time_budget)
+{
+  deadline_ = std::chrono::steady_clock::now() +
+              std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                  std::chrono::duration<double>(time_budget));
+  while (!timeIsUp(0))
+  {
+    bool improved = twoOpt();
+    improved = orOpt() || improved;
+    if (!improved)
+    {
+      break;
+    }
+  }
+}
+
+int RegionTour::cost() const
+{
+  return forward_.empty() ? 0 : forward_.back();
+}
+
+void RegionTour::update()
+{
+  int n = tour_.size();
+  position_.assign(entries_.size(), -1);
+  forward_.assign(n, 0);
+  backward_.assign(n, 0);
+  for (int i = 0; i < n; ++i)
+  {
+    position_[tour_[i]] = i;
+    if (i > 0)
+    {
+      forward_[i] = forward_[i - 1] + transit(tour_[i - 1], tour_[i]);
+      backward_[i] = backward_[i - 1] + transit(tour_[i], tour_[i - 1]);
+    }
+  }
+}
+
+bool RegionTour::timeIsUp(int i) const
+{
+  // Reading the clock is not free, so only do it once in a while
+  return (i % 256 == 0) && std::chrono::steady_clock::now() > deadline_;
+}
+
+bool RegionTour::twoOpt()
+{
+  // Reverse tour_[i + 1 .. j], so tour_[j] follows tour_[i]. Because the transits are asymmetric,
+  // the transits within the segment change too; the prefix sums give them in constant time.
+  bool improved = false;
+  int n = tour_.size();
+  for (int i = 0; i + 2 < n; ++i)
+  {
+    if (timeIsUp(i))
+    {
+      break;
+    }
+    int a = tour_[i];
+    for (int k = 0; k < adjacency_[a].size(); ++k)
+    {
+      int j = position_[adjacency_[a][k]];
+      if (j <= i + 1)
+      {
+        continue;
+      }
+      int delta = transit(a, tour_[j]) - transit(a, tour_[i + 1])
+                  + (backward_[j] - backward_[i + 1]) - (forward_[j] - forward_[i + 1]);
+      if (j + 1 < n)
+      {
+        delta += transit(tour_[i + 1], tour_[j + 1]) - transit(tour_[j], tour_[j + 1]);
+      }
+      if (delta < 0)
+      {
+        std::reverse(tour_.begin() + i + 1, tour_.begin() + j + 1);
+        update();
+        improved = true;
+        break;
+      }
+    }
+  }
+  return improved;
+}
+
+bool RegionTour::orOpt()
+{
+  // Move the segment tour_[s .. e] in between tour_[k] and tour_[k + 1], where tour_[k] is a neighbor of tour_[s]
+  bool improved = false;
+  int n = tour_.size();
+  for (int s = 1; s < n; ++s)
+  {
+    if (timeIsUp(s))
+    {
+      break;
+    }
+    for (int length = 1; length <= OR_OPT_MAX_SEGMENT_LENGTH && s + length <= n; ++length)
+    {
+      int e = s + length - 1;
+      int prev = tour_[s - 1];
+      int removed = transit(prev, tour_[s]);
+      if (e + 1 < n)
+      {
+        removed += transit(tour_[e], tour_[e + 1]) - transit(prev, tour_[e + 1]);
+      }
+
+      int best_k = -1, best_delta = 0;
+      for (int m = 0; m < adjacency_[tour_[s]].size(); ++m)
+      {
+        int k = position_[adjacency_[tour_[s]][m]];
+        if (k >= s - 1 && k <= e)
+        {
+          continue;
+        }
+        int added = transit(tour_[k], tour_[s]);
+        if (k + 1 < n)
+        {
+          added += transit(tour_[e], tour_[k + 1]) - transit(tour_[k], tour_[k + 1]);
+        }
+        if (added - removed < best_delta)
+        {
+          best_k = k;
+          best_delta = added - removed;
+        }
+      }
+      if (best_k >= 0)
+      {
+        std::vector<int> segment(tour_.begin() + s, tour_.begin() + e + 1);
+        tour_.erase(tour_.begin() + s, tour_.begin() + e + 1);
+        int insert = (best_k < s) ? best_k + 1 : best_k + 1 - length;
+        tour_.insert(tour_.begin() + insert, segment.begin(), segment.end());
+        update();
+        improved = true;
+        break;
+      }
+    }
+  }
+  return improved;
+}
+}  // namespace full_coverage_path_planner
@@ -0,0 +1,113 @@
+//
+// Copyright [2020] Nobleo Technology"  [legal/copyright]
+//
+#include <list>
+#include <utility>
+#include <vector>
+
+#include <full_coverage_path_planner/spanning_tree_coverage.h>
+
+namespace full_coverage_path_planner
+{
+// Directions between mega-cells, as bits in edges_. Opposite directions are two bits apart
+static const int dirX[] = { 1, 0, -1, 0 };  // NOLINT
+static const int dirY[] = { 0, 1, 0, -1 };  // NOLINT
+
+enum
+{
+  eEdgeRight = 1,
+  eEdgeUp = 2,
+  eEdgeLeft = 4,
+  eEdgeDown = 8
+};
+
+int SpanningTreeCoverage::buildTree(int start)
+{
+  // Each entry is a mega-cell and the direction it was entered in. Continuing in that direction is tried first,
+  // so the tree has long straight branches and the circumnavigation makes fewer turns.
+  std::vector<std::pair<int, int> > stack;
+  stack.push_back(std::make_pair(start, 0));
+  cells_[start] = eCellCovered;
+  int size = 1;
+  while (!stack.empty())
+  {
+    int cell = stack.back().first, heading = stack.back().second;
+    int cx = cell % cols_, cy = cell / cols_;
+    bool extended = false;
+    for (int i = 0; i < 4 && !extended; ++i)
+    {
+      int d = (heading + i) % 4;
+      int nx = cx + dirX[d], ny = cy + dirY[d];
+      if (nx < 0 || nx >= cols_ || ny < 0 || ny >= rows_ || cells_[ny * cols_ + nx] != eCellFree)
+      {
+        continue;
+      }
+      int next = ny * cols_ + nx;
+      cells_[next] = eCellCovered;
+      edges_[cell] |= 1 << d;
+      edges_[next] |= 1 << ((d + 2) % 4);
+      stack.push_back(std::make_pair(next, d));
+      size++;
+      extended = true;
+    }
+    if (!extended)
+    {
+      stack.pop_back();
+    }
+  }
+  return size;
+}
+
+void SpanningTreeCoverage::circumnavigate(std::list<gridNode_t> &pathNodes)
+{
+  std::vector<Point_t> path(1, pathNodes.back().pos);
+  circumnavigate(path);
+  for (int i = 1; i < path.size(); ++i)
+  {
+    gridNode_t node =
+    {
+      path[i],  // Point: x,y
+      0,        // Cost
+      0,        // Heuristic
+    };
+    pathNodes.push_back(node);
+  }
+}
+
+void SpanningTreeCoverage::circumnavigate(std::vector<Point_t> &path)
+{
+  Point_t p = path.back();
+  int size = buildTree((p.y / 2) * cols_ + p.x / 2);
+
+  // Go around each mega-cell counterclockwise, unless a tree edge is on the side being passed:
+  // then cross over to the neighbor, which is gone around the same way until the walk comes back
+  for (int step = 1; step < 4 * size; ++step)
+  {
+    unsigned char edges = edges_[(p.y / 2) * cols_ + p.x / 2];
+    int dx, dy;
+    if (!(p.x & 1) && !(p.y & 1))
+    {
+      dx = (edges & eEdgeDown) ? 0 : 1;
+      dy = (edges & eEdgeDown) ? -1 : 0;
+    }
+    else if (p.x & 1 && !(p.y & 1))
+    {
+      dx = (edges & eEdgeRight) ? 1 : 0;
+      dy = (edges & eEdgeRight) ? 0 : 1;
+    }
+    else if (p.x & 1)
+    {
+      dx = (edges & eEdgeUp) ? 0 : -1;
+      dy = (edges & eEdgeUp) ? 1 : 0;
+    }
+    else
+    {
+      dx = (edges & eEdgeLeft) ? -1 : 0;
+      dy = (edges & eEdgeLeft) ? 0 : -1;
+    }
+    p.x += dx;
+    p.y += dy;
+    path.push_back(p);
+  }
+}
+}  // namespace full_coverage_path_planner
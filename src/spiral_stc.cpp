@@ -2,12 +2,21 @@
 // Copyright [2020] Nobleo Technology"  [legal/copyright]
 //
 #include <algorithm>
+#include <deque>
 #include <iostream>
 #include <list>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "full_coverage_path_planner/spiral_stc.h"
+#include "full_coverage_path_planner/hierarchical_search.h"
+#include "full_coverage_path_planner/lazy_occupancy_grid.h"
+#include "full_coverage_path_planner/mapped_grid.h"
+#include "full_coverage_path_planner/region_tour.h"
+#include "full_coverage_path_planner/spanning_tree_coverage.h"
+#include "full_coverage_path_planner/transit_search.h"
+#include "full_coverage_path_planner/work_stealing_pool.h"
 #include <pluginlib/class_list_macros.h>
 
 // register this planner as a BaseGlobalPlanner plugin
@@ -16,14 +25,18 @@ PLUGINLIB_EXPORT_CLASS(full_coverage_path_planner::SpiralSTC, nav_core::BaseGlob
 namespace full_coverage_path_planner
 {
 void SpiralSTC::initialize(std::string name, costmap_2d::Costmap2DROS* costmap_ros)
+{
+  ros::NodeHandle nh, private_named_nh("~/" + name);
+  initialize(nh, private_named_nh);
+}
+
+void SpiralSTC::initialize(ros::NodeHandle& nh, ros::NodeHandle& private_named_nh)
 {
   if (!initialized_)
   {
     // Create a publisher to visualize the plan
-    ros::NodeHandle private_nh("~/");
-    ros::NodeHandle nh, private_named_nh("~/" + name);
-
     plan_pub_ = private_named_nh.advertise<nav_msgs::Path>("plan", 1);
+    compact_plan_pub_ = private_named_nh.advertise<CompactPlan>("compact_plan", 1);
     // Try to request the cpp-grid from the cpp_grid map_server
     cpp_grid_client_ = nh.serviceClient<nav_msgs::GetMap>("static_map");
 
@@ -33,64 +46,158 @@ void SpiralSTC::initialize(std::string name, costmap_2d::Costmap2DROS* costmap_r
     // Define  tool radius (radius) parameter
     float tool_radius_default = 0.5f;
     private_named_nh.param<float>("tool_radius", tool_radius_, tool_radius_default);
+    // Define the shape of the robot that is checked for collisions: a square that fits the robot, or its disk
+    std::string footprint;
+    private_named_nh.param<std::string>("footprint", footprint, "square");
+    circular_footprint_ = (footprint == "circular");
+    if (footprint != "circular" && footprint != "square")
+    {
+      ROS_WARN("Unknown footprint '%s', using 'square'", footprint.c_str());
+    }
+    // Define the search used to get from the end of a spiral to uncovered space
+    std::string search;
+    private_named_nh.param<std::string>("backtrack_search", search, "astar");
+    if (search == "hierarchical")
+    {
+      spiral_stc_options_.search = eSearchHierarchical;
+    }
+    else if (search == "jps")
+    {
+      spiral_stc_options_.search = eSearchJumpPoint;
+    }
+    else if (search == "turn_aware")
+    {
+      spiral_stc_options_.search = eSearchTurnAware;
+    }
+    else if (search != "astar")
+    {
+      ROS_WARN("Unknown backtrack_search '%s', using 'astar'", search.c_str());
+    }
+    // Define how open space is covered: spiral only, or spanning trees over 2x2 mega-cells
+    std::string coverage;
+    private_named_nh.param<std::string>("coverage", coverage, "spiral");
+    if (coverage == "stc")
+    {
+      spiral_stc_options_.coverage = eCoverageSpanningTree;
+    }
+    else if (coverage != "spiral")
+    {
+      ROS_WARN("Unknown coverage '%s', using 'spiral'", coverage.c_str());
+    }
+    private_named_nh.param<int>("cluster_size", spiral_stc_options_.cluster_size, 32);
+    // Plan regions of the map in parallel if more than one thread is requested
+    private_named_nh.param<int>("threads", spiral_stc_options_.threads, 1);
+    private_named_nh.param<int>("region_size", spiral_stc_options_.region_size, 64);
+    private_named_nh.param<double>("tour_time_budget", spiral_stc_options_.tour_time_budget, 1.0);
+    // Choose the best of a number of plans with different start nodes and headings
+    private_named_nh.param<int>("candidates", spiral_stc_options_.candidates, 1);
+    private_named_nh.param<double>("cost_per_step", spiral_stc_options_.cost_per_step, 1.0);
+    private_named_nh.param<double>("cost_per_turn", spiral_stc_options_.cost_per_turn, 1.0);
+    private_named_nh.param<double>("cost_per_revisit", spiral_stc_options_.cost_per_revisit, 0.0);
+    // Keep the occupancy values below the occupied threshold as traversal costs
+    private_named_nh.param<bool>("cost_aware", cost_aware_, false);
+    // Evaluate the tiles when the planner first reads them, instead of parsing the whole map up front
+    private_named_nh.param<bool>("lazy_occupancy", lazy_occupancy_, false);
+    // Define the parameters of the execution time estimate
+    private_named_nh.param<float>("linear_velocity", linear_velocity_, 0.2f);
+    private_named_nh.param<float>("turn_duration", turn_duration_, 2.0f);
+    // Restrict the coverage to a zone of the map
+    initializeZones(private_named_nh);
+    // Resume from a coverage grid, such as the one of coverage_progress, if a topic is given
+    std::string coverage_grid_topic;
+    private_named_nh.param<std::string>("coverage_grid_topic", coverage_grid_topic, "");
+    private_named_nh.param<float>("covered_fraction", covered_fraction_, 1.0f);
+    if (!coverage_grid_topic.empty())
+    {
+      coverage_grid_sub_ = nh.subscribe(coverage_grid_topic, 1, &SpiralSTC::coverageGridCallback, this);
+    }
     initialized_ = true;
   }
 }
 
+void SpiralSTC::coverageGridCallback(const nav_msgs::OccupancyGrid::ConstPtr& coverage_grid)
+{
+  std::lock_guard<std::mutex> lock(coverage_grid_mutex_);
+  coverage_grid_ = coverage_grid;
+}
+
 std::list<gridNode_t> SpiralSTC::spiral(std::vector<std::vector<bool> > const& grid, std::list<gridNode_t>& init,
                                         std::vector<std::vector<bool> >& visited)
 {
-  int dx, dy, dx_prev, x2, y2, i, nRows = grid.size(), nCols = grid[0].size();
-  // Spiral filling of the open space
-  // Copy incoming list to 'end'
+  return spiral(NestedVectorView(grid, visited), init);
+}
+
+template <class View>
+std::list<gridNode_t> SpiralSTC::spiral(View const& view, std::list<gridNode_t>& init, int heading,
+                                        CostGrid const* costs)
+{
+  std::vector<Point_t> path;
+  path.reserve(init.size());
+  for (std::list<gridNode_t>::iterator it = init.begin(); it != init.end(); ++it)
+  {
+    path.push_back(it->pos);
+  }
+  // The list-based spiral only turns from the direction of the last step of init if init has three nodes or more
+  spiral(view, path, (init.size() == 2) ? 1 : 0, heading, costs);
+
   std::list<gridNode_t> pathNodes(init);
-  // Create iterator for gridNode_t list and let it point to the last element of end
-  std::list<gridNode_t>::iterator it = --(pathNodes.end());
-  if (pathNodes.size() > 1)  // if list is length 1, keep iterator at end
-    it--;                    // Let iterator point to second to last element
+  for (int i = init.size(); i < path.size(); ++i)
+  {
+    gridNode_t new_node =
+    {
+      path[i],  // Point: x,y
+      0,        // Cost
+      0,        // Heuristic
+    };
+    pathNodes.push_back(new_node);
+  }
+  return pathNodes;
+}
 
-  gridNode_t prev = *(it);
-  bool done = false;
-  while (!done)
+template <class View>
+void SpiralSTC::spiral(View const& view, std::vector<Point_t>& path, std::size_t begin, int heading,
+                       CostGrid const* costs)
+{
+  int dx, dy, dx_prev, x2, y2, nRows = view.height(), nCols = view.width();
+  // Spiral filling of the open space, appended to path in place
+  while (true)
   {
-    if (it != pathNodes.begin())
+    Point_t last = path.back();
+    if (path.size() - begin > 1)
     {
       // turn ccw
-      dx = pathNodes.back().pos.x - prev.pos.x;
-      dy = pathNodes.back().pos.y - prev.pos.y;
+      Point_t prev = path[path.size() - 2];
+      dx = last.x - prev.x;
+      dy = last.y - prev.y;
       dx_prev = dx;
       dx = -dy;
       dy = dx_prev;
     }
     else
     {
-      // Initialize spiral direction towards y-axis
-      dx = 0;
-      dy = 1;
+      // Initialize spiral direction, towards the y-axis by default
+      dx = (heading == eDirRight) - (heading == eDirLeft);
+      dy = (heading == eDirUp) - (heading == eDirDown);
     }
-    done = true;
 
+    // Without costs, go to the first open neighbor in spiral order. With costs, go to the cheapest open neighbor,
+    // the first one in spiral order if there is a tie
+    int best_x = -1, best_y = -1;
     for (int i = 0; i < 4; ++i)
     {
-      x2 = pathNodes.back().pos.x + dx;
-      y2 = pathNodes.back().pos.y + dy;
+      x2 = last.x + dx;
+      y2 = last.y + dy;
       if (x2 >= 0 && x2 < nCols && y2 >= 0 && y2 < nRows)
       {
-        if (grid[y2][x2] == eNodeOpen && visited[y2][x2] == eNodeOpen)
+        if (!view.blocked(x2, y2) && !view.visited(x2, y2) &&
+            (best_x < 0 || (costs && costs->get(x2, y2) < costs->get(best_x, best_y))))
         {
-          Point_t new_point = { x2, y2 };
-          gridNode_t new_node =
+          best_x = x2;
+          best_y = y2;
+          if (!costs)
           {
-            new_point,  // Point: x,y
-            0,          // Cost
-            0,          // Heuristic
-          };
-          prev = pathNodes.back();
-          pathNodes.push_back(new_node);
-          it = --(pathNodes.end());
-          visited[y2][x2] = eNodeVisited;  // Close node
-          done = false;
-          break;
+            break;
+          }
         }
       }
       // try next direction cw
@@ -98,8 +205,81 @@ std::list<gridNode_t> SpiralSTC::spiral(std::vector<std::vector<bool> > const& g
       dx = dy;
       dy = -dx_prev;
     }
+    if (best_x < 0)
+    {
+      break;
+    }
+    Point_t new_point = { best_x, best_y };
+    path.push_back(new_point);
+    view.mark(best_x, best_y);  // Close node
+  }
+}
+
+/**
+ * Cover open space from the last node of path: circumnavigate the spanning tree of free mega-cells it is in,
+ * if any, and spiral outside of the free mega-cells from there. The covered nodes are appended to path in place
+ * and marked in view
+ * @param tree mega-cells for eCoverageSpanningTree, NULL to only spiral
+ * @param begin first node of path that leads into the open space, see SpiralSTC::spiral
+ */
+template <class View>
+static void coverOpenSpace(View const& view, SpanningTreeCoverage* tree, std::vector<Point_t>& path,
+                           std::size_t begin, SpiralSTC::spiral_stc_options_type const& options)
+{
+  if (!tree)
+  {
+    SpiralSTC::spiral(view, path, begin, options.heading, options.costs);
+    return;
+  }
+  if (tree->isFree(path.back().x, path.back().y))
+  {
+    std::size_t first = path.size();
+    tree->circumnavigate(path);
+    for (std::size_t i = first; i < path.size(); ++i)
+    {
+      view.mark(path[i].x, path[i].y);
+    }
+  }
+  SpiralSTC::spiral(SpanningTreeSpiralView<View>(view, *tree), path, begin, options.heading, options.costs);
+}
+
+/**
+ * Append the remaining goal points to goals: the open nodes in the component of init, or all open nodes if init is
+ * inside an obstacle (init_component < 0)
+ */
+template <class View>
+static void findGoals(View const& view, std::vector<int> const& components, int init_component,
+                      ArenaList<Point_t>& goals)
+{
+  if (init_component >= 0)
+  {
+    map_2_goals(view, components, init_component, goals);
+  }
+  else
+  {
+    map_2_goals(view, goals);
+  }
+}
+
+/**
+ * Remove the goals that were visited since they were found. The goals never become open again, so what is left are
+ * the goals that findGoals would find now, without reading the grid again
+ */
+template <class View>
+static void dropVisitedGoals(View const& view, ArenaList<Point_t>& goals)
+{
+  ArenaList<Point_t>::iterator it = goals.begin();
+  while (it != goals.end())
+  {
+    if (view.visited(it->x, it->y))
+    {
+      it = goals.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
   }
-  return pathNodes;
 }
 
 std::list<Point_t> SpiralSTC::spiral_stc(std::vector<std::vector<bool> > const& grid,
@@ -107,110 +287,679 @@ std::list<Point_t> SpiralSTC::spiral_stc(std::vector<std::vector<bool> > const&
                                           int &multiple_pass_counter,
                                           int &visited_counter)
 {
-  int x, y, nRows = grid.size(), nCols = grid[0].size();
+  int unreachable_counter;
+  return spiral_stc(grid, init, multiple_pass_counter, visited_counter, unreachable_counter);
+}
+
+std::list<Point_t> SpiralSTC::spiral_stc(std::vector<std::vector<bool> > const& grid,
+                                          Point_t& init,
+                                          int &multiple_pass_counter,
+                                          int &visited_counter,
+                                          int &unreachable_counter)
+{
+  return spiral_stc(grid, init, multiple_pass_counter, visited_counter, unreachable_counter,
+                    spiral_stc_options_type());
+}
+
+std::list<Point_t> SpiralSTC::spiral_stc(std::vector<std::vector<bool> > const& grid,
+                                          Point_t& init,
+                                          int &multiple_pass_counter,
+                                          int &visited_counter,
+                                          int &unreachable_counter,
+                                          spiral_stc_options_type const& options)
+{
+  // Plan on a packed copy of the obstacles, and keep what is visited in the pages of an overlay
+  RowMajorGrid obstacles(grid);
+  PagedGrid visited(obstacles.width(), obstacles.height(), eNodeOpen);
+  return spiral_stc(PagedView(obstacles, visited), init, multiple_pass_counter, visited_counter,
+                    unreachable_counter, options);
+}
+
+template <class View>
+std::list<Point_t> SpiralSTC::spiral_stc(View const& view,
+                                          Point_t& init,
+                                          int &multiple_pass_counter,
+                                          int &visited_counter,
+                                          int &unreachable_counter,
+                                          spiral_stc_options_type const& options)
+{
+  std::vector<Point_t> path;
+  spiral_stc(view, init, path, multiple_pass_counter, visited_counter, unreachable_counter, options);
+  return std::list<Point_t>(path.begin(), path.end());
+}
+
+/**
+ * Move the nodes of path from begin on into flushed, except for the ones the next step to open space still reads:
+ * the last node and the last node before it that is not the same
+ */
+static void flushPath(std::vector<Point_t>& path, std::size_t begin, CompactPath& flushed)
+{
+  std::size_t keep = path.size() - 1;
+  while (keep > begin && path[keep].x == path.back().x && path[keep].y == path.back().y)
+  {
+    --keep;
+  }
+  flushed.append(path.begin() + begin, path.begin() + keep);
+  path.erase(path.begin() + begin, path.begin() + keep);
+}
+
+/**
+ * SpiralSTC::spiral_stc on a caller-owned path. If flushed is not NULL, the nodes are moved from path into it after
+ * every step to open space, so path only holds the nodes of one step at a time
+ */
+template <class View>
+static void planSpiralStc(View const& view,
+                          Point_t& init,
+                          std::vector<Point_t>& path,
+                          CompactPath* flushed,
+                          int &multiple_pass_counter,
+                          int &visited_counter,
+                          int &unreachable_counter,
+                          SpiralSTC::spiral_stc_options_type const& options)
+{
+  int x, y, nRows = view.height(), nCols = view.width();
   // Initial node is initially set as visited so it does not count
   multiple_pass_counter = 0;
   visited_counter = 0;
+  unreachable_counter = 0;
+
+  // Label the free space once, so we only chase goals that can actually be reached from init.
+  // If init is inside an obstacle, fall back to considering all free space.
+  std::vector<int> components;
+  int init_component;
+  if (options.reachable_only)
+  {
+    init_component = (label_component(view, init, components) > 0) ? 0 : -1;
+  }
+  else
+  {
+    label_connected_components(view, components);
+    init_component = components[init.y * nCols + init.x];
+  }
+  if (init_component >= 0 && !options.reachable_only)
+  {
+    for (int i = 0; i < components.size(); ++i)
+    {
+      if (components[i] >= 0 && components[i] != init_component)
+      {
+        unreachable_counter++;
+      }
+    }
+  }
 
-  std::vector<std::vector<bool> > visited;
-  visited = grid;  // Copy grid matrix
   x = init.x;
   y = init.y;
 
-  Point_t new_point = { x, y };
-  gridNode_t new_node =
+  // The plan starts at begin, anything before it in path belongs to the caller
+  std::size_t begin = path.size();
+  path.push_back(init);
+
+  // The mega-cells are classified before init is marked, so the one of init can be free
+  std::unique_ptr<SpanningTreeCoverage> tree;
+  if (options.coverage == eCoverageSpanningTree)
   {
-    new_point,  // Point: x,y
-    0,          // Cost
-    0,          // Heuristic
-  };
-  std::list<gridNode_t> pathNodes;
-  std::list<Point_t> fullPath;
-  pathNodes.push_back(new_node);
-  visited[y][x] = eNodeVisited;
+    tree.reset(new SpanningTreeCoverage(view, components, init_component));
+  }
+  view.mark(x, y);
 
 #ifdef DEBUG_PLOT
   ROS_INFO("Grid before walking is: ");
-  printGrid(grid, visited, fullPath);
+  printGrid(view, std::list<Point_t>());
 #endif
 
-  pathNodes = SpiralSTC::spiral(grid, pathNodes, visited);                // First spiral fill
-  std::list<Point_t> goals = map_2_goals(visited, eNodeOpen);  // Retrieve remaining goalpoints
-  // Add points to full path
-  std::list<gridNode_t>::iterator it;
-  for (it = pathNodes.begin(); it != pathNodes.end(); ++it)
+  // The hierarchical search keeps its own bookkeeping of open nodes, which is updated as nodes get visited
+  std::unique_ptr<HierarchicalSearch<View> > hierarchical;
+  if (options.search == eSearchHierarchical)
   {
-    Point_t newPoint = { it->pos.x, it->pos.y };
-    visited_counter++;
-    fullPath.push_back(newPoint);
+    hierarchical.reset(new HierarchicalSearch<View>(view, options.cluster_size));
+    hierarchical->initOpenCounts();
+  }
+
+  coverOpenSpace(view, tree.get(), path, begin, options);  // First spiral fill
+  // The goals are found once, and the ones that were visited are dropped after every step to open space. The
+  // searches are made again for every step. They are kept in an arena that is released in one go before every step,
+  // so the memory is only taken from the heap for the first steps
+  Arena arena, goalArena;
+  ArenaList<Point_t> goals((ArenaAllocator<Point_t>(goalArena)));
+  findGoals(view, components, init_component, goals);
+  visited_counter += path.size() - begin;
+  for (std::size_t i = begin + 1; hierarchical && i < path.size(); ++i)
+  {
+    hierarchical->markVisited(path[i].x, path[i].y);
   }
-  // Remove all elements from pathNodes list except last element
-  pathNodes.erase(pathNodes.begin(), --(pathNodes.end()));
 
 #ifdef DEBUG_PLOT
   ROS_INFO("Current grid after first spiral is");
-  printGrid(grid, visited, fullPath);
+  printGrid(view, std::list<Point_t>(path.begin() + begin, path.end()));
   ROS_INFO("There are %d goals remaining", goals.size());
 #endif
+  std::list<gridNode_t> pathNodes;
   while (goals.size() != 0)
   {
-    // Remove all elements from pathNodes list except last element.
-    // The last point is the starting point for a new search and A* extends the path from there on
-    pathNodes.erase(pathNodes.begin(), --(pathNodes.end()));
+    // The search starts from the last node and extends the path from there on. The path of each search starts with
+    // the last node twice, like the plans have always had it
     visited_counter--;  // First point is already counted as visited
+    std::size_t segment = path.size();
+    gridNode_t start =
+    {
+      path.back(),  // Point: x,y
+      0,            // Cost
+      0,            // Heuristic
+    };
+    path.push_back(path.back());
     // Plan to closest open Node using A*
     // `goals` is essentially the map, so we use `goals` to determine the distance from the end of a potential path
     //    to the nearest free space
-    bool resign = a_star_to_open_space(grid, pathNodes.back(), 1, visited, goals, pathNodes);
+    bool resign;
+    pathNodes.clear();
+    if (options.costs)
+    {
+      resign = dial_to_open_space(view, *options.costs, start, 1, pathNodes);
+    }
+    else if (hierarchical)
+    {
+      resign = hierarchical->searchToOpenSpace(start, pathNodes);
+    }
+    else if (options.search == eSearchJumpPoint)
+    {
+      resign = jps_to_open_space(view, start, 1, pathNodes);
+    }
+    else if (options.search == eSearchTurnAware)
+    {
+      // Leave in the direction of the last step, and count the costs in tenths of a step
+      // (the path repeats the node where each search starts, so skip over that)
+      std::size_t before = segment - 1;
+      while (before > begin && path[before - 1].x == start.pos.x && path[before - 1].y == start.pos.y)
+      {
+        --before;
+      }
+      int heading = -1;
+      if (before > begin)
+      {
+        Point_t last = start.pos, prev = path[before - 1];
+        heading = (last.x > prev.x) ? 0 : (last.y > prev.y) ? 1 : (last.x < prev.x) ? 2 : 3;
+      }
+      resign = turn_aware_to_open_space(view, start, heading, 10,
+                                        static_cast<int>(10 * options.turn_cost + 0.5), goals, pathNodes);
+    }
+    else
+    {
+      resign = a_star_to_open_space(view, start, 1, goals, path, arena);
+    }
     if (resign)
     {
 #ifdef DEBUG_PLOT
       ROS_INFO("A_star_to_open_space is resigning", goals.size());
 #endif
+      path.resize(segment);
       break;
     }
+    for (std::list<gridNode_t>::iterator it = pathNodes.begin(); it != pathNodes.end(); ++it)
+    {
+      path.push_back(it->pos);
+    }
 
     // Update visited grid
-    for (it = pathNodes.begin(); it != pathNodes.end(); ++it)
+    for (std::size_t i = segment; i < path.size(); ++i)
     {
-      if (visited[it->pos.y][it->pos.x])
+      if (view.visited(path[i].x, path[i].y))
       {
         multiple_pass_counter++;
       }
-      visited[it->pos.y][it->pos.x] = eNodeVisited;
-    }
-    if (pathNodes.size() > 0)
-    {
-      multiple_pass_counter--;  // First point is already counted as visited
+      else if (hierarchical)
+      {
+        hierarchical->markVisited(path[i].x, path[i].y);
+      }
+      view.mark(path[i].x, path[i].y);
     }
+    multiple_pass_counter--;  // First point is already counted as visited
 
 #ifdef DEBUG_PLOT
     ROS_INFO("Grid with path marked as visited is:");
-    gridNode_t SpiralStart = pathNodes.back();
-    printGrid(grid, visited, pathNodes, pathNodes.front(), pathNodes.back());
+    printGrid(view, std::list<Point_t>(path.begin() + segment, path.end()));
 #endif
 
     // Spiral fill from current position
-    pathNodes = spiral(grid, pathNodes, visited);
+    std::size_t spiral_start = path.size();
+    coverOpenSpace(view, tree.get(), path, segment, options);
+    // Everything the spiral appended was open before
+    for (std::size_t i = spiral_start; hierarchical && i < path.size(); ++i)
+    {
+      hierarchical->markVisited(path[i].x, path[i].y);
+    }
 
 #ifdef DEBUG_PLOT
     ROS_INFO("Visited grid updated after spiral:");
-    printGrid(grid, visited, pathNodes, SpiralStart, pathNodes.back());
+    printGrid(view, std::list<Point_t>(path.begin() + segment, path.end()));
 #endif
 
-    goals = map_2_goals(visited, eNodeOpen);  // Retrieve remaining goalpoints
+    arena.release();
+    dropVisitedGoals(view, goals);
+    visited_counter += path.size() - segment;
+    if (flushed)
+    {
+      flushPath(path, begin, *flushed);
+    }
+  }
+  if (flushed)
+  {
+    flushed->append(path.begin() + begin, path.end());
+    path.resize(begin);
+  }
+}
+
+template <class View>
+void SpiralSTC::spiral_stc(View const& view,
+                           Point_t& init,
+                           std::vector<Point_t>& path,
+                           int &multiple_pass_counter,
+                           int &visited_counter,
+                           int &unreachable_counter,
+                           spiral_stc_options_type const& options)
+{
+  planSpiralStc(view, init, path, NULL, multiple_pass_counter, visited_counter, unreachable_counter, options);
+}
+
+template <class View>
+void SpiralSTC::spiral_stc(View const& view,
+                           Point_t& init,
+                           CompactPath& path,
+                           int &multiple_pass_counter,
+                           int &visited_counter,
+                           int &unreachable_counter,
+                           spiral_stc_options_type const& options)
+{
+  std::vector<Point_t> step;
+  planSpiralStc(view, init, step, &path, multiple_pass_counter, visited_counter, unreachable_counter, options);
+}
+
+/**
+ * A region of spiral_stc_regions: its bounding box, where its spiral starts and the plan that covers it
+ */
+typedef struct
+{
+  Point_t min, max, start;
+  bool reachable;
+  bool open;  // Whether any of its nodes is not visited yet
+  std::list<Point_t> path;
+}
+region_t;
+
+template <class View>
+std::list<Point_t> SpiralSTC::spiral_stc_regions(View const& view,
+                                                  Point_t& init,
+                                                  int &multiple_pass_counter,
+                                                  int &visited_counter,
+                                                  int &unreachable_counter,
+                                                  int &saved_transit_counter,
+                                                  spiral_stc_options_type const& options)
+{
+  int nRows = view.height(), nCols = view.width();
+  multiple_pass_counter = 0;
+  visited_counter = 0;
+  unreachable_counter = 0;
+  saved_transit_counter = 0;
+
+  std::vector<int> components;
+  label_connected_components(view, components);
+  int init_component = components[init.y * nCols + init.x];
+  if (init_component < 0)
+  {
+    // Without a start component there is nothing to restrict the regions to, so cover the whole grid at once
+    return spiral_stc(view, init, multiple_pass_counter, visited_counter, unreachable_counter, options);
+  }
 
-    for (it = pathNodes.begin(); it != pathNodes.end(); ++it)
+  std::vector<int> labels;
+  int nRegions = label_block_regions(view, options.region_size, labels);
+  std::vector<region_t> regions(nRegions);
+  std::vector<bool> seen(nRegions, false);
+  for (int iy = 0; iy < nRows; ++iy)
+  {
+    for (int ix = 0; ix < nCols; ++ix)
     {
-      Point_t newPoint = { it->pos.x, it->pos.y };
-      visited_counter++;
-      fullPath.push_back(newPoint);
+      int r = labels[iy * nCols + ix];
+      if (r < 0)
+      {
+        continue;
+      }
+      Point_t p = { ix, iy };
+      if (!seen[r])
+      {
+        // The first node in scan order is a corner of the region, a good place to start a spiral
+        seen[r] = true;
+        regions[r].min = p;
+        regions[r].max = p;
+        regions[r].start = p;
+        regions[r].reachable = (components[iy * nCols + ix] == init_component);
+        regions[r].open = false;
+      }
+      regions[r].open = regions[r].open || !view.visited(ix, iy);
+      regions[r].min.x = std::min(regions[r].min.x, ix);
+      regions[r].max.x = std::max(regions[r].max.x, ix);
+      regions[r].max.y = iy;
+      if (!regions[r].reachable)
+      {
+        unreachable_counter++;
+      }
     }
   }
+  int init_region = labels[init.y * nCols + init.x];
+  regions[init_region].start = init;
+  // Regions that were covered before are only planned if the plan starts there
+  for (int r = 0; r < nRegions; ++r)
+  {
+    regions[r].reachable = regions[r].reachable && (regions[r].open || r == init_region);
+  }
 
+  // Cover each region on its own. The regions do not share any state, so they can be planned concurrently
+  WorkStealingPool pool(options.threads);
+  pool.run(nRegions, [&](int r)
+  {
+    region_t& region = regions[r];
+    if (!region.reachable)
+    {
+      return;
+    }
+    int width = region.max.x - region.min.x + 1, height = region.max.y - region.min.y + 1;
+    RowMajorGrid obstacles(width, height, true), visited(width, height, false);
+    CostGrid costs(options.costs ? width : 0, options.costs ? height : 0);
+    for (int iy = 0; iy < height; ++iy)
+    {
+      for (int ix = 0; ix < width; ++ix)
+      {
+        obstacles.set(ix, iy, labels[(iy + region.min.y) * nCols + ix + region.min.x] != r);
+        visited.set(ix, iy, view.visited(ix + region.min.x, iy + region.min.y));
+        if (options.costs)
+        {
+          costs.set(ix, iy, options.costs->get(ix + region.min.x, iy + region.min.y));
+        }
+      }
+    }
+    // The region is planned in its own coordinates, so it needs its own crop of the costs too
+    spiral_stc_options_type region_options(options);
+    region_options.costs = options.costs ? &costs : NULL;
+    Point_t start = { region.start.x - region.min.x, region.start.y - region.min.y };
+    int region_multiple_pass_counter, region_visited_counter, region_unreachable_counter;
+    region.path = spiral_stc(BitsetView(obstacles, visited), start, region_multiple_pass_counter,
+                             region_visited_counter, region_unreachable_counter, region_options);
+    for (std::list<Point_t>::iterator it = region.path.begin(); it != region.path.end(); ++it)
+    {
+      it->x += region.min.x;
+      it->y += region.min.y;
+    }
+  });
+
+  // Order the regions that were planned. Regions are only adjacent to regions of the same component, but the ones
+  // that were covered before are not planned, so the adjacency graph of the tour leaves those out. Their neighbors
+  // are only candidates for the improvement moves of the tour, so this narrows the moves, not the tour
+  std::vector<std::vector<int> > adjacency;
+  build_region_adjacency(labels, nCols, nRegions, adjacency);
+  std::vector<int> tour_index(nRegions, -1), tour_region;
+  std::vector<Point_t> entries, exits;
+  for (int r = 0; r < nRegions; ++r)
+  {
+    if (regions[r].reachable)
+    {
+      tour_index[r] = tour_region.size();
+      tour_region.push_back(r);
+      entries.push_back(regions[r].path.front());
+      exits.push_back(regions[r].path.back());
+    }
+  }
+  std::vector<std::vector<int> > tour_adjacency;
+  for (int i = 0; i < tour_region.size(); ++i)
+  {
+    tour_adjacency.push_back(std::vector<int>());
+    for (int k = 0; k < adjacency[tour_region[i]].size(); ++k)
+    {
+      if (tour_index[adjacency[tour_region[i]][k]] >= 0)
+      {
+        tour_adjacency[i].push_back(tour_index[adjacency[tour_region[i]][k]]);
+      }
+    }
+  }
+  RegionTour tour(entries, exits, tour_adjacency);
+  tour.nearestNeighbor(tour_index[init_region]);
+  int greedy_transit = tour.cost();
+  tour.improve(options.tour_time_budget);
+  saved_transit_counter = greedy_transit - tour.cost();
+
+  // Chain the regions along a shortest path on the whole grid
+  TransitSearch transits(view);
+  std::list<Point_t> fullPath;
+  for (int i = 0; i < tour.order().size(); ++i)
+  {
+    region_t& region = regions[tour_region[tour.order()[i]]];
+    if (!fullPath.empty())
+    {
+      transits.appendPath(region.start, fullPath);
+      region.path.pop_front();  // Already reached by the transit
+    }
+    fullPath.splice(fullPath.end(), region.path);
+  }
+
+  count_path_visits(fullPath, nCols, nRows, visited_counter, multiple_pass_counter);
   return fullPath;
 }
 
+template <class View>
+std::list<Point_t> SpiralSTC::spiral_stc_multi_start(View const& view,
+                                                      Point_t& init,
+                                                      int &multiple_pass_counter,
+                                                      int &visited_counter,
+                                                      int &unreachable_counter,
+                                                      spiral_stc_options_type const& options)
+{
+  if (options.candidates <= 1)
+  {
+    return spiral_stc(view, init, multiple_pass_counter, visited_counter, unreachable_counter, options);
+  }
+  int nRows = view.height(), nCols = view.width();
+  int headings[] = { eDirUp, eDirRight, eDirDown, eDirLeft };  // NOLINT
+
+  // Breadth-first search for the open nodes closest to init to start from, remembering how to get there
+  int nStarts = (options.candidates + 3) / 4;
+  std::vector<int> starts, parents(nRows * nCols, -1);
+  std::deque<int> queue;
+  parents[init.y * nCols + init.x] = init.y * nCols + init.x;
+  queue.push_back(init.y * nCols + init.x);
+  while (!queue.empty() && starts.size() < nStarts)
+  {
+    int node = queue.front();
+    queue.pop_front();
+    int x = node % nCols, y = node / nCols;
+    if (starts.empty() || !view.visited(x, y))
+    {
+      starts.push_back(node);
+    }
+    int dx[] = { 1, 0, -1, 0 }, dy[] = { 0, 1, 0, -1 };  // NOLINT
+    for (int d = 0; d < 4; ++d)
+    {
+      int x2 = x + dx[d], y2 = y + dy[d];
+      if (x2 >= 0 && x2 < nCols && y2 >= 0 && y2 < nRows && !view.blocked(x2, y2) && parents[y2 * nCols + x2] < 0)
+      {
+        parents[y2 * nCols + x2] = node;
+        queue.push_back(y2 * nCols + x2);
+      }
+    }
+  }
+  int nCandidates = std::min(options.candidates, static_cast<int>(4 * starts.size()));
+
+  // All candidates share one copy of the obstacles and of what was visited before. Every candidate marks what it
+  // visits in its own copy-on-write overlay, so they can be planned concurrently
+  RowMajorGrid obstacles(nCols, nRows, false), visitedBefore(nCols, nRows, false);
+  for (int iy = 0; iy < nRows; ++iy)
+  {
+    for (int ix = 0; ix < nCols; ++ix)
+    {
+      obstacles.set(ix, iy, view.blocked(ix, iy));
+      visitedBefore.set(ix, iy, view.visited(ix, iy));
+    }
+  }
+  std::vector<std::list<Point_t> > plans(nCandidates);
+  std::vector<double> costs(nCandidates);
+  std::vector<int> multiple_pass_counters(nCandidates), visited_counters(nCandidates);
+  std::vector<int> unreachable_counters(nCandidates);
+  WorkStealingPool pool(options.threads);
+  pool.run(nCandidates, [&](int c)
+  {
+    PagedGrid visited(visitedBefore);
+    // The nodes on the way from init to the start of this candidate are covered on the way
+    std::list<Point_t> transit;
+    for (int node = starts[c / 4];; node = parents[node])
+    {
+      Point_t p = { node % nCols, node / nCols };
+      transit.push_front(p);
+      if (parents[node] == node)
+      {
+        break;
+      }
+    }
+    Point_t start = transit.back();
+    transit.pop_back();
+    for (std::list<Point_t>::iterator it = transit.begin(); it != transit.end(); ++it)
+    {
+      visited.set(it->x, it->y, true);
+    }
+
+    spiral_stc_options_type candidate_options(options);
+    candidate_options.heading = headings[c % 4];
+    int candidate_multiple_pass_counter, candidate_visited_counter;
+    plans[c] = spiral_stc(PagedView(obstacles, visited), start, candidate_multiple_pass_counter,
+                          candidate_visited_counter, unreachable_counters[c], candidate_options);
+    plans[c].splice(plans[c].begin(), transit);
+    count_path_visits(plans[c], nCols, nRows, visited_counters[c], multiple_pass_counters[c]);
+    costs[c] = options.cost_per_step * (plans[c].size() - 1) + options.cost_per_turn * count_turns(plans[c])
+               + options.cost_per_revisit * multiple_pass_counters[c];
+  });
+
+  int best = 0;
+  for (int c = 1; c < nCandidates; ++c)
+  {
+    if (costs[c] < costs[best])
+    {
+      best = c;
+    }
+  }
+  for (std::list<Point_t>::iterator it = plans[best].begin(); it != plans[best].end(); ++it)
+  {
+    view.mark(it->x, it->y);
+  }
+  multiple_pass_counter = multiple_pass_counters[best];
+  visited_counter = visited_counters[best];
+  unreachable_counter = unreachable_counters[best];
+  return plans[best];
+}
+
+/*
+ * Explicit instantiations for each of the supported grid views
+ */
+#define FCPP_INSTANTIATE_SPIRAL_STC(View)                                                                          \
+  template std::list<gridNode_t> SpiralSTC::spiral(View const &view, std::list<gridNode_t> &init, int heading,     \
+                                                   CostGrid const *costs);                                         \
+  template void SpiralSTC::spiral(View const &view, std::vector<Point_t> &path, std::size_t begin, int heading,    \
+                                 CostGrid const *costs);                                                           \
+  template std::list<Point_t> SpiralSTC::spiral_stc(View const &view, Point_t &init, int &multiple_pass_counter,   \
+                                                    int &visited_counter, int &unreachable_counter,                \
+                                                    spiral_stc_options_type const &options);                       \
+  template void SpiralSTC::spiral_stc(View const &view, Point_t &init, std::vector<Point_t> &path,                 \
+                                     int &multiple_pass_counter, int &visited_counter, int &unreachable_counter,   \
+                                     spiral_stc_options_type const &options);                                      \
+  template void SpiralSTC::spiral_stc(View const &view, Point_t &init, CompactPath &path,                          \
+                                     int &multiple_pass_counter, int &visited_counter, int &unreachable_counter,   \
+                                     spiral_stc_options_type const &options);                                      \
+  template std::list<Point_t> SpiralSTC::spiral_stc_regions(View const &view, Point_t &init,                       \
+                                                            int &multiple_pass_counter, int &visited_counter,      \
+                                                            int &unreachable_counter, int &saved_transit_counter,  \
+                                                            spiral_stc_options_type const &options);               \
+  template std::list<Point_t> SpiralSTC::spiral_stc_multi_start(View const &view, Point_t &init,                   \
+                                                                int &multiple_pass_counter, int &visited_counter,  \
+                                                                int &unreachable_counter,                          \
+                                                                spiral_stc_options_type const &options);
+
+FCPP_INSTANTIATE_SPIRAL_STC(NestedVectorView)
+FCPP_INSTANTIATE_SPIRAL_STC(BitsetView)
+FCPP_INSTANTIATE_SPIRAL_STC(TiledView8)
+FCPP_INSTANTIATE_SPIRAL_STC(TiledView64)
+FCPP_INSTANTIATE_SPIRAL_STC(CostmapView<253>)
+FCPP_INSTANTIATE_SPIRAL_STC(CostmapView<254>)
+FCPP_INSTANTIATE_SPIRAL_STC(MappedView)
+FCPP_INSTANTIATE_SPIRAL_STC(LazyView)
+FCPP_INSTANTIATE_SPIRAL_STC(PagedView)
+
+template <class View>
+bool SpiralSTC::coverView(View const& view, Point_t startPoint, spiral_stc_options_type const& options,
+                          CompactPath& goalPoints)
+{
+  // Skip the tiles that were covered before
+  nav_msgs::OccupancyGrid::ConstPtr coverage_grid;
+  {
+    std::lock_guard<std::mutex> lock(coverage_grid_mutex_);
+    coverage_grid = coverage_grid_;
+  }
+  if (coverage_grid)
+  {
+    // coverage_progress publishes 100 for the cells that are not covered yet, and less for the covered ones
+    RowMajorGrid covered(coverage_grid->info.width, coverage_grid->info.height);
+    for (int iy = 0; iy < covered.height(); ++iy)
+    {
+      for (int ix = 0; ix < covered.width(); ++ix)
+      {
+        int8_t value = coverage_grid->data[iy * covered.width() + ix];
+        covered.set(ix, iy, value >= 0 && value < 100);
+      }
+    }
+    fPoint_t coverage_origin = { static_cast<float>(coverage_grid->info.origin.position.x),  // NOLINT
+                                 static_cast<float>(coverage_grid->info.origin.position.y) };
+    int marked = mark_covered_tiles(view, covered, coverage_grid->info.resolution, coverage_origin, tile_size_,
+                                    grid_origin_, covered_fraction_);
+    ROS_INFO("Resuming coverage, %d tiles were covered before", marked);
+  }
+
+#ifdef DEBUG_PLOT
+  ROS_INFO("Start grid is:");
+  std::list<Point_t> printPath;
+  printPath.push_back(startPoint);
+  printGrid(view, printPath);
+#endif
+
+  bool regions = (options.threads != 1 && options.candidates <= 1);
+  if (options.candidates > 1)
+  {
+    // The threads are used to evaluate the candidates, each of which covers the whole map
+    std::list<Point_t> path = spiral_stc_multi_start(view,
+                                                     startPoint,
+                                                     spiral_cpp_metrics_.multiple_pass_counter,
+                                                     spiral_cpp_metrics_.visited_counter,
+                                                     spiral_cpp_metrics_.unreachable_counter,
+                                                     options);
+    goalPoints.assign(path.begin(), path.end());
+  }
+  else if (!regions)
+  {
+    goalPoints.clear();
+    spiral_stc(view,
+               startPoint,
+               goalPoints,
+               spiral_cpp_metrics_.multiple_pass_counter,
+               spiral_cpp_metrics_.visited_counter,
+               spiral_cpp_metrics_.unreachable_counter,
+               options);
+  }
+  else
+  {
+    std::list<Point_t> path = spiral_stc_regions(view,
+                                                 startPoint,
+                                                 spiral_cpp_metrics_.multiple_pass_counter,
+                                                 spiral_cpp_metrics_.visited_counter,
+                                                 spiral_cpp_metrics_.unreachable_counter,
+                                                 spiral_cpp_metrics_.saved_transit_counter,
+                                                 options);
+    goalPoints.assign(path.begin(), path.end());
+  }
+  return regions;
+}
+
 bool SpiralSTC::makePlan(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal,
                          std::vector<geometry_msgs::PoseStamped>& plan)
 {
@@ -228,7 +977,7 @@ bool SpiralSTC::makePlan(const geometry_msgs::PoseStamped& start, const geometry
   Point_t startPoint;
 
   /********************** Get grid from server **********************/
-  std::vector<std::vector<bool> > grid;
+  RowMajorGrid grid;
   nav_msgs::GetMap grid_req_srv;
   ROS_INFO("Requesting grid!!");
   if (!cpp_grid_client_.call(grid_req_srv))
@@ -237,23 +986,42 @@ bool SpiralSTC::makePlan(const geometry_msgs::PoseStamped& start, const geometry
     return false;
   }
 
-  if (!parseGrid(grid_req_srv.response.map, grid, robot_radius_ * 2, tool_radius_ * 2, start, startPoint))
+  CostGrid costs;
+  LazyOccupancyGrid lazyGrid;
+  // The costs need all tiles to be parsed up front
+  bool lazy = lazy_occupancy_ && !cost_aware_;
+  bool parsed = lazy ? parseGridLazily(grid_req_srv.response.map, lazyGrid, robot_radius_ * 2, tool_radius_ * 2, start,
+                                       startPoint)
+                     : parseGrid(grid_req_srv.response.map, grid, robot_radius_ * 2, tool_radius_ * 2, start,
+                                 startPoint, cost_aware_ ? &costs : NULL);
+  if (!parsed)
   {
     ROS_ERROR("Could not parse retrieved grid");
     return false;
   }
+  spiral_stc_options_type options(spiral_stc_options_);
+  options.costs = cost_aware_ ? &costs : NULL;
+  // A turn takes as long as driving this many tiles
+  options.turn_cost = turn_duration_ * linear_velocity_ / tile_size_;
+  // A lazily evaluated map is only read where the plan can get to
+  options.reachable_only = lazy;
 
-#ifdef DEBUG_PLOT
-  ROS_INFO("Start grid is:");
-  std::list<Point_t> printPath;
-  printPath.push_back(startPoint);
-  printGrid(grid, grid, printPath);
-#endif
-
-  std::list<Point_t> goalPoints = spiral_stc(grid,
-                                              startPoint,
-                                              spiral_cpp_metrics_.multiple_pass_counter,
-                                              spiral_cpp_metrics_.visited_counter);
+  // The path is kept as runs, a list of points would take tens of bytes per tile on a big map
+  CompactPath goalPoints;
+  bool regions;
+  if (lazy)
+  {
+    RowMajorGrid visited(lazyGrid.width(), lazyGrid.height(), eNodeOpen);
+    regions = coverView(LazyView(lazyGrid, visited), startPoint, options, goalPoints);
+    ROS_INFO("Evaluated %d of %d tiles", lazyGrid.evaluated(), lazyGrid.width() * lazyGrid.height());
+  }
+  else
+  {
+    // The parsed grid is only read, what the plan visits is kept in the pages of an overlay
+    PagedGrid visited(grid.width(), grid.height(), eNodeOpen);
+    regions = coverView(PagedView(grid, visited), startPoint, options, goalPoints);
+  }
+  goalPoints.shrink_to_fit();
   ROS_INFO("naive cpp completed!");
   ROS_INFO("Converting path to plan");
 
@@ -262,16 +1030,29 @@ bool SpiralSTC::makePlan(const geometry_msgs::PoseStamped& start, const geometry
   spiral_cpp_metrics_.accessible_counter = spiral_cpp_metrics_.visited_counter
                                             - spiral_cpp_metrics_.multiple_pass_counter;
   spiral_cpp_metrics_.total_area_covered = (4.0 * tool_radius_ * tool_radius_) * spiral_cpp_metrics_.accessible_counter;
+  spiral_cpp_metrics_.total_area_unreachable = (4.0 * tool_radius_ * tool_radius_)
+                                                * spiral_cpp_metrics_.unreachable_counter;
+  updateExecutionMetrics(goalPoints);
   ROS_INFO("Total visited: %d", spiral_cpp_metrics_.visited_counter);
   ROS_INFO("Total re-visited: %d", spiral_cpp_metrics_.multiple_pass_counter);
   ROS_INFO("Total accessible cells: %d", spiral_cpp_metrics_.accessible_counter);
   ROS_INFO("Total accessible area: %f", spiral_cpp_metrics_.total_area_covered);
+  ROS_INFO("Total unreachable cells: %d", spiral_cpp_metrics_.unreachable_counter);
+  ROS_INFO("Total unreachable area: %f", spiral_cpp_metrics_.total_area_unreachable);
+  ROS_INFO("Total turns: %d", spiral_cpp_metrics_.turn_counter);
+  ROS_INFO("Estimated execution time: %f s", spiral_cpp_metrics_.estimated_execution_time);
+  if (regions)
+  {
+    ROS_INFO("Transit saved by ordering the regions: %d cells, %f m", spiral_cpp_metrics_.saved_transit_counter,
+             tile_size_ * spiral_cpp_metrics_.saved_transit_counter);
+  }
 
   // TODO(CesarLopez): Check if global path should be calculated repetitively or just kept
   // (also controlled by planner_frequency parameter in move_base namespace)
 
   ROS_INFO("Publishing plan!");
   publishPlan(plan);
+  publishCompactPlan(start, goalPoints);
   ROS_INFO("Plan published!");
   ROS_DEBUG("Plan published");
 
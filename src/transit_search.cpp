@@ -0,0 +1,40 @@
+//
+// Copyright [2020] Nobleo Technology"  [legal/copyright]
+//
+#include <cstdlib>
+#include <list>
+
+#include <full_coverage_path_planner/transit_search.h>
+
+namespace full_coverage_path_planner
+{
+bool TransitSearch::appendPath(Point_t to, std::list<Point_t>& path)
+{
+  Point_t from = path.back();
+  int distance = abs(to.x - from.x) + abs(to.y - from.y);
+  if (distance == 0)
+  {
+    return false;
+  }
+  if (distance == 1)
+  {
+    path.push_back(to);  // No need to search for a single step
+    return false;
+  }
+
+  gridNode_t from_node = { from, 0, 0 };
+  std::list<gridNode_t> transit;
+  target_.set(to.x, to.y, eNodeOpen);
+  bool resign = jps_to_open_space(BitsetView(obstacles_, target_), from_node, 1, transit);
+  target_.set(to.x, to.y, eNodeVisited);
+  if (resign)
+  {
+    return true;
+  }
+  for (std::list<gridNode_t>::iterator it = ++transit.begin(); it != transit.end(); ++it)
+  {
+    path.push_back(it->pos);
+  }
+  return false;
+}
+}  // namespace full_coverage_path_planner
@@ -0,0 +1,185 @@
+//
+// Copyright [2020] Nobleo Technology"  [legal/copyright]
+//
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+
+#include <ros/ros.h>
+#include <tf/tf.h>
+
+#include "full_coverage_path_planner/common.h"
+#include "full_coverage_path_planner/waypoint_generator.h"
+
+namespace full_coverage_path_planner
+{
+/**
+ * Orientation when moving right, up, left or down, computed once
+ * @param index 0 to 3 for the four directions, see directionIndex
+ */
+static geometry_msgs::Quaternion const& directionQuaternion(int index)
+{
+  // The yaws are rounded to float, like the plans always had them
+  static const geometry_msgs::Quaternion table[] =  // NOLINT
+  {
+    tf::createQuaternionMsgFromYaw(0),
+    tf::createQuaternionMsgFromYaw(static_cast<float>(M_PI / 2)),
+    tf::createQuaternionMsgFromYaw(static_cast<float>(M_PI)),
+    tf::createQuaternionMsgFromYaw(static_cast<float>(M_PI * 1.5))
+  };
+  return table[index];
+}
+
+/**
+ * @param move_dir dx + dy*2 of a step, see eDirRight etc.
+ * @return index in the quaternion table, -1 to keep the orientation
+ */
+static int directionIndex(int move_dir)
+{
+  switch (move_dir)
+  {
+  case eDirRight:
+    return 0;
+  case eDirUp:
+    return 1;
+  case eDirLeft:
+    return 2;
+  case eDirDown:
+    return 3;
+  default:
+    return -1;
+  }
+}
+
+WaypointGenerator::WaypointGenerator(geometry_msgs::PoseStamped const& start, CompactPath const& path,
+                                     float tile_size, fPoint_t grid_origin)
+  : path_(path),
+    tile_size_(tile_size),
+    grid_origin_(grid_origin),
+    runs_(path),
+    move_dir_prev_(eDirNone),
+    last_(path.back()),
+    finished_(path.size() <= 1),
+    off_start_(false),
+    orientation_(0),
+    queued_(0),
+    dequeued_(0)
+{
+  CompactPath::run_t run;
+  if (!finished_ && runs_.next(run))
+  {
+    move_dir_prev_ = run.dx + run.dy * 2;
+    last_ = run.to;
+    if (directionIndex(move_dir_prev_) >= 0)
+    {
+      orientation_ = directionIndex(move_dir_prev_);
+    }
+  }
+  geometry_msgs::PoseStamped first_goal = pose(path.front());
+  first_goal.pose.orientation = directionQuaternion(orientation_);
+
+  queue_[queued_++] = start;
+  // Compute angle between current pose and first plan point
+  double dy = first_goal.pose.position.y - start.pose.position.y;
+  double dx = first_goal.pose.position.x - start.pose.position.x;
+  // Arbitrary choice of 100.0*FLT_EPSILON to determine minimum angle precision of 1%
+  if (!(fabs(dy) < 100.0 * FLT_EPSILON && fabs(dx) < 100.0 * FLT_EPSILON))
+  {
+    // Add extra translation waypoint
+    off_start_ = true;
+    geometry_msgs::Quaternion quat_temp = tf::createQuaternionMsgFromYaw(std::atan2(dy, dx));
+    queue_[queued_] = start;
+    queue_[queued_++].pose.orientation = quat_temp;
+    queue_[queued_] = first_goal;
+    queue_[queued_++].pose.orientation = quat_temp;
+  }
+  queue_[queued_++] = first_goal;
+  previous_goal_ = first_goal;
+}
+
+bool WaypointGenerator::next(geometry_msgs::PoseStamped& pose)
+{
+  if (dequeued_ == queued_)
+  {
+    queued_ = dequeued_ = 0;
+    if (!advance())
+    {
+      return false;
+    }
+  }
+  pose = queue_[dequeued_++];
+  return true;
+}
+
+std::size_t WaypointGenerator::size() const
+{
+  std::size_t goals = 1;
+  CompactPath::RunReader runs(path_);
+  CompactPath::run_t run;
+  if (path_.size() > 1 && runs.next(run))
+  {
+    // The first and the last point, and the start of each run in another direction than the one before
+    std::size_t points = 2;
+    int move_dir_prev = run.dx + run.dy * 2;
+    while (runs.next(run))
+    {
+      int move_dir_now = run.dx + run.dy * 2;
+      points += (move_dir_now != move_dir_prev);
+      move_dir_prev = move_dir_now;
+    }
+    goals = 2 * points - 1;
+  }
+  return 1 + (off_start_ ? 2 : 0) + goals;
+}
+
+bool WaypointGenerator::advance()
+{
+  CompactPath::run_t run;
+  while (runs_.next(run))
+  {
+    int move_dir_prev = move_dir_prev_;
+    move_dir_prev_ = run.dx + run.dy * 2;
+    last_ = run.to;
+    if (move_dir_prev_ != move_dir_prev)
+    {
+      addGoal(run.from, move_dir_prev);
+      return true;
+    }
+  }
+  if (finished_)
+  {
+    return false;
+  }
+  finished_ = true;
+  addGoal(last_, move_dir_prev_);
+  return true;
+}
+
+void WaypointGenerator::addGoal(Point_t const& point, int move_dir)
+{
+  if (directionIndex(move_dir) >= 0)
+  {
+    orientation_ = directionIndex(move_dir);
+  }
+  geometry_msgs::PoseStamped new_goal = pose(point);
+  new_goal.pose.orientation = directionQuaternion(orientation_);
+  // republish previous goal but with new orientation to indicate change of direction
+  // useful when the plan is strictly followed with base_link
+  previous_goal_.pose.orientation = new_goal.pose.orientation;
+  queue_[queued_++] = previous_goal_;
+  ROS_DEBUG("Voila new point: x=%f, y=%f, o=%f,%f,%f,%f", new_goal.pose.position.x, new_goal.pose.position.y,
+            new_goal.pose.orientation.x, new_goal.pose.orientation.y, new_goal.pose.orientation.z,
+            new_goal.pose.orientation.w);
+  queue_[queued_++] = new_goal;
+  previous_goal_ = new_goal;
+}
+
+geometry_msgs::PoseStamped WaypointGenerator::pose(Point_t const& point) const
+{
+  geometry_msgs::PoseStamped goal;
+  goal.header.frame_id = "map";
+  goal.pose.position.x = (point.x) * tile_size_ + grid_origin_.x + tile_size_ * 0.5;
+  goal.pose.position.y = (point.y) * tile_size_ + grid_origin_.y + tile_size_ * 0.5;
+  return goal;
+}
+}  // namespace full_coverage_path_planner
@@ -0,0 +1,108 @@
+//
+// Copyright [2020] Nobleo Technology"  [legal/copyright]
+//
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <full_coverage_path_planner/work_stealing_pool.h>
+
+namespace full_coverage_path_planner
+{
+WorkStealingPool::WorkStealingPool(int threads)
+{
+  if (threads <= 0)
+  {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (int i = 0; i < threads; ++i)
+  {
+    queues_.push_back(std::unique_ptr<queue_t>(new queue_t()));
+  }
+}
+
+void WorkStealingPool::run(int count, std::function<void(int)> const& task)
+{
+  // Deal the tasks round-robin, so every thread starts with a share of the batch
+  for (int i = 0; i < count; ++i)
+  {
+    queues_[i % queues_.size()]->tasks.push_back(i);
+  }
+
+  std::exception_ptr error;
+  std::mutex error_mutex;
+  std::function<void(int)> guarded = [&](int i)
+  {
+    try
+    {
+      task(i);
+    }
+    catch (...)
+    {
+      std::lock_guard<std::mutex> lock(error_mutex);
+      if (!error)
+      {
+        error = std::current_exception();
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (int worker = 1; worker < queues_.size() && worker < count; ++worker)
+  {
+    threads.push_back(std::thread(&WorkStealingPool::work, this, worker, std::cref(guarded)));
+  }
+  work(0, guarded);
+  for (int i = 0; i < threads.size(); ++i)
+  {
+    threads[i].join();
+  }
+
+  if (error)
+  {
+    std::rethrow_exception(error);
+  }
+}
+
+void WorkStealingPool::work(int worker, std::function<void(int)> const& task)
+{
+  // No tasks are added while the batch runs, so once all queues are empty this worker is done
+  int i;
+  while (pop(worker, i) || steal(worker, i))
+  {
+    task(i);
+  }
+}
+
+bool WorkStealingPool::pop(int worker, int& task)
+{
+  queue_t& queue = *queues_[worker];
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  if (queue.tasks.empty())
+  {
+    return false;
+  }
+  task = queue.tasks.back();
+  queue.tasks.pop_back();
+  return true;
+}
+
+bool WorkStealingPool::steal(int worker, int& task)
+{
+  for (int i = 1; i < queues_.size(); ++i)
+  {
+    queue_t& victim = *queues_[(worker + i) % queues_.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty())
+    {
+      task = victim.tasks.front();
+      victim.tasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace full_coverage_path_planner
@@ -42,4 +42,19 @@ struct CompareByPosition
   }
 };
 
+/**
+ * Count the cache misses of the calling thread from construction on, with the hardware performance counters.
+ * count() gives -1 where those are not available, as on most virtual machines
+ */
+class CacheMissCounter
+{
+public:
+  CacheMissCounter();
+  ~CacheMissCounter();
+  long long count() const;  // NOLINT
+
+private:
+  int fd_;
+};
+
 #endif  // FULL_COVERAGE_PATH_PLANNER_UTIL_H
@@ -0,0 +1,76 @@
+//
+// Copyright [2020] Nobleo Technology"  [legal/copyright]
+//
+
+/*
+ * Subscriber of the plans of test_plan_delivery in a process of its own, like a controller that is not loaded in the
+ * nodelet manager of the planner. For every plan it receives, it publishes how long the delivery took
+ */
+#include <vector>
+
+#include <geometry_msgs/PoseStamped.h>
+#include <nav_msgs/Path.h>
+#include <ros/ros.h>
+#include <std_msgs/Float64.h>
+
+#include <full_coverage_path_planner/compact_plan.h>
+#include <full_coverage_path_planner/waypoint_generator.h>
+
+using full_coverage_path_planner::CompactPlan;
+
+class PlanDeliveryListener
+{
+public:
+  explicit PlanDeliveryListener(ros::NodeHandle& nh)
+    : plan_latency_pub_(nh.advertise<std_msgs::Float64>("plan_latency", 10)),
+      compact_plan_latency_pub_(nh.advertise<std_msgs::Float64>("compact_plan_latency", 10)),
+      plan_sub_(nh.subscribe("plan", 10, &PlanDeliveryListener::onPlan, this)),
+      compact_plan_sub_(nh.subscribe("compact_plan", 10, &PlanDeliveryListener::onCompactPlan, this))
+  {
+  }
+
+private:
+  void onPlan(nav_msgs::Path::ConstPtr const& msg)
+  {
+    publishLatency(msg->header.stamp, plan_latency_pub_);
+  }
+
+  /**
+   * The compact plan is decoded to poses first, like a controller that follows it would
+   */
+  void onCompactPlan(CompactPlan::ConstPtr const& msg)
+  {
+    full_coverage_path_planner::WaypointGenerator waypoints =
+        full_coverage_path_planner::CompactPlanDecoder(*msg).waypoints();
+    std::vector<geometry_msgs::PoseStamped> poses(waypoints.size());
+    for (std::size_t i = 0; i < poses.size(); ++i)
+    {
+      waypoints.next(poses[i]);
+    }
+    publishLatency(msg->header.stamp, compact_plan_latency_pub_);
+  }
+
+  /**
+   * Publish the seconds since stamp, the wall time at which the plan was published
+   */
+  void publishLatency(ros::Time const& stamp, ros::Publisher& pub)
+  {
+    std_msgs::Float64 latency;
+    latency.data = (ros::WallTime::now() - ros::WallTime(stamp.sec, stamp.nsec)).toSec();
+    pub.publish(latency);
+  }
+
+  ros::Publisher plan_latency_pub_;
+  ros::Publisher compact_plan_latency_pub_;
+  ros::Subscriber plan_sub_;
+  ros::Subscriber compact_plan_sub_;
+};
+
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "plan_delivery_listener");
+  ros::NodeHandle nh;
+  PlanDeliveryListener listener(nh);
+  ros::spin();
+  return 0;
+}
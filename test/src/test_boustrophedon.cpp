@@ -0,0 +1,144 @@
+//
+// Copyright [2020] Nobleo Technology"  [legal/copyright]
+//
+#include <cstdlib>
+#include <list>
+#include <set>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <ros/ros.h>
+
+#include <full_coverage_path_planner/boustrophedon.h>
+#include <full_coverage_path_planner/common.h>
+#include <full_coverage_path_planner/spiral_stc.h>
+#include <full_coverage_path_planner/util.h>
+
+/*
+ * Every step of a coverage path must go to a 4-neighbor that is free
+ */
+static void expectConnectedPath(std::vector<std::vector<bool> > const& grid, std::list<Point_t> const& path)
+{
+  for (std::list<Point_t>::const_iterator it = path.begin(); it != path.end(); ++it)
+  {
+    ASSERT_FALSE(grid[it->y][it->x]);
+    if (it != path.begin())
+    {
+      std::list<Point_t>::const_iterator prev = it;
+      --prev;
+      ASSERT_EQ(1, abs(it->x - prev->x) + abs(it->y - prev->y));
+    }
+  }
+}
+
+TEST(TestBoustrophedon, testFillEmptyMap)
+{
+  std::vector<std::vector<bool> > grid = makeTestGrid(6, 4, false);
+
+  Point_t start = {0, 0};  // NOLINT
+  int multiple_pass_counter, visited_counter, unreachable_counter;
+  std::list<Point_t> path = full_coverage_path_planner::Boustrophedon::boustrophedon(grid, start,
+                                                                                      multiple_pass_counter,
+                                                                                      visited_counter,
+                                                                                      unreachable_counter);
+
+  // Four lanes along x and no node twice
+  ASSERT_EQ(6 * 4, path.size());
+  ASSERT_EQ(0, multiple_pass_counter);
+  ASSERT_EQ(0, unreachable_counter);
+  ASSERT_EQ(6, count_turns(path));
+}
+
+/*
+ * A room that is closed off from the start must be counted as unreachable, and not be entered
+ */
+TEST(TestBoustrophedon, testEnclosedRoomIsUnreachable)
+{
+  std::vector<std::vector<bool> > grid = makeTestGrid(8, 8, false);
+  for (int i = 4; i < 8; ++i)
+  {
+    grid[4][i] = true;
+    grid[i][4] = true;
+  }
+
+  Point_t start = {0, 0};  // NOLINT
+  int multiple_pass_counter, visited_counter, unreachable_counter;
+  std::list<Point_t> path = full_coverage_path_planner::Boustrophedon::boustrophedon(grid, start,
+                                                                                      multiple_pass_counter,
+                                                                                      visited_counter,
+                                                                                      unreachable_counter);
+
+  expectConnectedPath(grid, path);
+  ASSERT_EQ(9, unreachable_counter);
+  std::set<Point_t, CompareByPosition> covered(path.begin(), path.end());
+  ASSERT_EQ(8 * 8 - 7 - 9, covered.size());
+}
+
+/*
+ * On random maps every reachable node is covered, and the path never jumps
+ */
+TEST(TestBoustrophedon, testRandomMap)
+{
+  unsigned int seed = 12345;
+  for (int i = 0; i < 20; ++i)
+  {
+    int x_size = rand_r(&seed) % 60 + 1;
+    int y_size = rand_r(&seed) % 60 + 1;
+    std::vector<std::vector<bool> > grid = makeTestGrid(x_size, y_size, false);
+    randomFillTestGrid(grid, 20);
+    Point_t start = {0, 0};  // NOLINT
+    grid[0][0] = false;
+
+    int multiple_pass_counter, visited_counter, unreachable_counter;
+    std::list<Point_t> path = full_coverage_path_planner::Boustrophedon::boustrophedon(grid, start,
+                                                                                        multiple_pass_counter,
+                                                                                        visited_counter,
+                                                                                        unreachable_counter);
+    expectConnectedPath(grid, path);
+
+    std::vector<int> labels;
+    label_connected_components(grid, labels);
+    int reachable = 0;
+    for (int j = 0; j < labels.size(); ++j)
+    {
+      reachable += (labels[j] == labels[0]);
+    }
+    std::set<Point_t, CompareByPosition> covered(path.begin(), path.end());
+    ASSERT_EQ(reachable, covered.size());
+    ASSERT_EQ(reachable, visited_counter - multiple_pass_counter);
+  }
+}
+
+/*
+ * In a warehouse with long racks, straight lanes need far fewer turns than a spiral
+ */
+TEST(TestBoustrophedon, testFewerTurnsThanSpiral)
+{
+  std::vector<std::vector<bool> > grid = makeTestGrid(60, 41, false);
+  for (int iy = 4; iy < 41; iy += 6)
+  {
+    for (int ix = 5; ix < 55; ++ix)
+    {
+      grid[iy][ix] = true;
+    }
+  }
+
+  Point_t start = {0, 0};  // NOLINT
+  int multiple_pass_counter, visited_counter, unreachable_counter;
+  std::list<Point_t> lanes = full_coverage_path_planner::Boustrophedon::boustrophedon(grid, start,
+                                                                                       multiple_pass_counter,
+                                                                                       visited_counter,
+                                                                                       unreachable_counter);
+  std::list<Point_t> spiral = full_coverage_path_planner::SpiralSTC::spiral_stc(grid, start,
+                                                                                multiple_pass_counter,
+                                                                                visited_counter);
+  expectConnectedPath(grid, lanes);
+  ASSERT_LT(count_turns(lanes), count_turns(spiral));
+}
+
+// Run all the tests that were declared with TEST()
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -8,13 +8,19 @@
  * Most important here is the conversion function and a variant of A*. Each test is explained below
  *
  */
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <iostream>
 #include <list>
+#include <stdexcept>
 #include <vector>
 
 #include <gtest/gtest.h>
 #include <ros/ros.h>
 
 #include <full_coverage_path_planner/common.h>
+#include <full_coverage_path_planner/compact_path.h>
 #include <full_coverage_path_planner/util.h>
 
 /**
@@ -185,6 +191,170 @@ TEST(TestMakeTestGrid, testDimensions)
   ASSERT_ANY_THROW(grid.at(4).size());  // Only 4 items in Y direction (vertical) so no index 4
 }
 
+/*
+ * Morton encoding interleaves the bits of x (even bits) and y (odd bits)
+ */
+TEST(TestGridStorage, testMortonEncode)
+{
+  ASSERT_EQ(0, mortonEncode(0, 0));
+  ASSERT_EQ(1, mortonEncode(1, 0));
+  ASSERT_EQ(2, mortonEncode(0, 1));
+  ASSERT_EQ(3, mortonEncode(1, 1));
+  ASSERT_EQ(63, mortonEncode(7, 7));  // Last node of an 8x8 tile
+  ASSERT_EQ(4095, mortonEncode(63, 63));  // Last node of a 64x64 tile
+}
+
+/**
+ * Check that a storage holds exactly the same values as a nested vector grid
+ */
+template <class Grid>
+void expectSameAsNested(Grid const& storage, std::vector<std::vector<bool> > const& grid)
+{
+  ASSERT_EQ(gridWidth(grid), gridWidth(storage));
+  ASSERT_EQ(gridHeight(grid), gridHeight(storage));
+  for (int y = 0; y < gridHeight(grid); ++y)
+  {
+    for (int x = 0; x < gridWidth(grid); ++x)
+    {
+      ASSERT_EQ(gridGet(grid, x, y), gridGet(storage, x, y)) << "at (" << x << ", " << y << ")";
+    }
+  }
+}
+
+/*
+ * All storages must give back what was put in, also on sizes that are not a multiple of the tile size
+ */
+TEST(TestGridStorage, testStoragesMatchNestedVector)
+{
+  std::vector<std::vector<bool> > grid = makeTestGrid(75, 130, false);
+  unsigned int seed = 12345;
+  for (int i = 0; i < 2000; ++i)
+  {
+    grid[rand_r(&seed) % 130][rand_r(&seed) % 75] = true;
+  }
+
+  expectSameAsNested(RowMajorGrid(grid), grid);
+  expectSameAsNested(TiledGrid8(grid), grid);
+  expectSameAsNested(TiledGrid64(grid), grid);
+
+  // Clearing and setting through the accessors
+  TiledGrid8 tiled(grid);
+  gridSet(tiled, 74, 129, false);
+  gridSet(grid, 74, 129, false);
+  gridSet(tiled, 8, 8, true);
+  gridSet(grid, 8, 8, true);
+  expectSameAsNested(tiled, grid);
+}
+
+/*
+ * A paged grid only allocates the pages that are written to, and an overlay never changes the grid below it
+ */
+TEST(TestGridStorage, testPagedGridCopyOnWrite)
+{
+  std::vector<std::vector<bool> > grid = makeTestGrid(150, 130, false);
+  unsigned int seed = 12345;
+  for (int i = 0; i < 2000; ++i)
+  {
+    grid[rand_r(&seed) % 130][rand_r(&seed) % 150] = true;
+  }
+
+  PagedGrid empty(150, 130, false);
+  gridSet(empty, 5, 5, false);
+  ASSERT_EQ(0, empty.allocatedPages());  // Writing the value it already reads does not allocate
+  gridSet(empty, 149, 129, true);
+  ASSERT_EQ(1, empty.allocatedPages());
+  ASSERT_TRUE(gridGet(empty, 149, 129));
+  ASSERT_FALSE(gridGet(empty, 148, 129));
+
+  RowMajorGrid base(grid);
+  PagedGrid overlay(base), other(base);
+  expectSameAsNested(overlay, grid);
+  ASSERT_EQ(0, overlay.allocatedPages());
+
+  // Writes go to the overlay only, with the rest of the page copied from the base
+  gridSet(overlay, 70, 70, !grid[70][70]);
+  gridSet(overlay, 0, 129, !grid[129][0]);
+  ASSERT_EQ(2, overlay.allocatedPages());
+  expectSameAsNested(base, grid);
+  expectSameAsNested(other, grid);
+  grid[70][70] = !grid[70][70];
+  grid[129][0] = !grid[129][0];
+  expectSameAsNested(overlay, grid);
+}
+
+/*
+ * Containers on an arena get aligned memory, and after a release they use the same blocks again
+ */
+TEST(TestArena, testReleaseReusesBlocks)
+{
+  Arena arena(1024);
+  std::size_t blocks = 0;
+  for (int round = 0; round < 3; ++round)
+  {
+    {
+      ArenaList<Point_t> points((ArenaAllocator<Point_t>(arena)));
+      ArenaVector<double> values((ArenaAllocator<double>(arena)));
+      for (int i = 0; i < 1000; ++i)
+      {
+        Point_t p = { i, -i };  // NOLINT
+        points.push_back(p);
+        values.push_back(i);
+        ASSERT_EQ(0, reinterpret_cast<std::size_t>(&values.back()) % alignof(double));
+      }
+      ASSERT_EQ(999, points.back().x);
+      ASSERT_EQ(999.0, values.back());
+    }
+    arena.release();
+    ASSERT_GT(arena.blocks(), 1);
+    ASSERT_TRUE(round == 0 || arena.blocks() == blocks);
+    blocks = arena.blocks();
+  }
+}
+
+/*
+ * A view reads obstacles and visited state from separate layers, and only writes to the visited layer
+ */
+TEST(TestGridView, testBitsetViewMatchesNestedVector)
+{
+  std::vector<std::vector<bool> > grid = makeTestGrid(20, 10, false);
+  std::vector<std::vector<bool> > visited = makeTestGrid(20, 10, false);
+  for (int y = 0; y < 9; ++y)
+  {
+    grid[y][12] = true;  // Wall with a gap at the top
+  }
+  for (int y = 0; y < 10; ++y)
+  {
+    for (int x = 0; x < 12; ++x)
+    {
+      visited[y][x] = true;  // Everything left of the wall is covered
+    }
+  }
+
+  RowMajorGrid packedGrid(grid), packedVisited(visited);
+  BitsetView view(packedGrid, packedVisited);
+  ASSERT_EQ(20, view.width());
+  ASSERT_EQ(10, view.height());
+  ASSERT_TRUE(view.blocked(12, 0));
+  ASSERT_FALSE(view.visited(12, 0));
+
+  // Only the nodes right of the wall are open
+  std::list<Point_t> goals = map_2_goals(view);
+  ASSERT_EQ(7 * 10 + 1, goals.size());
+
+  gridNode_t start = {{0, 0}, 0, 0};  // NOLINT
+  std::list<gridNode_t> nestedPath, viewPath;
+  ASSERT_FALSE(a_star_to_open_space(grid, start, 1, visited, goals, nestedPath));
+  ASSERT_FALSE(a_star_to_open_space(view, start, 1, goals, viewPath));
+  ASSERT_EQ(nestedPath.size(), viewPath.size());
+  ASSERT_EQ(12, viewPath.back().pos.x);
+  ASSERT_EQ(9, viewPath.back().pos.y);
+
+  view.mark(12, 9);
+  ASSERT_TRUE(packedVisited.get(12, 9));
+  ASSERT_FALSE(packedGrid.get(12, 9));
+  ASSERT_EQ(7 * 10, map_2_goals(view).size());
+}
+
 /*
  * Test that if there is a NxN map with only a single element, only that single element is returned
  */
@@ -280,6 +450,87 @@ TEST(TestMap_2_goals, testCoordinateOrder)
   ASSERT_EQ(corner0.y, goals.front().y);
 }
 
+/*
+ * A wall that splits the map in two must result in 2 components, obstacles are not labelled
+ */
+TEST(TestLabelConnectedComponents, testSplitMap)
+{
+/* Map:
+ * [ 0 1 0 ]
+ * [ 0 1 0 ]
+ * [ 0 1 0 ]
+ */
+  std::vector<std::vector<bool> > grid = makeTestGrid(3, 3);
+  grid[0][1] = true;
+  grid[1][1] = true;
+  grid[2][1] = true;
+  std::vector<int> labels;
+
+  ASSERT_EQ(2, label_connected_components(grid, labels));
+  ASSERT_EQ(9, labels.size());
+  ASSERT_EQ(-1, labels[1 * 3 + 1]);  // Obstacle
+  ASSERT_EQ(labels[0 * 3 + 0], labels[2 * 3 + 0]);  // Left column is one component
+  ASSERT_EQ(labels[0 * 3 + 2], labels[2 * 3 + 2]);  // Right column is one component
+  ASSERT_NE(labels[0 * 3 + 0], labels[0 * 3 + 2]);  // But they are not the same component
+
+  // Restricting goals to a single component only returns the nodes in that column
+  ASSERT_EQ(3, map_2_goals(grid, false, labels, labels[0]).size());
+}
+
+/*
+ * A U-shape gets two provisional labels in the first rows that must be merged once the bottom is reached.
+ * Only 4-connectivity counts, so the diagonal cell is a separate component.
+ */
+TEST(TestLabelConnectedComponents, testMergeAndDiagonal)
+{
+/* Map (row 0 at the top):
+ * [ 0 0 0 1 ]
+ * [ 0 1 0 1 ]
+ * [ 0 1 0 1 ]
+ * [ 1 1 1 0 ]
+ */
+  std::vector<std::vector<bool> > grid = makeTestGrid(4, 4);
+  grid[0][3] = true;
+  grid[1][1] = true;
+  grid[1][3] = true;
+  grid[2][1] = true;
+  grid[2][3] = true;
+  grid[3][0] = true;
+  grid[3][1] = true;
+  grid[3][2] = true;
+  std::vector<int> labels;
+
+  ASSERT_EQ(2, label_connected_components(grid, labels));
+  ASSERT_EQ(labels[2 * 4 + 0], labels[2 * 4 + 2]);  // Both legs of the U
+  ASSERT_NE(labels[2 * 4 + 2], labels[3 * 4 + 3]);  // Diagonal neighbor is not connected
+}
+
+/*
+ * The flood fill from a node finds the same component as labeling the whole map, and nothing for a blocked node
+ */
+TEST(TestLabelComponent, testSameAsConnectedComponents)
+{
+  int width = 40, height = 30;
+  unsigned int seed = 7;
+  for (int map = 0; map < 20; ++map)
+  {
+    std::vector<std::vector<bool> > grid = makeTestGrid(width, height), visited = makeTestGrid(width, height);
+    randomFillTestGrid(grid, 40);
+    std::vector<int> components, labels;
+    label_connected_components(grid, components);
+    Point_t init = { static_cast<int>(rand_r(&seed) % width), static_cast<int>(rand_r(&seed) % height) };  // NOLINT
+    int size = label_component(NestedVectorView(grid, visited), init, labels);
+    int expected = 0;
+    for (int i = 0; i < width * height; ++i)
+    {
+      bool inComponent = components[i] >= 0 && components[i] == components[init.y * width + init.x];
+      ASSERT_EQ(inComponent ? 0 : -1, labels[i]);
+      expected += inComponent;
+    }
+    ASSERT_EQ(expected, size);
+  }
+}
+
 /* LEGENDA
  * Note: in tests for the A* path finding algorithm, use this legend for the maps:
  * s: start
@@ -585,6 +836,658 @@ TEST(TestAStarToOpenSpace, testBlockedMap)
   ASSERT_EQ(1, pathNodes.size());  // Only the cell we start at:
   ASSERT_EQ(start.pos, pathNodes.front().pos);
 }
+
+/*
+ * A* addresses nodes beyond 65536 nodes per side
+ */
+TEST(TestAStarToOpenSpace, testWideMap)
+{
+  RowMajorGrid grid(70000, 3, false), visited(70000, 3, true);
+  visited.set(69990, 2, false);
+  std::list<Point_t> goals = map_2_goals(BitsetView(grid, visited));
+  ASSERT_EQ(1, goals.size());
+
+  gridNode_t start = {{69995, 0}, 0, 0};  // NOLINT
+  std::vector<Point_t> path;
+  ASSERT_FALSE(a_star_to_open_space(BitsetView(grid, visited), start, 1, goals, path));
+  ASSERT_EQ(8, path.size());
+  ASSERT_EQ(69990, path.back().x);
+  ASSERT_EQ(2, path.back().y);
+}
+
+/*
+ * The maze of testMazeMap must give a path of the same length with jump point search
+ */
+TEST(TestJpsToOpenSpace, testMazeMap)
+{
+  /*
+   * [s v v v]
+   * [1 1 1 v]
+   * [0 v v v] goal is the single 0 in this map
+   * [1 1 1 1]
+   */
+  std::vector<std::vector<bool> > grid = makeTestGrid(4, 4, false);
+  grid[1][0] = 1;
+  grid[1][1] = 1;
+  grid[1][2] = 1;
+  grid[3][0] = 1;
+  grid[3][1] = 1;
+  grid[3][2] = 1;
+  grid[3][3] = 1;
+  std::vector<std::vector<bool> > visited = grid;
+
+  visited[0][0] = 1;
+  visited[0][1] = 1;
+  visited[0][2] = 1;
+  visited[0][3] = 1;
+  visited[1][3] = 1;
+  visited[2][3] = 1;
+  visited[2][2] = 1;
+  visited[2][1] = 1;
+
+  gridNode_t start;
+  start.pos = {0, 0};  // NOLINT
+  start.cost = 1;
+  start.he = 0;
+
+  std::list<gridNode_t> pathNodes;
+  bool resign = jps_to_open_space(grid, start, 1, visited, pathNodes);
+  ASSERT_EQ(false, resign);
+  ASSERT_EQ(9, pathNodes.size());
+  ASSERT_EQ(0, pathNodes.back().pos.x);
+  ASSERT_EQ(2, pathNodes.back().pos.y);
+}
+
+/*
+ * Same as testBlockedMap for A*: no path possible, so jump point search should resign too
+ */
+TEST(TestJpsToOpenSpace, testBlockedMap)
+{
+  /*
+   * [s 1 0 0]
+   * [1 1 0 0]
+   * [0 0 0 0]
+   * [0 0 0 0]
+   */
+  std::vector<std::vector<bool> > grid = makeTestGrid(4, 4, false);
+  std::vector<std::vector<bool> > visited = makeTestGrid(4, 4, false);
+
+  visited[0][0] = true;
+  grid[1][0] = true;
+  grid[0][1] = true;
+  grid[1][1] = true;
+
+  gridNode_t start;
+  start.pos = {0, 0};  // NOLINT
+  start.cost = 1;
+  start.he = 0;
+
+  std::list<gridNode_t> pathNodes;
+  bool resign = jps_to_open_space(grid, start, 1, visited, pathNodes);
+  ASSERT_EQ(true, resign);
+  ASSERT_EQ(1, pathNodes.size());
+  ASSERT_EQ(start.pos, pathNodes.front().pos);
+}
+
+/*
+ * On random maps with mostly visited nodes, jump point search must find a connected path to open space
+ * that is never longer than the one from a_star_to_open_space.
+ * (The A* heuristic uses squared distances, so A* is not guaranteed to find the shortest path itself)
+ */
+TEST(TestJpsToOpenSpace, testRandomMapsNotLongerThanAStar)
+{
+  unsigned int seed = 12345;
+  for (int i = 0; i < 50; ++i)
+  {
+    int x_size = rand_r(&seed) % 30 + 2;
+    int y_size = rand_r(&seed) % 30 + 2;
+    std::vector<std::vector<bool> > grid = makeTestGrid(x_size, y_size, false);
+    std::vector<std::vector<bool> > visited = makeTestGrid(x_size, y_size, true);
+    for (int y = 0; y < y_size; ++y)
+    {
+      for (int x = 0; x < x_size; ++x)
+      {
+        grid[y][x] = (rand_r(&seed) % 100) < 20;
+        visited[y][x] = grid[y][x] || (rand_r(&seed) % 100) < 95;
+      }
+    }
+    gridNode_t start = {{0, 0}, 0, 0};  // NOLINT
+    grid[0][0] = false;
+    visited[0][0] = true;
+
+    std::list<Point_t> goals = map_2_goals(visited, false);
+    std::list<gridNode_t> aStarPath, jpsPath;
+    bool aStarResign = a_star_to_open_space(grid, start, 1, visited, goals, aStarPath);
+    bool jpsResign = jps_to_open_space(grid, start, 1, visited, jpsPath);
+
+    ASSERT_EQ(aStarResign, jpsResign);
+    if (!jpsResign)
+    {
+      ASSERT_LE(jpsPath.size(), aStarPath.size());
+      ASSERT_FALSE(visited[jpsPath.back().pos.y][jpsPath.back().pos.x]);
+      std::list<gridNode_t>::iterator it = jpsPath.begin(), prev = it++;
+      for (; it != jpsPath.end(); prev = it++)
+      {
+        ASSERT_FALSE(grid[it->pos.y][it->pos.x]);
+        ASSERT_EQ(1, abs(it->pos.x - prev->pos.x) + abs(it->pos.y - prev->pos.y));
+      }
+    }
+  }
+}
+
+/*
+ * Benchmark on an open warehouse: long rack rows with cross aisles, all covered except one far corner.
+ * Reports the time of both searches, the paths must have equal length
+ */
+TEST(TestJpsToOpenSpace, benchmarkOpenWarehouse)
+{
+  int size = 300;
+  std::vector<std::vector<bool> > grid = makeTestGrid(size, size, false);
+  for (int y = 4; y < size - 4; y += 6)
+  {
+    for (int x = 4; x < size - 4; ++x)
+    {
+      grid[y][x] = (x % 50) != 0;  // Rack row with a cross aisle every 50 nodes
+    }
+  }
+  std::vector<std::vector<bool> > visited = makeTestGrid(size, size, true);
+  visited[size - 1][size - 1] = false;
+  std::list<Point_t> goals = map_2_goals(visited, false);
+
+  gridNode_t start = {{0, 0}, 0, 0};  // NOLINT
+  std::list<gridNode_t> aStarPath, jpsPath;
+
+  std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+  ASSERT_FALSE(a_star_to_open_space(grid, start, 1, visited, goals, aStarPath));
+  std::chrono::steady_clock::time_point middle = std::chrono::steady_clock::now();
+  ASSERT_FALSE(jps_to_open_space(grid, start, 1, visited, jpsPath));
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+  std::cout << "A*:  " << std::chrono::duration_cast<std::chrono::microseconds>(middle - begin).count() << " us, "
+            << "JPS: " << std::chrono::duration_cast<std::chrono::microseconds>(end - middle).count() << " us"
+            << std::endl;
+  ASSERT_EQ(2 * (size - 1) + 1, jpsPath.size());
+  ASSERT_EQ(aStarPath.size(), jpsPath.size());
+}
+
+/**
+ * Travel cost of a path from the search functions: steps and turns, with the heading at the first node given
+ */
+static int travelCost(std::list<gridNode_t> const& path, int heading, int cost, int turn_cost)
+{
+  std::list<Point_t> points;
+  if (heading >= 0 && !path.empty())
+  {
+    int dx[] = { 1, 0, -1, 0 }, dy[] = { 0, 1, 0, -1 };  // NOLINT
+    Point_t before = { path.front().pos.x - dx[heading], path.front().pos.y - dy[heading] };
+    points.push_back(before);
+  }
+  for (std::list<gridNode_t>::const_iterator it = path.begin(); it != path.end(); ++it)
+  {
+    points.push_back(it->pos);
+  }
+  int steps = path.empty() ? 0 : path.size() - 1;
+  return cost * steps + turn_cost * count_turns(points);
+}
+
+/*
+ * In an open room, a path to the opposite corner with as few turns as possible is as short as any other
+ */
+TEST(TestTurnAwareToOpenSpace, testSingleTurnAcrossRoom)
+{
+  std::vector<std::vector<bool> > grid = makeTestGrid(5, 5, false);
+  std::vector<std::vector<bool> > visited = makeTestGrid(5, 5, true);
+  visited[4][4] = false;
+  std::list<Point_t> goals = map_2_goals(visited, false);
+
+  gridNode_t start = {{0, 0}, 0, 0};  // NOLINT
+  std::list<gridNode_t> pathNodes;
+  ASSERT_FALSE(turn_aware_to_open_space(grid, start, 2, 1, 3, visited, goals, pathNodes));
+  ASSERT_EQ(9, pathNodes.size());
+  // Heading -x at the start: turn to +y, and turn to +x once, instead of turning around
+  ASSERT_EQ(8 + 3 * 2, travelCost(pathNodes, 2, 1, 3));
+}
+
+/*
+ * When turns are expensive, a longer path without turns wins.
+ * From (0, 1) heading +x, the open node at (2, 0) is close, but (6, 1) is straight ahead
+ */
+TEST(TestTurnAwareToOpenSpace, testPrefersStraightAhead)
+{
+  std::vector<std::vector<bool> > grid = makeTestGrid(7, 2, false);
+  std::vector<std::vector<bool> > visited = makeTestGrid(7, 2, true);
+  visited[0][2] = false;
+  visited[1][6] = false;
+  std::list<Point_t> goals = map_2_goals(visited, false);
+
+  gridNode_t start = {{0, 1}, 0, 0};  // NOLINT
+  std::list<gridNode_t> cheapTurns, expensiveTurns;
+  ASSERT_FALSE(turn_aware_to_open_space(grid, start, 0, 1, 0, visited, goals, cheapTurns));
+  ASSERT_FALSE(turn_aware_to_open_space(grid, start, 0, 1, 5, visited, goals, expensiveTurns));
+  ASSERT_EQ(2, cheapTurns.back().pos.x);
+  ASSERT_EQ(6, expensiveTurns.back().pos.x);
+  ASSERT_EQ(7, expensiveTurns.size());
+}
+
+/*
+ * The turn-aware search finds paths that are never more expensive in travel time than those of A* and JPS
+ */
+TEST(TestTurnAwareToOpenSpace, testRandomMapsNotMoreExpensive)
+{
+  unsigned int seed = 12345;
+  for (int i = 0; i < 50; ++i)
+  {
+    int x_size = rand_r(&seed) % 30 + 2;
+    int y_size = rand_r(&seed) % 30 + 2;
+    std::vector<std::vector<bool> > grid = makeTestGrid(x_size, y_size, false);
+    std::vector<std::vector<bool> > visited = makeTestGrid(x_size, y_size, true);
+    for (int y = 0; y < y_size; ++y)
+    {
+      for (int x = 0; x < x_size; ++x)
+      {
+        grid[y][x] = (rand_r(&seed) % 100) < 20;
+        visited[y][x] = grid[y][x] || (rand_r(&seed) % 100) < 95;
+      }
+    }
+    gridNode_t start = {{0, 0}, 0, 0};  // NOLINT
+    grid[0][0] = false;
+    visited[0][0] = true;
+    int heading = rand_r(&seed) % 5 - 1;
+    int turn_cost = rand_r(&seed) % 5;
+
+    std::list<Point_t> goals = map_2_goals(visited, false);
+    std::list<gridNode_t> aStarPath, jpsPath, turnAwarePath;
+    bool aStarResign = a_star_to_open_space(grid, start, 1, visited, goals, aStarPath);
+    bool jpsResign = jps_to_open_space(grid, start, 1, visited, jpsPath);
+    bool turnAwareResign = turn_aware_to_open_space(grid, start, heading, 1, turn_cost, visited, goals,
+                                                    turnAwarePath);
+
+    ASSERT_EQ(jpsResign, turnAwareResign);
+    ASSERT_EQ(aStarResign, turnAwareResign);
+    if (!turnAwareResign)
+    {
+      ASSERT_FALSE(visited[turnAwarePath.back().pos.y][turnAwarePath.back().pos.x]);
+      ASSERT_LE(travelCost(turnAwarePath, heading, 1, turn_cost), travelCost(jpsPath, heading, 1, turn_cost));
+      ASSERT_LE(travelCost(turnAwarePath, heading, 1, turn_cost), travelCost(aStarPath, heading, 1, turn_cost));
+      std::list<gridNode_t>::iterator it = turnAwarePath.begin(), prev = it++;
+      for (; it != turnAwarePath.end(); prev = it++)
+      {
+        ASSERT_FALSE(grid[it->pos.y][it->pos.x]);
+        ASSERT_EQ(1, abs(it->pos.x - prev->pos.x) + abs(it->pos.y - prev->pos.y));
+      }
+    }
+  }
+}
+
+/*
+ * Search time of the turn-aware search against the plain searches, on the warehouse of benchmarkOpenWarehouse
+ */
+TEST(TestTurnAwareToOpenSpace, benchmarkOpenWarehouse)
+{
+  int size = 300;
+  std::vector<std::vector<bool> > grid = makeTestGrid(size, size, false);
+  for (int y = 4; y < size - 4; y += 6)
+  {
+    for (int x = 4; x < size - 4; ++x)
+    {
+      grid[y][x] = (x % 50) != 0;  // Rack row with a cross aisle every 50 nodes
+    }
+  }
+  std::vector<std::vector<bool> > visited = makeTestGrid(size, size, true);
+  visited[size - 1][size - 1] = false;
+  std::list<Point_t> goals = map_2_goals(visited, false);
+
+  gridNode_t start = {{0, 0}, 0, 0};  // NOLINT
+  std::list<gridNode_t> aStarPath, jpsPath, turnAwarePath;
+
+  std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+  ASSERT_FALSE(a_star_to_open_space(grid, start, 1, visited, goals, aStarPath));
+  std::chrono::steady_clock::time_point middle = std::chrono::steady_clock::now();
+  ASSERT_FALSE(jps_to_open_space(grid, start, 1, visited, jpsPath));
+  std::chrono::steady_clock::time_point later = std::chrono::steady_clock::now();
+  ASSERT_FALSE(turn_aware_to_open_space(grid, start, -1, 10, 10, visited, goals, turnAwarePath));
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+  std::cout << "A*:  " << std::chrono::duration_cast<std::chrono::microseconds>(middle - begin).count() << " us, "
+            << "JPS: " << std::chrono::duration_cast<std::chrono::microseconds>(later - middle).count() << " us, "
+            << "turn-aware: " << std::chrono::duration_cast<std::chrono::microseconds>(end - later).count() << " us"
+            << std::endl;
+  std::cout << "Turns A*: " << travelCost(aStarPath, -1, 0, 1) << ", JPS: " << travelCost(jpsPath, -1, 0, 1)
+            << ", turn-aware: " << travelCost(turnAwarePath, -1, 0, 1) << std::endl;
+  ASSERT_EQ(jpsPath.size(), turnAwarePath.size());
+  ASSERT_LE(travelCost(turnAwarePath, -1, 0, 1), travelCost(jpsPath, -1, 0, 1));
+}
+
+/*
+ * A detour over cheap nodes is taken instead of the straight way over expensive ones
+ */
+TEST(TestDialToOpenSpace, testDetourAroundExpensiveNodes)
+{
+  std::vector<std::vector<bool> > grid = makeTestGrid(5, 3, false);
+  std::vector<std::vector<bool> > visited = makeTestGrid(5, 3, true);
+  visited[1][4] = false;
+  CostGrid costs(5, 3, 0);
+  for (int x = 1; x < 4; ++x)
+  {
+    costs.set(x, 1, 50);
+  }
+
+  gridNode_t start = {{0, 1}, 0, 0};  // NOLINT
+  std::list<gridNode_t> pathNodes;
+  ASSERT_FALSE(dial_to_open_space(grid, costs, start, 1, visited, pathNodes));
+  ASSERT_EQ(7, pathNodes.size());  // Up or down, 4 steps along, and back to the middle row
+  ASSERT_EQ(6, pathNodes.back().cost);
+  ASSERT_NE(1, (++pathNodes.begin())->pos.y);
+}
+
+/*
+ * Without costs, the bucket queue search finds paths as short as JPS, and with costs it finds the cheapest one
+ */
+TEST(TestDialToOpenSpace, testRandomMaps)
+{
+  unsigned int seed = 12345;
+  for (int i = 0; i < 50; ++i)
+  {
+    int x_size = rand_r(&seed) % 30 + 2;
+    int y_size = rand_r(&seed) % 30 + 2;
+    std::vector<std::vector<bool> > grid = makeTestGrid(x_size, y_size, false);
+    std::vector<std::vector<bool> > visited = makeTestGrid(x_size, y_size, true);
+    CostGrid zero(x_size, y_size, 0), costs(x_size, y_size, 0);
+    for (int y = 0; y < y_size; ++y)
+    {
+      for (int x = 0; x < x_size; ++x)
+      {
+        grid[y][x] = (rand_r(&seed) % 100) < 20;
+        visited[y][x] = grid[y][x] || (rand_r(&seed) % 100) < 95;
+        costs.set(x, y, rand_r(&seed) % 256);
+      }
+    }
+    gridNode_t start = {{0, 0}, 0, 0};  // NOLINT
+    grid[0][0] = false;
+    visited[0][0] = true;
+
+    std::list<gridNode_t> jpsPath, dialPath, costPath;
+    bool jpsResign = jps_to_open_space(grid, start, 1, visited, jpsPath);
+    ASSERT_EQ(jpsResign, dial_to_open_space(grid, zero, start, 1, visited, dialPath));
+    ASSERT_EQ(jpsResign, dial_to_open_space(grid, costs, start, 1, visited, costPath));
+    if (!jpsResign)
+    {
+      ASSERT_EQ(jpsPath.size(), dialPath.size());
+      ASSERT_FALSE(visited[costPath.back().pos.y][costPath.back().pos.x]);
+      int pathCost = 0;
+      std::list<gridNode_t>::iterator it = costPath.begin(), prev = it++;
+      for (; it != costPath.end(); prev = it++)
+      {
+        ASSERT_FALSE(grid[it->pos.y][it->pos.x]);
+        ASSERT_EQ(1, abs(it->pos.x - prev->pos.x) + abs(it->pos.y - prev->pos.y));
+        pathCost += 1 + costs.get(it->pos.x, it->pos.y);
+      }
+      ASSERT_EQ(pathCost, costPath.back().cost);
+      // Any other path, like the one of JPS, is at least as expensive
+      int jpsCost = 0;
+      for (it = ++jpsPath.begin(); it != jpsPath.end(); ++it)
+      {
+        jpsCost += 1 + costs.get(it->pos.x, it->pos.y);
+      }
+      ASSERT_LE(pathCost, jpsCost);
+    }
+  }
+}
+
+TEST(TestCountTurns, testTurnsAndReversal)
+{
+  std::list<Point_t> path;
+  Point_t points[] = { {0, 0}, {1, 0}, {2, 0}, {2, 1}, {1, 1}, {2, 1} };  // NOLINT
+  for (int i = 0; i < 6; ++i)
+  {
+    path.push_back(points[i]);
+  }
+  // Left turn, left turn, turning around
+  ASSERT_EQ(4, count_turns(path));
+}
+
+TEST(TestPointInPolygon, testConcavePolygon)
+{
+  // L-shape: a 2x2 square with the top right quadrant cut out
+  fPoint_t vertices[] = { {0, 0}, {2, 0}, {2, 1}, {1, 1}, {1, 2}, {0, 2} };  // NOLINT
+  std::vector<fPoint_t> polygon(vertices, vertices + 6);
+  fPoint_t inside[] = { {0.5, 0.5}, {1.5, 0.5}, {0.5, 1.5} };  // NOLINT
+  fPoint_t outside[] = { {1.5, 1.5}, {-0.5, 0.5}, {2.5, 0.5}, {0.5, 2.5} };  // NOLINT
+  for (int i = 0; i < 3; ++i)
+  {
+    ASSERT_TRUE(point_in_polygon(inside[i], polygon));
+  }
+  for (int i = 0; i < 4; ++i)
+  {
+    ASSERT_FALSE(point_in_polygon(outside[i], polygon));
+  }
+  ASSERT_FALSE(point_in_polygon(inside[0], std::vector<fPoint_t>()));
+}
+
+TEST(TestSquaredDistanceTransform, testRandomAgainstBruteForce)
+{
+  unsigned int seed = 12345;
+  for (int i = 0; i < 20; ++i)
+  {
+    int width = rand_r(&seed) % 40 + 1, height = rand_r(&seed) % 40 + 1;
+    std::vector<bool> occupied(width * height, false);
+    int nOccupied = rand_r(&seed) % 10;  // Sometimes none at all
+    for (int k = 0; k < nOccupied; ++k)
+    {
+      occupied[rand_r(&seed) % (width * height)] = true;
+    }
+    std::vector<int> d2;
+    squared_distance_transform(occupied, width, height, d2);
+    for (int y = 0; y < height; ++y)
+    {
+      for (int x = 0; x < width; ++x)
+      {
+        int expected = INT_MAX;
+        for (int k = 0; k < width * height; ++k)
+        {
+          if (occupied[k])
+          {
+            Point_t p = { x, y }, q = { k % width, k / width };  // NOLINT
+            expected = std::min(expected, distanceSquared(p, q));
+          }
+        }
+        ASSERT_EQ(expected, d2[y * width + x]);
+      }
+    }
+  }
+}
+
+/*
+ * Inflating obstacles by a large radius: the distance transform against checking a square around every cell,
+ * like parseGrid does with a square footprint. Reports the time of both
+ */
+TEST(TestSquaredDistanceTransform, benchmarkLargeRadius)
+{
+  int size = 300, radius = 15;
+  unsigned int seed = 12345;
+  std::vector<bool> occupied(size * size, false);
+  for (int k = 0; k < 100; ++k)
+  {
+    occupied[rand_r(&seed) % (size * size)] = true;
+  }
+
+  std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+  std::vector<bool> square(size * size, false);
+  for (int y = 0; y < size; ++y)
+  {
+    for (int x = 0; x < size; ++x)
+    {
+      for (int dy = -radius; dy <= radius && !square[y * size + x]; ++dy)
+      {
+        for (int dx = -radius; dx <= radius; ++dx)
+        {
+          int x2 = std::min(std::max(x + dx, 0), size - 1), y2 = std::min(std::max(y + dy, 0), size - 1);
+          if (occupied[y2 * size + x2])
+          {
+            square[y * size + x] = true;
+            break;
+          }
+        }
+      }
+    }
+  }
+  std::chrono::steady_clock::time_point middle = std::chrono::steady_clock::now();
+  std::vector<int> d2;
+  squared_distance_transform(occupied, size, size, d2);
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+  std::cout << "Square: " << std::chrono::duration_cast<std::chrono::milliseconds>(middle - begin).count() << " ms, "
+            << "distance transform: " << std::chrono::duration_cast<std::chrono::milliseconds>(end - middle).count()
+            << " ms" << std::endl;
+  // The disk lies within the square
+  for (int k = 0; k < size * size; ++k)
+  {
+    ASSERT_TRUE(square[k] || d2[k] > radius * radius);
+  }
+}
+
+TEST(TestMarkCoveredTiles, testFinerAndCoarserCoverage)
+{
+  // 4x2 tiles of 0.2 m, starting at (1, 1)
+  std::vector<std::vector<bool> > grid = makeTestGrid(4, 2, false);
+  grid[1][3] = true;
+  fPoint_t grid_origin = { 1.0, 1.0 };  // NOLINT
+
+  // Cells of 0.05 m from (1, 1): the left half of the tiles is covered, apart from a single cell of tile (1, 0)
+  RowMajorGrid fine(16, 8);
+  for (int y = 0; y < 8; ++y)
+  {
+    for (int x = 0; x < 8; ++x)
+    {
+      fine.set(x, y, true);
+    }
+  }
+  fine.set(5, 2, false);
+  fPoint_t origin = { 1.0, 1.0 };  // NOLINT
+  std::vector<std::vector<bool> > visited = makeTestGrid(4, 2, false);
+  ASSERT_EQ(3, mark_covered_tiles(grid, fine, 0.05, origin, 0.2, grid_origin, 1.0, visited));
+  ASSERT_TRUE(visited[0][0] && visited[1][0] && visited[1][1]);
+  ASSERT_FALSE(visited[0][1] || visited[0][2] || visited[1][2]);
+  // 15 of the 16 cells is enough when 90% is
+  ASSERT_EQ(1, mark_covered_tiles(grid, fine, 0.05, origin, 0.2, grid_origin, 0.9, visited));
+  ASSERT_TRUE(visited[0][1]);
+
+  // Cells of 0.5 m from (0.52, 0.52): only the right column of tiles has the center of a cell in the covered cell,
+  // the others take the cell under their centers, and the obstacle is not marked
+  RowMajorGrid coarse(3, 3);
+  coarse.set(2, 1, true);
+  fPoint_t coarse_origin = { 0.52, 0.52 };  // NOLINT
+  visited = makeTestGrid(4, 2, false);
+  ASSERT_EQ(1, mark_covered_tiles(grid, coarse, 0.5, coarse_origin, 0.2, grid_origin, 1.0, visited));
+  ASSERT_TRUE(visited[0][3]);
+  ASSERT_FALSE(visited[0][2] || visited[1][3]);
+}
+
+/*
+ * Steps to 4-neighbors, repeated points, jumps and runs longer than fit in a code must all come back unchanged
+ */
+TEST(TestCompactPath, testRoundTrip)
+{
+  unsigned int seed = 1357;
+  std::list<Point_t> points;
+  Point_t p = { -3, 70000 };  // NOLINT
+  points.push_back(p);
+  int dirX[] = { 1, 0, -1, 0 };  // NOLINT
+  int dirY[] = { 0, 1, 0, -1 };  // NOLINT
+  for (int i = 0; i < 2000; ++i)
+  {
+    int kind = rand_r(&seed) % 20;
+    int dir = rand_r(&seed) % 4;
+    int length = (kind == 0) ? full_coverage_path_planner::CompactPath::MAX_RUN + 5 : 1 + rand_r(&seed) % 8;
+    if (kind == 1)
+    {
+      // Repeated point
+      points.push_back(p);
+      continue;
+    }
+    if (kind == 2)
+    {
+      p.x += rand_r(&seed) % 100000 - 50000;
+      p.y -= rand_r(&seed) % 3 + 2;
+      points.push_back(p);
+      continue;
+    }
+    for (int j = 0; j < length; ++j)
+    {
+      p.x += dirX[dir];
+      p.y += dirY[dir];
+      points.push_back(p);
+    }
+  }
+
+  full_coverage_path_planner::CompactPath path(points);
+  ASSERT_EQ(points.size(), path.size());
+  ASSERT_TRUE(points.front() == path.front());
+  ASSERT_TRUE(points.back() == path.back());
+  ASSERT_TRUE(path.toList() == points);
+  ASSERT_TRUE(std::equal(points.begin(), points.end(), path.begin()));
+  ASSERT_EQ(count_turns(points), count_turns(path));
+
+  // Taking over the codes gives the same path, as long as they match the number of points
+  full_coverage_path_planner::CompactPath copy(path.front(), path.size(), path.codes());
+  ASSERT_TRUE(copy.back() == path.back());
+  ASSERT_TRUE(copy.toList() == points);
+  ASSERT_THROW(full_coverage_path_planner::CompactPath(path.front(), path.size() + 1, path.codes()),
+               std::invalid_argument);
+  std::vector<uint16_t> cutOff(1, 0);
+  ASSERT_THROW(full_coverage_path_planner::CompactPath(path.front(), 2, cutOff), std::invalid_argument);
+
+  // The runs join up from the first to the last point
+  full_coverage_path_planner::CompactPath::RunReader runs(path);
+  full_coverage_path_planner::CompactPath::run_t run;
+  Point_t at = path.front();
+  std::size_t steps = 0;
+  while (runs.next(run))
+  {
+    ASSERT_TRUE(run.from == at);
+    at = run.to;
+    steps += run.length;
+  }
+  ASSERT_TRUE(at == path.back());
+  ASSERT_EQ(points.size() - 1, steps);
+
+  full_coverage_path_planner::CompactPath single(points.begin(), ++points.begin());
+  full_coverage_path_planner::CompactPath::RunReader singleRuns(single);
+  ASSERT_EQ(1, single.size());
+  ASSERT_FALSE(singleRuns.next(run));
+  ASSERT_TRUE(single.begin() != single.end());
+  ASSERT_TRUE(++single.begin() == single.end());
+}
+
+/*
+ * A boustrophedon path takes a code per lane, and even a path that turns at every point takes 2 bytes per point,
+ * against 24 bytes or more per point for a std::list
+ */
+TEST(TestCompactPath, testMemoryUsage)
+{
+  int size = 1000;
+  full_coverage_path_planner::CompactPath lanes, stairs;
+  for (int y = 0; y < size; ++y)
+  {
+    for (int i = 0; i < size; ++i)
+    {
+      Point_t lane = { (y % 2 == 0) ? i : size - 1 - i, y };  // NOLINT
+      lanes.push_back(lane);
+      Point_t stair = { (y * size + i + 1) / 2, (y * size + i) / 2 };  // NOLINT
+      stairs.push_back(stair);
+    }
+  }
+  lanes.shrink_to_fit();
+  stairs.shrink_to_fit();
+  std::size_t listBytes = lanes.size() * (sizeof(Point_t) + 2 * sizeof(void*));
+  std::cout << "List: " << listBytes << " bytes, lanes: " << lanes.memoryUsage() << " bytes, stairs: "
+            << stairs.memoryUsage() << " bytes" << std::endl;
+  ASSERT_EQ(2 * size - 1, lanes.codeCount());
+  ASSERT_EQ(2 * (size - 1), count_turns(lanes));
+  ASSERT_GE(listBytes, 100 * lanes.memoryUsage());
+  ASSERT_GE(listBytes, 10 * stairs.memoryUsage());
+}
+
 // Run all the tests that were declared with TEST()
 int main(int argc, char **argv)
 {
@@ -0,0 +1,250 @@
+//
+// Copyright [2020] Nobleo Technology"  [legal/copyright]
+//
+
+/*
+ * Time from publishing a plan to a subscriber having it, for a subscriber in the same process, like a nodelet in the
+ * same manager as the planner, and for plan_delivery_listener in a process of its own. Run with
+ * test_plan_delivery.test, which starts the listener.
+ */
+#include <stdint.h>
+#include <atomic>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <nav_msgs/Path.h>
+#include <ros/ros.h>
+#include <ros/serialization.h>
+#include <std_msgs/Float64.h>
+
+#include <full_coverage_path_planner/compact_plan.h>
+#include <full_coverage_path_planner/spiral_stc.h>
+#include <full_coverage_path_planner/util.h>
+#include <full_coverage_path_planner/waypoint_generator.h>
+
+using full_coverage_path_planner::CompactPlan;
+
+/**
+ * Delivery times of one kind of plan, in seconds. Added to by the callbacks on the threads of the spinner
+ */
+class LatencyLog
+{
+public:
+  void add(double latency)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    latencies_.push_back(latency);
+  }
+
+  std::size_t count() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return latencies_.size();
+  }
+
+  double mean() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    double sum = 0;
+    for (std::size_t i = 0; i < latencies_.size(); ++i)
+    {
+      sum += latencies_[i];
+    }
+    return latencies_.empty() ? 0 : sum / latencies_.size();
+  }
+
+  /**
+   * Wait until count deliveries were logged
+   * @return false if that took longer than timeout seconds
+   */
+  bool waitFor(std::size_t count, double timeout) const
+  {
+    ros::WallTime end = ros::WallTime::now() + ros::WallDuration(timeout);
+    while (this->count() < count && ros::WallTime::now() < end)
+    {
+      ros::WallDuration(0.0001).sleep();
+    }
+    return this->count() >= count;
+  }
+
+private:
+  mutable std::mutex mutex_;
+  std::vector<double> latencies_;
+};
+
+/**
+ * Seconds since stamp, the wall time at which a plan was published
+ */
+static double secondsSince(ros::Time const& stamp)
+{
+  return (ros::WallTime::now() - ros::WallTime(stamp.sec, stamp.nsec)).toSec();
+}
+
+/**
+ * The subscribers of the plans in this process, and of the delivery times that plan_delivery_listener reports
+ */
+class DeliveryRecorder
+{
+public:
+  explicit DeliveryRecorder(ros::NodeHandle& nh)
+    : received_plan(NULL),
+      plan_sub_(nh.subscribe("plan", 10, &DeliveryRecorder::onPlan, this)),
+      compact_plan_sub_(nh.subscribe("compact_plan", 10, &DeliveryRecorder::onCompactPlan, this)),
+      plan_latency_sub_(nh.subscribe("plan_latency", 10, &DeliveryRecorder::onPlanLatency, this)),
+      compact_plan_latency_sub_(nh.subscribe("compact_plan_latency", 10, &DeliveryRecorder::onCompactPlanLatency,
+                                             this))
+  {
+  }
+
+  /**
+   * Whether the listener in the other process is connected both ways
+   */
+  bool listenerConnected() const
+  {
+    return plan_latency_sub_.getNumPublishers() > 0 && compact_plan_latency_sub_.getNumPublishers() > 0;
+  }
+
+  LatencyLog plans, compact_plans, listener_plans, listener_compact_plans;
+  std::atomic<nav_msgs::Path const*> received_plan;  // The last plan received in this process
+
+private:
+  void onPlan(nav_msgs::Path::ConstPtr const& msg)
+  {
+    plans.add(secondsSince(msg->header.stamp));
+    received_plan = msg.get();
+  }
+
+  /**
+   * The compact plan is decoded to poses, like plan_delivery_listener does
+   */
+  void onCompactPlan(CompactPlan::ConstPtr const& msg)
+  {
+    full_coverage_path_planner::WaypointGenerator waypoints =
+        full_coverage_path_planner::CompactPlanDecoder(*msg).waypoints();
+    std::vector<geometry_msgs::PoseStamped> poses(waypoints.size());
+    for (std::size_t i = 0; i < poses.size(); ++i)
+    {
+      waypoints.next(poses[i]);
+    }
+    compact_plans.add(secondsSince(msg->header.stamp));
+  }
+
+  void onPlanLatency(std_msgs::Float64::ConstPtr const& msg)
+  {
+    listener_plans.add(msg->data);
+  }
+
+  void onCompactPlanLatency(std_msgs::Float64::ConstPtr const& msg)
+  {
+    listener_compact_plans.add(msg->data);
+  }
+
+  ros::Subscriber plan_sub_;
+  ros::Subscriber compact_plan_sub_;
+  ros::Subscriber plan_latency_sub_;
+  ros::Subscriber compact_plan_latency_sub_;
+};
+
+/**
+ * The wall time now, as the stamp of a plan
+ */
+static ros::Time wallStamp()
+{
+  ros::WallTime now = ros::WallTime::now();
+  return ros::Time(now.sec, now.nsec);
+}
+
+/*
+ * Publish a plan of a warehouse a few times, and compare the delivery in this process, which passes the message
+ * itself, with the delivery to another process, which serializes it and sends it over the loopback interface.
+ * Increase size for plans of a large site.
+ */
+TEST(TestPlanDelivery, benchmarkLatency)
+{
+  int size = 300, repeats = 10;
+  std::vector<std::vector<bool> > grid = makeTestGrid(size, size, false);
+  for (int y = 5; y < size - 5; y += 8)
+  {
+    for (int x = 5; x < size - 5; ++x)
+    {
+      grid[y][x] = (x % 40) != 0;  // Rack row with a cross aisle every 40 nodes
+    }
+  }
+  Point_t start = {0, 0};  // NOLINT
+  int multiple_pass_counter, visited_counter;
+  full_coverage_path_planner::CompactPath path(
+      full_coverage_path_planner::SpiralSTC::spiral_stc(grid, start, multiple_pass_counter, visited_counter));
+  fPoint_t origin = { 0.0, 0.0 };  // NOLINT
+  geometry_msgs::PoseStamped startPose;
+  startPose.header.frame_id = "map";
+
+  nav_msgs::Path plan;
+  plan.header.frame_id = "map";
+  full_coverage_path_planner::WaypointGenerator generator(startPose, path, 0.5, origin);
+  plan.poses.resize(generator.size());
+  for (std::size_t i = 0; i < plan.poses.size(); ++i)
+  {
+    generator.next(plan.poses[i]);
+  }
+  CompactPlan compact;
+  full_coverage_path_planner::toCompactPlanMsg(startPose, path, origin, 0.5, compact);
+
+  ros::NodeHandle nh;
+  ros::Publisher plan_pub = nh.advertise<nav_msgs::Path>("plan", 1);
+  ros::Publisher compact_plan_pub = nh.advertise<CompactPlan>("compact_plan", 1);
+  DeliveryRecorder recorder(nh);
+  ros::AsyncSpinner spinner(2);
+  spinner.start();
+
+  // Both the subscriber in this process and the listener
+  ros::WallTime end = ros::WallTime::now() + ros::WallDuration(30.0);
+  while ((plan_pub.getNumSubscribers() < 2 || compact_plan_pub.getNumSubscribers() < 2 ||
+          !recorder.listenerConnected()) && ros::WallTime::now() < end)
+  {
+    ros::WallDuration(0.01).sleep();
+  }
+  ASSERT_EQ(2, plan_pub.getNumSubscribers());
+  ASSERT_EQ(2, compact_plan_pub.getNumSubscribers());
+  ASSERT_TRUE(recorder.listenerConnected());
+
+  for (int i = 1; i <= repeats; ++i)
+  {
+    // Every plan is a new message, a published message must not be changed anymore
+    nav_msgs::Path::Ptr planMsg(new nav_msgs::Path(plan));
+    planMsg->header.stamp = wallStamp();
+    plan_pub.publish(nav_msgs::Path::ConstPtr(planMsg));
+    ASSERT_TRUE(recorder.plans.waitFor(i, 10.0));
+    ASSERT_TRUE(recorder.listener_plans.waitFor(i, 10.0));
+    ASSERT_EQ(planMsg.get(), recorder.received_plan.load());
+
+    CompactPlan::Ptr compactMsg(new CompactPlan(compact));
+    compactMsg->header.stamp = wallStamp();
+    compact_plan_pub.publish(CompactPlan::ConstPtr(compactMsg));
+    ASSERT_TRUE(recorder.compact_plans.waitFor(i, 10.0));
+    ASSERT_TRUE(recorder.listener_compact_plans.waitFor(i, 10.0));
+  }
+  spinner.stop();
+
+  uint32_t pathBytes = ros::serialization::serializationLength(plan);
+  uint32_t compactBytes = ros::serialization::serializationLength(compact);
+  std::cout << plan.poses.size() << " poses, averaged over " << repeats << " plans" << std::endl;
+  std::cout << "nav_msgs/Path, " << pathBytes << " bytes: " << 1e6 * recorder.plans.mean() << " us in process, "
+            << 1e6 * recorder.listener_plans.mean() << " us in another process" << std::endl;
+  std::cout << "compact plan, " << compactBytes << " bytes, decoded: " << 1e6 * recorder.compact_plans.mean()
+            << " us in process, " << 1e6 * recorder.listener_compact_plans.mean() << " us in another process"
+            << std::endl;
+
+  ASSERT_LT(compactBytes, pathBytes);
+  ASSERT_LT(recorder.plans.mean(), recorder.listener_plans.mean());
+}
+
+// Run all the tests that were declared with TEST()
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "test_plan_delivery");
+  return RUN_ALL_TESTS();
+}
@@ -10,22 +10,40 @@
  * By putting the path nodes in a set, we are left with only the unique elements
  *  and then we can count how big that set is (i.e. the cardinality of the set of path nodes)
  */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
 #include <list>
+#include <new>
 #include <set>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 #include <time.h>
 #include <stdlib.h>
+#include <unistd.h>
 
 #include <gtest/gtest.h>
 #include <opencv2/imgproc.hpp>
 #include <opencv2/highgui.hpp>
 #include <opencv2/opencv.hpp>
+#include <nav_msgs/OccupancyGrid.h>
+#include <nav_msgs/Path.h>
 #include <ros/ros.h>
 
 #include <full_coverage_path_planner/common.h>
+#include <full_coverage_path_planner/compact_plan.h>
+#include <full_coverage_path_planner/hierarchical_search.h>
+#include <full_coverage_path_planner/lazy_occupancy_grid.h>
+#include <full_coverage_path_planner/mapped_grid.h>
+#include <full_coverage_path_planner/region_tour.h>
 #include <full_coverage_path_planner/spiral_stc.h>
 #include <full_coverage_path_planner/util.h>
+#include <full_coverage_path_planner/waypoint_generator.h>
 
 cv::Mat drawMap(std::vector<std::vector<bool> > const& grid);
 
@@ -34,6 +52,42 @@ cv::Mat drawPath(const cv::Mat &mapImg,
                  const Point_t &start,
                  std::list<Point_t> &path);
 
+/*
+ * Count all heap allocations of the tests and the bytes they hold, for testAllocationCount and testPeakMemory.
+ * Every allocation is prefixed with its size, so that delete knows how much is given back
+ */
+static std::atomic<std::size_t> allocation_counter(0);
+static std::atomic<std::size_t> allocated_bytes(0);
+static std::atomic<std::size_t> peak_allocated_bytes(0);
+static const std::size_t allocation_header = alignof(std::max_align_t);
+
+void* operator new(std::size_t size)
+{
+  allocation_counter.fetch_add(1, std::memory_order_relaxed);
+  char* p = static_cast<char*>(malloc(size + allocation_header));
+  if (!p)
+  {
+    throw std::bad_alloc();
+  }
+  *reinterpret_cast<std::size_t*>(p) = size;
+  std::size_t bytes = allocated_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+  std::size_t peak = peak_allocated_bytes.load(std::memory_order_relaxed);
+  while (bytes > peak && !peak_allocated_bytes.compare_exchange_weak(peak, bytes, std::memory_order_relaxed))
+  {
+  }
+  return p + allocation_header;
+}
+
+void operator delete(void* p) noexcept
+{
+  if (p)
+  {
+    char* block = static_cast<char*>(p) - allocation_header;
+    allocated_bytes.fetch_sub(*reinterpret_cast<std::size_t*>(block), std::memory_order_relaxed);
+    free(block);
+  }
+}
+
 /*
  * On a map with nothing on it, spiral_stc should cover all the nodes of the map
  */
@@ -170,6 +224,41 @@ TEST(TestSpiralStc, testFillMapWithWall)
   ASSERT_EQ((4 * 4) - 3, pathSet.size());
 }
 
+/*
+ * On a map with an enclosed room, only the component containing the start is covered
+ *  and the nodes in the enclosed room are reported as unreachable
+ */
+TEST(TestSpiralStc, testEnclosedRoomIsUnreachable)
+{
+  /*
+   * [s 0 0 0 0]
+   * [0 0 1 1 1]
+   * [0 0 1 0 0]
+   * [0 0 1 0 0]
+   */
+  std::vector<std::vector<bool> > grid = makeTestGrid(5, 4, false);
+  grid[1][2] = 1;
+  grid[1][3] = 1;
+  grid[1][4] = 1;
+  grid[2][2] = 1;
+  grid[3][2] = 1;
+
+  Point_t start = {0, 0};
+  int multiple_pass_counter, visited_counter, unreachable_counter;
+  std::list<Point_t> path = full_coverage_path_planner::SpiralSTC::spiral_stc(grid,
+                                                                              start,
+                                                                              multiple_pass_counter,
+                                                                              visited_counter,
+                                                                              unreachable_counter);
+
+  // By Adding the nodes of the path to the set, we only retain the unique elements
+  std::set<Point_t, CompareByPosition> pathSet(path.begin(), path.end());
+
+  // 5 obstacles and a 2x2 room that cannot be entered
+  ASSERT_EQ((5 * 4) - 5 - 4, pathSet.size());
+  ASSERT_EQ(4, unreachable_counter);
+}
+
 /*
  * This test case features a very short dead-end
  */
@@ -539,6 +628,1101 @@ TEST(TestSpiralStc, testRandomMap)
   ASSERT_EQ(tests, success);
 }
 
+/*
+ * A path to open space found on the abstract level must still be a connected path on the grid,
+ * through the single gap in a wall that runs through several clusters
+ */
+TEST(TestHierarchicalSearch, testPathThroughGap)
+{
+  /*
+   * 12x12 map with 4x4 clusters. Everything left of the wall at x=6 is visited, the wall has a gap at y=10
+   */
+  std::vector<std::vector<bool> > grid = makeTestGrid(12, 12, false);
+  std::vector<std::vector<bool> > visited = makeTestGrid(12, 12, false);
+  for (int y = 0; y < 12; ++y)
+  {
+    grid[y][6] = (y != 10);
+    for (int x = 0; x <= 6; ++x)
+    {
+      visited[y][x] = true;
+    }
+  }
+
+  full_coverage_path_planner::HierarchicalSearch<NestedVectorView> search(NestedVectorView(grid, visited), 4);
+  search.initOpenCounts();
+  ASSERT_EQ(9, search.clusterCount());
+
+  gridNode_t start = {{0, 0}, 0, 0};  // NOLINT
+  std::list<gridNode_t> pathNodes;
+  ASSERT_FALSE(search.searchToOpenSpace(start, pathNodes));
+
+  // Path must consist of free, 4-connected steps and end in the first open node behind the gap
+  std::list<gridNode_t>::iterator it = pathNodes.begin(), prev = it++;
+  for (; it != pathNodes.end(); prev = it++)
+  {
+    ASSERT_FALSE(grid[it->pos.y][it->pos.x]);
+    ASSERT_EQ(1, abs(it->pos.x - prev->pos.x) + abs(it->pos.y - prev->pos.y));
+  }
+  ASSERT_EQ(7, pathNodes.back().pos.x);
+  ASSERT_EQ(10, pathNodes.back().pos.y);
+  ASSERT_EQ(6 + 10 + 1 + 1, pathNodes.size());  // Shortest path: 6 right, 10 up, through the gap, plus start
+}
+
+/*
+ * Same as testRandomMap, but using each of the alternative searches for backtracking
+ */
+TEST(TestSpiralStc, testRandomMapAlternativeSearch)
+{
+  int searches[] = { eSearchHierarchical, eSearchJumpPoint };  // NOLINT
+  for (int s = 0; s < 2; ++s)
+  {
+    unsigned int seed = 12345;
+    full_coverage_path_planner::SpiralSTC::spiral_stc_options_type options;
+    options.search = searches[s];
+    options.cluster_size = 8;
+    for (int i = 0; i < 5; ++i)
+    {
+      int x_size = rand_r(&seed) % 100 + 1;
+      int y_size = rand_r(&seed) % 100 + 1;
+      std::vector<std::vector<bool> > grid = makeTestGrid(x_size, y_size, false);
+      randomFillTestGrid(grid, 20);  // ...% fill of obstacles
+
+      cv::Mat mapImg = drawMap(grid);
+      Point_t start = findStart(grid);
+      int multiple_pass_counter, visited_counter, unreachable_counter;
+      std::list<Point_t> path = full_coverage_path_planner::SpiralSTC::spiral_stc(grid,
+                                                                                  start,
+                                                                                  multiple_pass_counter,
+                                                                                  visited_counter,
+                                                                                  unreachable_counter,
+                                                                                  options);
+
+      cv::Mat pathImg = mapImg.clone();
+      cv::Mat pathViz = drawPath(mapImg, pathImg, start, path);
+      EXPECT_EQ(0, calcDifference(mapImg, pathImg, start)) << "search " << options.search;
+    }
+  }
+}
+
+/*
+ * On a map without obstacles, every mega-cell is free: the spanning tree is circumnavigated in one loop,
+ * without visiting any node twice, and the loop ends next to the start
+ */
+TEST(TestSpiralStc, testSpanningTreeCoverageEmptyMap)
+{
+  std::vector<std::vector<bool> > grid = makeTestGrid(8, 6, false);
+  full_coverage_path_planner::SpiralSTC::spiral_stc_options_type options;
+  options.coverage = eCoverageSpanningTree;
+
+  Point_t start = {3, 2};  // NOLINT
+  int multiple_pass_counter, visited_counter, unreachable_counter;
+  std::list<Point_t> path = full_coverage_path_planner::SpiralSTC::spiral_stc(grid,
+                                                                              start,
+                                                                              multiple_pass_counter,
+                                                                              visited_counter,
+                                                                              unreachable_counter,
+                                                                              options);
+
+  ASSERT_EQ(8 * 6, path.size());
+  ASSERT_EQ(0, multiple_pass_counter);
+  std::set<Point_t, CompareByPosition> covered(path.begin(), path.end());
+  ASSERT_EQ(8 * 6, covered.size());
+  for (std::list<Point_t>::iterator it = ++path.begin(); it != path.end(); ++it)
+  {
+    std::list<Point_t>::iterator prev = it;
+    --prev;
+    ASSERT_EQ(1, abs(it->x - prev->x) + abs(it->y - prev->y));
+  }
+  ASSERT_EQ(1, abs(path.back().x - start.x) + abs(path.back().y - start.y));
+}
+
+/*
+ * Same as testRandomMap, but covering the free mega-cells with spanning trees
+ */
+TEST(TestSpiralStc, testRandomMapSpanningTree)
+{
+  unsigned int seed = 12345;
+  full_coverage_path_planner::SpiralSTC::spiral_stc_options_type options;
+  options.coverage = eCoverageSpanningTree;
+  for (int i = 0; i < 5; ++i)
+  {
+    int x_size = rand_r(&seed) % 100 + 1;
+    int y_size = rand_r(&seed) % 100 + 1;
+    std::vector<std::vector<bool> > grid = makeTestGrid(x_size, y_size, false);
+    randomFillTestGrid(grid, 5);  // ...% fill of obstacles, sparse enough to leave many free mega-cells
+
+    cv::Mat mapImg = drawMap(grid);
+    Point_t start = findStart(grid);
+    int multiple_pass_counter, visited_counter, unreachable_counter;
+    std::list<Point_t> path = full_coverage_path_planner::SpiralSTC::spiral_stc(grid,
+                                                                                start,
+                                                                                multiple_pass_counter,
+                                                                                visited_counter,
+                                                                                unreachable_counter,
+                                                                                options);
+
+    cv::Mat pathImg = mapImg.clone();
+    cv::Mat pathViz = drawPath(mapImg, pathImg, start, path);
+    EXPECT_EQ(0, calcDifference(mapImg, pathImg, start));
+  }
+}
+
+/*
+ * The best of several candidate plans must cover everything, cost no more than the plain spiral_stc plan
+ * and not depend on the number of threads
+ */
+TEST(TestSpiralStc, testRandomMapMultiStart)
+{
+  unsigned int seed = 12345;
+  for (int i = 0; i < 5; ++i)
+  {
+    int x_size = rand_r(&seed) % 100 + 1;
+    int y_size = rand_r(&seed) % 100 + 1;
+    std::vector<std::vector<bool> > grid = makeTestGrid(x_size, y_size, false);
+    randomFillTestGrid(grid, 20);  // ...% fill of obstacles
+
+    cv::Mat mapImg = drawMap(grid);
+    Point_t start = findStart(grid);
+    full_coverage_path_planner::SpiralSTC::spiral_stc_options_type options;
+    int multiple_pass_counter, visited_counter, unreachable_counter;
+    std::list<Point_t> single = full_coverage_path_planner::SpiralSTC::spiral_stc(grid,
+                                                                                  start,
+                                                                                  multiple_pass_counter,
+                                                                                  visited_counter,
+                                                                                  unreachable_counter,
+                                                                                  options);
+
+    options.candidates = 8;
+    std::list<Point_t> paths[2];
+    for (int t = 0; t < 2; ++t)
+    {
+      options.threads = 1 + 3 * t;
+      std::vector<std::vector<bool> > visited = makeTestGrid(x_size, y_size, false);
+      paths[t] = full_coverage_path_planner::SpiralSTC::spiral_stc_multi_start(NestedVectorView(grid, visited),
+                                                                                start,
+                                                                                multiple_pass_counter,
+                                                                                visited_counter,
+                                                                                unreachable_counter,
+                                                                                options);
+    }
+    ASSERT_TRUE(paths[0] == paths[1]);
+    ASSERT_TRUE(paths[0].front() == start);
+    ASSERT_LE(paths[0].size() + count_turns(paths[0]), single.size() + count_turns(single));
+
+    cv::Mat pathImg = mapImg.clone();
+    cv::Mat pathViz = drawPath(mapImg, pathImg, start, paths[0]);
+    EXPECT_EQ(0, calcDifference(mapImg, pathImg, start));
+  }
+}
+
+/*
+ * Same as testRandomMap, but with a cost for every node: with or without regions everything is still covered
+ */
+TEST(TestSpiralStc, testRandomMapWithCosts)
+{
+  unsigned int seed = 12345;
+  for (int i = 0; i < 5; ++i)
+  {
+    int x_size = rand_r(&seed) % 100 + 1;
+    int y_size = rand_r(&seed) % 100 + 1;
+    std::vector<std::vector<bool> > grid = makeTestGrid(x_size, y_size, false);
+    randomFillTestGrid(grid, 20);  // ...% fill of obstacles
+    CostGrid costs(x_size, y_size);
+    for (int y = 0; y < y_size; ++y)
+    {
+      for (int x = 0; x < x_size; ++x)
+      {
+        costs.set(x, y, rand_r(&seed) % 100);
+      }
+    }
+
+    cv::Mat mapImg = drawMap(grid);
+    Point_t start = findStart(grid);
+    full_coverage_path_planner::SpiralSTC::spiral_stc_options_type options;
+    options.costs = &costs;
+    options.region_size = 16;
+    for (int t = 1; t <= 2; ++t)
+    {
+      options.threads = t;
+      int multiple_pass_counter, visited_counter, unreachable_counter, saved_transit_counter;
+      std::vector<std::vector<bool> > visited = makeTestGrid(x_size, y_size, false);
+      std::list<Point_t> path = (t == 1)
+          ? full_coverage_path_planner::SpiralSTC::spiral_stc(grid, start, multiple_pass_counter, visited_counter,
+                                                              unreachable_counter, options)
+          : full_coverage_path_planner::SpiralSTC::spiral_stc_regions(NestedVectorView(grid, visited), start,
+                                                                      multiple_pass_counter, visited_counter,
+                                                                      unreachable_counter, saved_transit_counter,
+                                                                      options);
+
+      cv::Mat pathImg = mapImg.clone();
+      cv::Mat pathViz = drawPath(mapImg, pathImg, start, path);
+      EXPECT_EQ(0, calcDifference(mapImg, pathImg, start));
+    }
+  }
+}
+
+/*
+ * Resuming coverage: the left half of the map is marked as covered before planning, so the plan only has to cover
+ * the right half, whether it is planned at once or in regions
+ */
+TEST(TestSpiralStc, testResumeCoverage)
+{
+  std::vector<std::vector<bool> > grid = makeTestGrid(20, 10, false);
+  Point_t start = { 15, 5 };  // NOLINT
+  full_coverage_path_planner::SpiralSTC::spiral_stc_options_type options;
+  options.region_size = 10;
+  for (int t = 1; t <= 2; ++t)
+  {
+    options.threads = t;
+    std::vector<std::vector<bool> > visited = makeTestGrid(20, 10, false);
+    for (int y = 0; y < 10; ++y)
+    {
+      for (int x = 0; x < 10; ++x)
+      {
+        visited[y][x] = eNodeVisited;
+      }
+    }
+    int multiple_pass_counter, visited_counter, unreachable_counter, saved_transit_counter;
+    std::list<Point_t> path = (t == 1)
+        ? full_coverage_path_planner::SpiralSTC::spiral_stc(NestedVectorView(grid, visited), start,
+                                                            multiple_pass_counter, visited_counter,
+                                                            unreachable_counter, options)
+        : full_coverage_path_planner::SpiralSTC::spiral_stc_regions(NestedVectorView(grid, visited), start,
+                                                                    multiple_pass_counter, visited_counter,
+                                                                    unreachable_counter, saved_transit_counter,
+                                                                    options);
+    std::vector<std::vector<bool> > covered = makeTestGrid(20, 10, false);
+    for (std::list<Point_t>::iterator it = path.begin(); it != path.end(); ++it)
+    {
+      EXPECT_GE(it->x, 10);
+      covered[it->y][it->x] = true;
+    }
+    for (int y = 0; y < 10; ++y)
+    {
+      for (int x = 10; x < 20; ++x)
+      {
+        EXPECT_TRUE(covered[y][x]);
+      }
+    }
+  }
+}
+
+/*
+ * Regions that were covered before are left out of the tour of the regions, also when they lie between regions
+ * that still have to be covered. Those must still all be covered, only passing through the covered ones
+ */
+TEST(TestSpiralStc, testCoveredRegionBetweenOpenRegions)
+{
+  std::vector<std::vector<bool> > grid = makeTestGrid(60, 10, false);
+  std::vector<std::vector<bool> > visited = makeTestGrid(60, 10, false);
+  for (int y = 0; y < 10; ++y)
+  {
+    for (int x = 0; x < 60; ++x)
+    {
+      visited[y][x] = (x / 10 == 1 || x / 10 == 3);  // The second and fourth region are covered
+    }
+  }
+  Point_t start = { 2, 5 };  // NOLINT
+  full_coverage_path_planner::SpiralSTC::spiral_stc_options_type options;
+  options.region_size = 10;
+  int multiple_pass_counter, visited_counter, unreachable_counter, saved_transit_counter;
+  std::list<Point_t> path = full_coverage_path_planner::SpiralSTC::spiral_stc_regions(
+      NestedVectorView(grid, visited), start, multiple_pass_counter, visited_counter, unreachable_counter,
+      saved_transit_counter, options);
+
+  std::vector<std::vector<bool> > covered = makeTestGrid(60, 10, false);
+  std::list<Point_t>::iterator it = path.begin(), prev = it++;
+  covered[prev->y][prev->x] = true;
+  for (; it != path.end(); prev = it++)
+  {
+    ASSERT_GE(1, abs(it->x - prev->x) + abs(it->y - prev->y));
+    covered[it->y][it->x] = true;
+  }
+  for (int y = 0; y < 10; ++y)
+  {
+    for (int x = 0; x < 60; ++x)
+    {
+      EXPECT_TRUE(covered[y][x] || visited[y][x]);
+    }
+  }
+  EXPECT_LE(0, saved_transit_counter);
+}
+
+/*
+ * Same as testRandomMap, but planning regions of the map in parallel.
+ * The stitched plan must cover everything, only make 4-connected steps and not depend on the number of threads
+ */
+TEST(TestSpiralStc, testRandomMapParallelRegions)
+{
+  unsigned int seed = 12345;
+  full_coverage_path_planner::SpiralSTC::spiral_stc_options_type options;
+  options.region_size = 8;
+  for (int i = 0; i < 5; ++i)
+  {
+    int x_size = rand_r(&seed) % 100 + 1;
+    int y_size = rand_r(&seed) % 100 + 1;
+    std::vector<std::vector<bool> > grid = makeTestGrid(x_size, y_size, false);
+    randomFillTestGrid(grid, 20);  // ...% fill of obstacles
+
+    cv::Mat mapImg = drawMap(grid);
+    Point_t start = findStart(grid);
+    std::list<Point_t> paths[2];
+    int threads[] = { 1, 4 };  // NOLINT
+    for (int t = 0; t < 2; ++t)
+    {
+      std::vector<std::vector<bool> > visited = makeTestGrid(x_size, y_size, false);
+      options.threads = threads[t];
+      int multiple_pass_counter, visited_counter, unreachable_counter, saved_transit_counter;
+      paths[t] = full_coverage_path_planner::SpiralSTC::spiral_stc_regions(NestedVectorView(grid, visited),
+                                                                           start,
+                                                                           multiple_pass_counter,
+                                                                           visited_counter,
+                                                                           unreachable_counter,
+                                                                           saved_transit_counter,
+                                                                           options);
+      EXPECT_LE(0, saved_transit_counter);
+    }
+    ASSERT_TRUE(paths[0] == paths[1]);
+
+    std::list<Point_t>::iterator it = paths[1].begin(), prev = it++;
+    for (; it != paths[1].end(); prev = it++)
+    {
+      ASSERT_FALSE(grid[it->y][it->x]);
+      ASSERT_GE(1, abs(it->x - prev->x) + abs(it->y - prev->y));
+    }
+
+    cv::Mat pathImg = mapImg.clone();
+    cv::Mat pathViz = drawPath(mapImg, pathImg, start, paths[1]);
+    EXPECT_EQ(0, calcDifference(mapImg, pathImg, start));
+  }
+}
+
+/*
+ * Nearest neighbor goes to the region right next to the start first and then has to cross back.
+ * The improved tour visits the other side first.
+ */
+TEST(TestRegionTour, testImproveOnLine)
+{
+  Point_t points[] = { {0, 0}, {1, 0}, {-2, 0}, {4, 0} };  // NOLINT
+  std::vector<Point_t> entries(points, points + 4);
+  std::vector<std::vector<int> > adjacency(4);
+  for (int a = 0; a < 4; ++a)
+  {
+    for (int b = 0; b < 4; ++b)
+    {
+      if (a != b)
+      {
+        adjacency[a].push_back(b);
+      }
+    }
+  }
+
+  full_coverage_path_planner::RegionTour tour(entries, entries, adjacency);
+  tour.nearestNeighbor(0);
+  ASSERT_EQ(1 + 3 + 6, tour.cost());
+  tour.improve(1.0);
+  ASSERT_EQ(2 + 3 + 3, tour.cost());
+  ASSERT_EQ(0, tour.order()[0]);
+  ASSERT_EQ(2, tour.order()[1]);
+}
+
+/*
+ * On random regions, the improved tour must still visit every region once, start with the first one
+ * and never be longer than the nearest neighbor tour
+ */
+TEST(TestRegionTour, testRandomRegions)
+{
+  unsigned int seed = 12345;
+  for (int i = 0; i < 10; ++i)
+  {
+    int x_size = rand_r(&seed) % 100 + 1;
+    int y_size = rand_r(&seed) % 100 + 1;
+    std::vector<std::vector<bool> > grid = makeTestGrid(x_size, y_size, false);
+    randomFillTestGrid(grid, 20);  // ...% fill of obstacles
+    std::vector<int> labels;
+    int nRegions = label_block_regions(NestedVectorView(grid, grid), 5, labels);
+    std::vector<std::vector<int> > adjacency;
+    full_coverage_path_planner::build_region_adjacency(labels, x_size, nRegions, adjacency);
+
+    std::vector<Point_t> entries(nRegions), exits(nRegions);
+    for (int r = 0; r < nRegions; ++r)
+    {
+      Point_t entry = { rand_r(&seed) % x_size, rand_r(&seed) % y_size };  // NOLINT
+      Point_t exit = { rand_r(&seed) % x_size, rand_r(&seed) % y_size };  // NOLINT
+      entries[r] = entry;
+      exits[r] = exit;
+    }
+    full_coverage_path_planner::RegionTour tour(entries, exits, adjacency);
+    tour.nearestNeighbor(0);
+    int greedy = tour.cost();
+    tour.improve(1.0);
+    ASSERT_GE(greedy, tour.cost());
+
+    std::vector<int> order = tour.order();
+    ASSERT_EQ(nRegions, order.size());
+    ASSERT_EQ(0, order[0]);
+    std::sort(order.begin(), order.end());
+    for (int r = 0; r < nRegions; ++r)
+    {
+      ASSERT_EQ(r, order[r]);
+    }
+  }
+}
+
+/**
+ * Run spiral_stc on a view of a copy of grid in the storage Grid and report the time it took and the cache misses
+ * (-1 where the hardware counters are not available)
+ */
+template <class Grid>
+std::list<Point_t> timedSpiralStc(std::vector<std::vector<bool> > const& grid, Point_t start, std::string name)
+{
+  Grid storage(grid);
+  Grid visited;
+  gridAssign(visited, gridWidth(grid), gridHeight(grid), false);
+  GridView<Grid, Grid> view(storage, visited);
+  int multiple_pass_counter, visited_counter, unreachable_counter;
+  CacheMissCounter counter;
+  std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+  std::list<Point_t> path = full_coverage_path_planner::SpiralSTC::spiral_stc(
+      view, start, multiple_pass_counter, visited_counter, unreachable_counter,
+      full_coverage_path_planner::SpiralSTC::spiral_stc_options_type());
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+  std::cout << name << ": " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count()
+            << " ms, " << counter.count() << " cache misses" << std::endl;
+  return path;
+}
+
+/*
+ * The goals and the searches of spiral_stc are made again for every step to open space. They are kept in an arena,
+ * so the number of allocations of a plan must not grow with the number of nodes times the number of steps
+ */
+TEST(TestSpiralStc, testAllocationCount)
+{
+  int size = 100;
+  std::vector<std::vector<bool> > grid = makeTestGrid(size, size, false);
+  unsigned int seed = 97531;
+  for (int i = 0; i < size * size / 8; ++i)
+  {
+    grid[rand_r(&seed) % size][rand_r(&seed) % size] = true;
+  }
+  grid[0][0] = false;
+  Point_t start = {0, 0};  // NOLINT
+  RowMajorGrid obstacles(grid), visited(size, size, false);
+  std::vector<Point_t> path;
+  int multiple_pass_counter, visited_counter, unreachable_counter;
+
+  std::size_t before = allocation_counter.load();
+  full_coverage_path_planner::SpiralSTC::spiral_stc(BitsetView(obstacles, visited), start, path,
+                                                    multiple_pass_counter, visited_counter, unreachable_counter,
+                                                    full_coverage_path_planner::SpiralSTC::spiral_stc_options_type());
+  std::size_t allocations = allocation_counter.load() - before;
+
+  int steps = 0;
+  for (std::size_t i = 1; i < path.size(); ++i)
+  {
+    steps += (path[i].x == path[i - 1].x && path[i].y == path[i - 1].y);  // Every step to open space starts so
+  }
+  std::cout << "Plan of " << path.size() << " nodes with " << steps << " steps to open space: " << allocations
+            << " allocations" << std::endl;
+  ASSERT_GT(steps, 10);
+  ASSERT_LT(allocations, 8 * steps);  // Without the arena, it takes more than 1000 per step
+}
+
+/*
+ * A* through a serpentine maze of which everything but the far end is visited expands every node of the maze, with
+ * paths that get as long as the maze. Its memory must grow with the number of nodes, not with the nodes times the
+ * length of their paths
+ */
+TEST(TestSpiralStc, testPeakMemory)
+{
+  int size = 100;
+  std::vector<std::vector<bool> > grid = makeTestGrid(size, size, false);
+  for (int y = 1; y < size; y += 2)
+  {
+    for (int x = 0; x < size; ++x)
+    {
+      grid[y][x] = (y % 4 == 1) ? x != size - 1 : x != 0;  // Wall with a gap at alternating ends
+    }
+  }
+  RowMajorGrid obstacles(grid), visited(size, size, true);
+  visited.set(0, size - 2, false);  // The end of the last corridor is the only open node
+  std::list<Point_t> goals = map_2_goals(BitsetView(obstacles, visited));
+  ASSERT_EQ(1, goals.size());
+  gridNode_t start = { { 0, 0 }, 0, 0 };  // NOLINT
+  std::vector<Point_t> path;
+
+  std::size_t before = peak_allocated_bytes.exchange(allocated_bytes.load());
+  bool resign = a_star_to_open_space(BitsetView(obstacles, visited), start, 1, goals, path);
+  std::size_t peak = peak_allocated_bytes.load() - allocated_bytes.load();
+  peak_allocated_bytes.store(std::max(before, peak_allocated_bytes.load()));
+
+  std::cout << "A* through a maze of " << path.size() << " nodes: " << peak / 1024 << " KiB at most" << std::endl;
+  ASSERT_FALSE(resign);
+  ASSERT_EQ(size * size / 2 + size / 2 - 1, path.size());
+  ASSERT_LT(peak, 64 * size * size + 128 * 1024);  // Storing every path separately takes more than 300 MB here
+}
+
+/*
+ * Benchmark spiral_stc with the legacy nested vectors, the packed row-major and the Morton-tiled grid storages
+ * on a warehouse-like map. All storages must give exactly the same path.
+ * Increase size to get maps that do not fit in the L2 cache.
+ */
+TEST(TestSpiralStc, benchmarkGridStorages)
+{
+  int size = 160;
+  std::vector<std::vector<bool> > grid = makeTestGrid(size, size, false);
+  for (int y = 5; y < size - 5; y += 8)
+  {
+    for (int x = 5; x < size - 5; ++x)
+    {
+      grid[y][x] = (x % 40) != 0;  // Rack row with a cross aisle every 40 nodes
+    }
+  }
+  Point_t start = {0, 0};  // NOLINT
+
+  std::list<Point_t> nested = timedSpiralStc<std::vector<std::vector<bool> > >(grid, start, "nested vector");
+  std::list<Point_t> rowMajor = timedSpiralStc<RowMajorGrid>(grid, start, "row-major");
+  std::list<Point_t> tiled8 = timedSpiralStc<TiledGrid8>(grid, start, "8x8 tiles");
+  std::list<Point_t> tiled64 = timedSpiralStc<TiledGrid64>(grid, start, "64x64 tiles");
+
+  ASSERT_TRUE(nested == rowMajor);
+  ASSERT_TRUE(nested == tiled8);
+  ASSERT_TRUE(nested == tiled64);
+}
+
+/*
+ * Planning directly on a costmap char map must give the same path as planning on the thresholded nested vectors
+ */
+TEST(TestSpiralStc, testCostmapView)
+{
+  unsigned int seed = 4321;
+  int x_size = 60, y_size = 45;
+  std::vector<std::vector<bool> > grid = makeTestGrid(x_size, y_size, false);
+  std::vector<unsigned char> charMap(x_size * y_size);
+  for (int y = 0; y < y_size; ++y)
+  {
+    for (int x = 0; x < x_size; ++x)
+    {
+      // Free space with some cost, inscribed, lethal and unknown
+      unsigned char costs[] = { 0, 0, 0, 0, 0, 50, 128, 252, 253, 254, 255 };  // NOLINT
+      charMap[y * x_size + x] = costs[rand_r(&seed) % 11];
+      grid[y][x] = charMap[y * x_size + x] >= 253;
+    }
+  }
+  Point_t start = findStart(grid);
+  full_coverage_path_planner::SpiralSTC::spiral_stc_options_type options;
+
+  Point_t nestedStart = start;
+  int multiple_pass_counter, visited_counter, unreachable_counter;
+  std::list<Point_t> nested = full_coverage_path_planner::SpiralSTC::spiral_stc(
+      grid, nestedStart, multiple_pass_counter, visited_counter, unreachable_counter, options);
+
+  CostmapGrid<253> costmap(&charMap[0], x_size, y_size);
+  RowMajorGrid visited(x_size, y_size, false);
+  CostmapView<253> view(costmap, visited);
+  int view_multiple_pass_counter, view_visited_counter, view_unreachable_counter;
+  std::list<Point_t> onCostmap = full_coverage_path_planner::SpiralSTC::spiral_stc(
+      view, start, view_multiple_pass_counter, view_visited_counter, view_unreachable_counter, options);
+
+  ASSERT_TRUE(nested == onCostmap);
+  ASSERT_EQ(visited_counter, view_visited_counter);
+  ASSERT_EQ(unreachable_counter, view_unreachable_counter);
+
+  // All reachable nodes are marked in the visited layer
+  for (std::list<Point_t>::iterator it = onCostmap.begin(); it != onCostmap.end(); ++it)
+  {
+    ASSERT_TRUE(view.visited(it->x, it->y));
+  }
+}
+
+/*
+ * Appending to a caller-owned path or to a CompactPath must give the same path as returning a list, after what the
+ * caller put there. The turn-aware search reads the path back from before the step, which must survive moving the
+ * nodes into the CompactPath
+ */
+TEST(TestSpiralStc, testPathSink)
+{
+  unsigned int seed = 2468;
+  int x_size = 50, y_size = 40;
+  std::vector<std::vector<bool> > grid = makeTestGrid(x_size, y_size, false);
+  for (int y = 0; y < y_size; ++y)
+  {
+    for (int x = 0; x < x_size; ++x)
+    {
+      grid[y][x] = rand_r(&seed) % 6 == 0;
+    }
+  }
+  Point_t start = findStart(grid);
+  full_coverage_path_planner::SpiralSTC::spiral_stc_options_type options;
+  int searches[] = { eSearchAStar, eSearchTurnAware };  // NOLINT
+  for (int s = 0; s < 2; ++s)
+  {
+    options.search = searches[s];
+    Point_t listStart = start;
+    int multiple_pass_counter, visited_counter, unreachable_counter;
+    std::list<Point_t> returned = full_coverage_path_planner::SpiralSTC::spiral_stc(
+        grid, listStart, multiple_pass_counter, visited_counter, unreachable_counter, options);
+
+    std::vector<std::vector<bool> > visited = makeTestGrid(x_size, y_size, false);
+    Point_t before = { -1, -1 };  // NOLINT
+    std::vector<Point_t> appended(1, before);
+    appended.reserve(x_size * y_size);
+    Point_t sinkStart = start;
+    int sink_multiple_pass_counter, sink_visited_counter, sink_unreachable_counter;
+    full_coverage_path_planner::SpiralSTC::spiral_stc(NestedVectorView(grid, visited), sinkStart, appended,
+                                                      sink_multiple_pass_counter, sink_visited_counter,
+                                                      sink_unreachable_counter, options);
+
+    ASSERT_EQ(returned.size() + 1, appended.size());
+    EXPECT_EQ(-1, appended[0].x);
+    EXPECT_TRUE(std::equal(returned.begin(), returned.end(), appended.begin() + 1));
+    EXPECT_EQ(multiple_pass_counter, sink_multiple_pass_counter);
+    EXPECT_EQ(visited_counter, sink_visited_counter);
+    EXPECT_EQ(unreachable_counter, sink_unreachable_counter);
+
+    visited = makeTestGrid(x_size, y_size, false);
+    full_coverage_path_planner::CompactPath compact(appended.begin(), appended.begin() + 1);
+    Point_t compactStart = start;
+    int compact_multiple_pass_counter, compact_visited_counter, compact_unreachable_counter;
+    full_coverage_path_planner::SpiralSTC::spiral_stc(NestedVectorView(grid, visited), compactStart, compact,
+                                                      compact_multiple_pass_counter, compact_visited_counter,
+                                                      compact_unreachable_counter, options);
+
+    ASSERT_EQ(appended.size(), compact.size());
+    EXPECT_TRUE(std::equal(appended.begin(), appended.end(), compact.begin()));
+    EXPECT_EQ(multiple_pass_counter, compact_multiple_pass_counter);
+    EXPECT_EQ(visited_counter, compact_visited_counter);
+  }
+}
+
+/*
+ * Only the turns of the path become poses, each preceded by the previous pose turned to the new direction,
+ * and size() tells up front how many poses there will be
+ */
+TEST(TestWaypointGenerator, testTurnsOnly)
+{
+  // Right to (3, 0), then up to (3, 2)
+  std::list<Point_t> points;
+  for (int x = 0; x <= 3; ++x)
+  {
+    Point_t p = { x, 0 };  // NOLINT
+    points.push_back(p);
+  }
+  for (int y = 1; y <= 2; ++y)
+  {
+    Point_t p = { 3, y };  // NOLINT
+    points.push_back(p);
+  }
+  full_coverage_path_planner::CompactPath path(points);
+  fPoint_t origin = { 1.0, 2.0 };  // NOLINT
+  geometry_msgs::PoseStamped start;
+  start.pose.position.x = -1.0;
+  start.pose.position.y = 2.25;
+
+  full_coverage_path_planner::WaypointGenerator generator(start, path, 0.5, origin);
+  std::vector<geometry_msgs::PoseStamped> plan;
+  geometry_msgs::PoseStamped pose;
+  while (generator.next(pose))
+  {
+    plan.push_back(pose);
+  }
+  // Start, start and first point facing each other, first point, then twice for (3, 0) and for (3, 2)
+  ASSERT_EQ(8, plan.size());
+  ASSERT_EQ(plan.size(), generator.size());
+  ASSERT_FLOAT_EQ(-1.0, plan[1].pose.position.x);
+  ASSERT_FLOAT_EQ(1.25, plan[2].pose.position.x);
+  ASSERT_FLOAT_EQ(plan[1].pose.orientation.w, plan[2].pose.orientation.w);
+  geometry_msgs::Quaternion right = tf::createQuaternionMsgFromYaw(0);
+  geometry_msgs::Quaternion up = tf::createQuaternionMsgFromYaw(M_PI / 2);
+  ASSERT_FLOAT_EQ(right.w, plan[3].pose.orientation.w);
+  // Drive right to (3, 0), turn up there and drive to (3, 2)
+  ASSERT_FLOAT_EQ(1.25, plan[4].pose.position.x);
+  ASSERT_FLOAT_EQ(2.75, plan[5].pose.position.x);
+  ASSERT_FLOAT_EQ(right.w, plan[5].pose.orientation.w);
+  ASSERT_FLOAT_EQ(2.75, plan[6].pose.position.x);
+  ASSERT_FLOAT_EQ(up.z, plan[6].pose.orientation.z);
+  ASSERT_FLOAT_EQ(3.25, plan[7].pose.position.y);
+  ASSERT_FLOAT_EQ(up.z, plan[7].pose.orientation.z);
+  ASSERT_EQ("map", plan[7].header.frame_id);
+
+  // Starting on the first point, there is no pose to get there
+  start = plan[3];
+  full_coverage_path_planner::WaypointGenerator onStart(start, path, 0.5, origin);
+  ASSERT_EQ(6, onStart.size());
+}
+
+/*
+ * A controller that decodes the compact plan message gets the same tiles and poses as the planner has
+ */
+TEST(TestCompactPlan, testDecodeGivesSamePlan)
+{
+  unsigned int seed = 97531;
+  std::vector<std::vector<bool> > grid = makeTestGrid(40, 30, false);
+  for (int y = 0; y < 30; ++y)
+  {
+    for (int x = 0; x < 40; ++x)
+    {
+      grid[y][x] = rand_r(&seed) % 8 == 0;
+    }
+  }
+  Point_t start = findStart(grid);
+  int multiple_pass_counter, visited_counter;
+  std::list<Point_t> points = full_coverage_path_planner::SpiralSTC::spiral_stc(grid, start, multiple_pass_counter,
+                                                                                visited_counter);
+  full_coverage_path_planner::CompactPath path(points);
+  fPoint_t origin = { -3.5, 12.25 };  // NOLINT
+  geometry_msgs::PoseStamped startPose;
+  startPose.pose.position.x = 0.1;
+
+  full_coverage_path_planner::CompactPlan msg;
+  full_coverage_path_planner::toCompactPlanMsg(startPose, path, origin, 0.4, msg);
+  full_coverage_path_planner::CompactPlanDecoder decoder(msg);
+  ASSERT_EQ("map", decoder.frame());
+  ASSERT_TRUE(decoder.path().toList() == points);
+
+  full_coverage_path_planner::WaypointGenerator planned(startPose, path, 0.4, origin);
+  full_coverage_path_planner::WaypointGenerator decoded = decoder.waypoints();
+  ASSERT_EQ(planned.size(), decoded.size());
+  geometry_msgs::PoseStamped a, b;
+  while (planned.next(a))
+  {
+    ASSERT_TRUE(decoded.next(b));
+    ASSERT_EQ(a.pose.position.x, b.pose.position.x);
+    ASSERT_EQ(a.pose.position.y, b.pose.position.y);
+    ASSERT_EQ(a.pose.orientation.z, b.pose.orientation.z);
+  }
+  ASSERT_FALSE(decoded.next(b));
+
+  // The last pose is at the center of the last tile
+  ASSERT_EQ(decoder.position(points.back()).x, a.pose.position.x);
+  ASSERT_EQ(decoder.position(points.back()).y, a.pose.position.y);
+}
+
+/*
+ * A message is untrusted input: codes that do not decode to a path must be rejected instead of decoding to other
+ * tiles than the plan. A run of length 0 adds no steps, so it would pass a check on the length alone
+ */
+TEST(TestCompactPlan, testDecoderRejectsInvalidCodes)
+{
+  full_coverage_path_planner::CompactPlan msg;
+  msg.start_x = 3;
+  msg.start_y = 4;
+  msg.length = 2;
+  msg.codes.push_back((1 << 2) | 0);  // One step in +x
+  full_coverage_path_planner::CompactPlanDecoder valid(msg);
+  ASSERT_EQ(4, valid.path().back().x);
+
+  msg.codes.assign(1, 1);  // A +y run without steps
+  msg.codes.push_back((1 << 2) | 0);
+  ASSERT_THROW(full_coverage_path_planner::CompactPlanDecoder decoder(msg), std::invalid_argument);
+  for (uint16_t code = 1; code < 4; ++code)
+  {
+    msg.codes.assign(1, code);
+    msg.length = 1;
+    ASSERT_THROW(full_coverage_path_planner::CompactPlanDecoder decoder(msg), std::invalid_argument);
+  }
+
+  msg.codes.assign(3, 0);  // Jump that is cut off
+  msg.length = 2;
+  ASSERT_THROW(full_coverage_path_planner::CompactPlanDecoder decoder(msg), std::invalid_argument);
+}
+
+/*
+ * Planning on a memory-mapped map_server image, with room for only a few tiles, must give the same path as planning
+ * on the nested vectors the image thresholds to
+ */
+TEST(TestSpiralStc, testMappedGrid)
+{
+  unsigned int seed = 2468;
+  int x_size = 150, y_size = 130, node_size = 2;
+  std::vector<std::vector<bool> > grid = makeTestGrid(x_size, y_size, false);
+  randomFillTestGrid(grid, 15);
+
+  // Each occupied node gets one black pixel, the free space is nearly white and unknown space is gray
+  int width = x_size * node_size, height = y_size * node_size;
+  std::vector<unsigned char> pixels(width * height, 254);
+  for (int y = 0; y < y_size; ++y)
+  {
+    for (int x = 0; x < x_size; ++x)
+    {
+      int coll = x * node_size + rand_r(&seed) % node_size, row = y * node_size + rand_r(&seed) % node_size;
+      pixels[(height - 1 - row) * width + coll] = grid[y][x] ? 0 : ((rand_r(&seed) % 4 == 0) ? 205 : 254);
+    }
+  }
+  char path[] = "/tmp/test_mapped_grid_XXXXXX";  // NOLINT
+  int fd = mkstemp(path);
+  ASSERT_GE(fd, 0);
+  FILE* file = fdopen(fd, "wb");
+  fprintf(file, "P5\n# CREATOR: test\n%d %d\n255\n", width, height);
+  fwrite(&pixels[0], 1, pixels.size(), file);
+  fclose(file);
+
+  Point_t start = findStart(grid);
+  full_coverage_path_planner::SpiralSTC::spiral_stc_options_type options;
+  Point_t nestedStart = start;
+  int multiple_pass_counter, visited_counter, unreachable_counter;
+  std::list<Point_t> nested = full_coverage_path_planner::SpiralSTC::spiral_stc(
+      grid, nestedStart, multiple_pass_counter, visited_counter, unreachable_counter, options);
+
+  MappedPgm pgm(path);
+  unlink(path);
+  MappedGrid mapped(pgm, node_size, node_size, 0.65, false, 2 * MappedGrid::kTileBytes);
+  ASSERT_EQ(x_size, mapped.width());
+  ASSERT_EQ(y_size, mapped.height());
+  RowMajorGrid visited(x_size, y_size, false);
+  int mapped_multiple_pass_counter, mapped_visited_counter, mapped_unreachable_counter;
+  std::list<Point_t> onMapped = full_coverage_path_planner::SpiralSTC::spiral_stc(
+      MappedView(mapped, visited), start, mapped_multiple_pass_counter, mapped_visited_counter,
+      mapped_unreachable_counter, options);
+
+  resource_usage_t usage = resourceUsage();
+  std::cout << mapped.pageIns() << " tile page-ins, " << mapped.evictions() << " evictions, peak RSS "
+            << usage.peak_rss_kb << " kB" << std::endl;
+
+  ASSERT_TRUE(nested == onMapped);
+  ASSERT_EQ(visited_counter, mapped_visited_counter);
+  ASSERT_EQ(unreachable_counter, mapped_unreachable_counter);
+  // The map has 6 tiles, so they must have been dropped and parsed again
+  ASSERT_EQ(2u, mapped.capacity());
+  ASSERT_LE(mapped.residentTiles(), mapped.capacity());
+  ASSERT_GT(mapped.pageIns(), 6u);
+  ASSERT_EQ(mapped.pageIns(), mapped.evictions() + mapped.residentTiles());
+
+  ASSERT_THROW(MappedPgm("/nonexistent.pgm"), std::runtime_error);
+}
+
+/**
+ * Access to the parsing of FullCoveragePathPlanner, which is only meant for the planners
+ */
+class ParsingPlanner : public full_coverage_path_planner::FullCoveragePathPlanner
+{
+public:
+  using FullCoveragePathPlanner::parseGrid;
+  using FullCoveragePathPlanner::parseGridLazily;
+  using FullCoveragePathPlanner::circular_footprint_;
+  using FullCoveragePathPlanner::coverage_zone_;
+  using FullCoveragePathPlanner::grid_origin_;
+
+  bool makePlan(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal,
+                std::vector<geometry_msgs::PoseStamped>& plan)
+  {
+    return false;
+  }
+};
+
+/*
+ * The lazily evaluated grid and the packed one must be the same as the nested one parseGrid parses, with either
+ * footprint and with a zone, and no tile may be evaluated before the planner reads it
+ */
+TEST(TestLazyOccupancyGrid, testSameAsParseGrid)
+{
+  unsigned int seed = 1357;
+  nav_msgs::OccupancyGrid map;
+  map.info.width = 203;
+  map.info.height = 151;
+  map.info.resolution = 0.05;
+  map.info.origin.position.x = -2.0;
+  map.info.origin.position.y = 1.0;
+  map.data.resize(map.info.width * map.info.height);
+  for (std::size_t i = 0; i < map.data.size(); ++i)
+  {
+    int8_t values[] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 30, 100, -1 };  // NOLINT
+    map.data[i] = values[rand_r(&seed) % 17];
+  }
+  geometry_msgs::PoseStamped start;
+  start.pose.position.x = 1.0;
+  start.pose.position.y = 3.0;
+  std::vector<fPoint_t> zone;
+  fPoint_t corners[] = { { -1.3, 1.6 }, { 5.0, 2.0 }, { 6.1, 7.7 }, { 1.0, 4.0 } };  // NOLINT
+  zone.assign(corners, corners + 4);
+
+  // Tiles of one cell make a grid of several blocks of tiles that are evaluated together for a circular footprint
+  for (int config = 0; config < 8; ++config)
+  {
+    ParsingPlanner planner;
+    planner.circular_footprint_ = (config % 2 == 1);
+    if (config & 2)
+    {
+      planner.coverage_zone_ = zone;
+    }
+    double toolSize = (config & 4) ? 0.05 : 0.2;
+    std::vector<std::vector<bool> > grid;
+    Point_t scaledStart;
+    ASSERT_TRUE(planner.parseGrid(map, grid, 0.3, toolSize, start, scaledStart));
+    fPoint_t grid_origin = planner.grid_origin_;
+
+    RowMajorGrid packed;
+    Point_t packedStart;
+    ASSERT_TRUE(planner.parseGrid(map, packed, 0.3, toolSize, start, packedStart));
+    ASSERT_TRUE(scaledStart == packedStart);
+
+    LazyOccupancyGrid lazy;
+    Point_t lazyStart;
+    ASSERT_TRUE(planner.parseGridLazily(map, lazy, 0.3, toolSize, start, lazyStart));
+    if ((config & 2) == 0)
+    {
+      ASSERT_EQ(0, lazy.evaluated());
+    }
+    ASSERT_EQ(grid_origin.x, planner.grid_origin_.x);
+    ASSERT_EQ(grid_origin.y, planner.grid_origin_.y);
+    ASSERT_TRUE(scaledStart == lazyStart);
+    ASSERT_EQ(gridWidth(grid), lazy.width());
+    ASSERT_EQ(gridHeight(grid), lazy.height());
+    for (int y = 0; y < lazy.height(); ++y)
+    {
+      for (int x = 0; x < lazy.width(); ++x)
+      {
+        ASSERT_EQ(grid[y][x], lazy.get(x, y)) << "config " << config << " at " << x << ", " << y;
+        ASSERT_EQ(grid[y][x], packed.get(x, y)) << "config " << config << " at " << x << ", " << y;
+      }
+    }
+    ASSERT_EQ(lazy.width() * lazy.height(), lazy.evaluated());
+  }
+}
+
+/*
+ * A robot outside of the coverage zone starts from the closest free tile in it. Finding that tile only evaluates the
+ * tiles around the start, not the whole grid
+ */
+TEST(TestLazyOccupancyGrid, testStartOutsideZone)
+{
+  unsigned int seed = 2468;
+  nav_msgs::OccupancyGrid map;
+  map.info.width = 300;
+  map.info.height = 300;
+  map.info.resolution = 0.1;
+  map.data.resize(map.info.width * map.info.height);
+  for (std::size_t i = 0; i < map.data.size(); ++i)
+  {
+    map.data[i] = (rand_r(&seed) % 4 == 0) ? 100 : 0;
+  }
+  fPoint_t corners[] = { { 2.0, 2.0 }, { 25.0, 2.5 }, { 24.0, 26.0 }, { 3.0, 22.0 } };  // NOLINT
+  geometry_msgs::PoseStamped starts[3];
+  starts[0].pose.position.x = 0.5;  // Outside, near a corner of the zone
+  starts[0].pose.position.y = 1.0;
+  starts[1].pose.position.x = 14.0;  // Outside, below an edge
+  starts[1].pose.position.y = -3.0;
+  starts[2].pose.position.x = 27.0;  // Outside, right of the zone
+  starts[2].pose.position.y = 14.0;
+
+  for (int i = 0; i < 3; ++i)
+  {
+    ParsingPlanner planner;
+    planner.coverage_zone_.assign(corners, corners + 4);
+    std::vector<std::vector<bool> > grid;
+    Point_t scaledStart, lazyStart;
+    ASSERT_TRUE(planner.parseGrid(map, grid, 0.1, 0.1, starts[i], scaledStart));
+    LazyOccupancyGrid lazy;
+    ASSERT_TRUE(planner.parseGridLazily(map, lazy, 0.1, 0.1, starts[i], lazyStart));
+    ASSERT_TRUE(scaledStart == lazyStart);
+    ASSERT_FALSE(grid[scaledStart.y][scaledStart.x]);
+    ASSERT_LT(lazy.evaluated(), lazy.width() * lazy.height() / 10);
+
+    // The closest free tile, the first one in row-major order if there is a tie
+    float sx = (starts[i].pose.position.x - planner.grid_origin_.x) / 0.1 - 0.5;
+    float sy = (starts[i].pose.position.y - planner.grid_origin_.y) / 0.1 - 0.5;
+    float closest = -1;
+    Point_t expected = { -1, -1 };  // NOLINT
+    for (int y = 0; y < gridHeight(grid); ++y)
+    {
+      for (int x = 0; x < gridWidth(grid); ++x)
+      {
+        float d = (x - sx) * (x - sx) + (y - sy) * (y - sy);
+        if (!grid[y][x] && (closest < 0 || d < closest))
+        {
+          closest = d;
+          expected.x = x;
+          expected.y = y;
+        }
+      }
+    }
+    ASSERT_TRUE(expected == scaledStart) << "start " << i;
+  }
+}
+
+/*
+ * Without a free tile in the coverage zone there is nothing to start from, so parsing fails
+ */
+TEST(TestLazyOccupancyGrid, testNoFreeTileInZone)
+{
+  nav_msgs::OccupancyGrid map;
+  map.info.width = 40;
+  map.info.height = 40;
+  map.info.resolution = 0.1;
+  map.data.assign(map.info.width * map.info.height, 100);
+  geometry_msgs::PoseStamped start;
+  start.pose.position.x = 0.2;
+  start.pose.position.y = 0.2;
+  fPoint_t corners[] = { { 2.0, 2.0 }, { 3.0, 2.0 }, { 3.0, 3.0 }, { 2.0, 3.0 } };  // NOLINT
+
+  ParsingPlanner planner;
+  planner.coverage_zone_.assign(corners, corners + 4);
+  std::vector<std::vector<bool> > grid;
+  LazyOccupancyGrid lazy;
+  Point_t scaledStart;
+  ASSERT_FALSE(planner.parseGrid(map, grid, 0.1, 0.1, start, scaledStart));
+  ASSERT_FALSE(planner.parseGridLazily(map, lazy, 0.1, 0.1, start, scaledStart));
+}
+
+/*
+ * Planning on the lazily evaluated grid gives the same plan, and only the part of the map that the plan can get to is
+ * evaluated
+ */
+TEST(TestLazyOccupancyGrid, testPlanEvaluatesOnlyWhatIsRead)
+{
+  int x_size = 120, y_size = 80;
+  std::vector<std::vector<bool> > grid = makeTestGrid(x_size, y_size, false);
+  std::vector<int8_t> cells(x_size * y_size, 0);
+  for (int y = 0; y < y_size; ++y)
+  {
+    for (int x = 0; x < x_size; ++x)
+    {
+      // A small room in the corner, walled off from the rest
+      grid[y][x] = (x == 10 && y <= 10) || (y == 10 && x <= 10) || (x > 30 && x < 90 && y % 7 == 3);
+      cells[y * x_size + x] = grid[y][x] ? 100 : 0;
+    }
+  }
+  LazyOccupancyGrid lazy(&cells[0], x_size, y_size, 0, 0, x_size, y_size, 1);
+
+  Point_t start = { 2, 2 };  // NOLINT
+  RowMajorGrid visited(x_size, y_size, false);
+  std::list<gridNode_t> init;
+  gridNode_t node = { start, 0, 0 };  // NOLINT
+  init.push_back(node);
+  std::list<gridNode_t> spiral = full_coverage_path_planner::SpiralSTC::spiral(LazyView(lazy, visited), init);
+  std::vector<std::vector<bool> > nestedVisited = makeTestGrid(x_size, y_size, false);
+  std::list<gridNode_t> nestedInit(1, node);
+  std::list<gridNode_t> nestedSpiral = full_coverage_path_planner::SpiralSTC::spiral(grid, nestedInit, nestedVisited);
+  ASSERT_EQ(nestedSpiral.size(), spiral.size());
+  std::cout << lazy.evaluated() << " of " << x_size * y_size << " tiles evaluated by a spiral in the room"
+            << std::endl;
+  ASSERT_LT(lazy.evaluated(), 200);
+
+  // A full plan of the room only reads the room and its walls, also with the spanning tree coverage
+  int coverages[] = { eCoverageSpiral, eCoverageSpanningTree };  // NOLINT
+  for (int c = 0; c < 2; ++c)
+  {
+    LazyOccupancyGrid planLazy(&cells[0], x_size, y_size, 0, 0, x_size, y_size, 1);
+    full_coverage_path_planner::SpiralSTC::spiral_stc_options_type options;
+    options.coverage = coverages[c];
+    RowMajorGrid planVisited(x_size, y_size, false);
+    Point_t nestedStart = start;
+    int multiple_pass_counter, visited_counter, unreachable_counter;
+    std::list<Point_t> nested = full_coverage_path_planner::SpiralSTC::spiral_stc(
+        grid, nestedStart, multiple_pass_counter, visited_counter, unreachable_counter, options);
+    options.reachable_only = true;
+    Point_t lazyStart = start;
+    std::list<Point_t> onLazy = full_coverage_path_planner::SpiralSTC::spiral_stc(
+        LazyView(planLazy, planVisited), lazyStart, multiple_pass_counter, visited_counter, unreachable_counter,
+        options);
+    ASSERT_TRUE(nested == onLazy);
+    std::cout << planLazy.evaluated() << " of " << x_size * y_size << " tiles evaluated by a plan of the room"
+              << std::endl;
+    ASSERT_LT(planLazy.evaluated(), 200);
+    ASSERT_EQ(0, unreachable_counter);
+  }
+}
+
 // Run all the tests that were declared with TEST()
 int main(int argc, char **argv)
 {
@@ -4,6 +4,10 @@
 // Created by nobleo on 27-9-18.
 //
 
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
 #include <vector>
 #include <full_coverage_path_planner/util.h>
 
@@ -56,3 +60,33 @@ bool randomFillTestGrid(std::vector<std::vector<bool> > &grid, float obstacle_fr
     grid[y][x] = true;
   }
 }
+
+CacheMissCounter::CacheMissCounter()
+{
+  perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.size = sizeof(attr);
+  attr.config = PERF_COUNT_HW_CACHE_MISSES;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  fd_ = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+CacheMissCounter::~CacheMissCounter()
+{
+  if (fd_ >= 0)
+  {
+    close(fd_);
+  }
+}
+
+long long CacheMissCounter::count() const  // NOLINT
+{
+  long long misses;  // NOLINT
+  if (fd_ < 0 || read(fd_, &misses, sizeof(misses)) != sizeof(misses))
+  {
+    return -1;
+  }
+  return misses;
+}